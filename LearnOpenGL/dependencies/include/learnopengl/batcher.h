@@ -0,0 +1,441 @@
+#ifndef BATCHER_H
+#define BATCHER_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+#include "mesh_pool.h"
+#include "stream_buffer.h"
+#include "vertex_layout.h"
+
+const int BATCH_TEXTURE_UNITS = 4;
+
+// everything that has to match for two objects to share a draw call
+struct BatchKey {
+	unsigned int program = 0;
+	unsigned int textures[BATCH_TEXTURE_UNITS] = { 0, 0, 0, 0 };	// GL_TEXTURE_2D per unit, 0 for none
+	uint32_t state = 0;		// caller defined render state, e.g. blend or cull mode
+	GLenum mode = GL_TRIANGLES;		// primitive type, one of the list modes batchableMode accepts
+
+	bool operator<(const BatchKey& other) const {
+		if (program != other.program) {
+			return program < other.program;
+		}
+		int textureOrder = std::memcmp(textures, other.textures, sizeof(textures));
+		if (textureOrder != 0) {
+			return textureOrder < 0;
+		}
+		if (state != other.state) {
+			return state < other.state;
+		}
+		return mode < other.mode;
+	}
+
+	bool operator==(const BatchKey& other) const {
+		return !(*this < other) && !(other < *this);
+	}
+};
+
+struct BatchStats {
+	unsigned int objects = 0;			// objects added or submitted
+	unsigned int batches = 0;			// distinct keys
+	unsigned int drawCalls = 0;			// draws issued by the last render
+	unsigned int stateChanges = 0;		// times the apply callback ran
+	unsigned int dropped = 0;			// objects left out of the last render for lack of space
+};
+
+// only list primitives can be concatenated; strips and fans would join the
+// last vertex of one object to the first of the next
+inline bool batchableMode(GLenum mode) {
+	switch (mode) {
+	case GL_POINTS: case GL_LINES: case GL_TRIANGLES:
+	case GL_LINES_ADJACENCY: case GL_TRIANGLES_ADJACENCY:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// uses the key's program and binds its textures to units 0 and up
+inline void applyBatchKey(const BatchKey& key) {
+	glUseProgram(key.program);
+	for (int unit = 0; unit < BATCH_TEXTURE_UNITS; unit++) {
+		if (key.textures[unit] != 0) {
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(GL_TEXTURE_2D, key.textures[unit]);
+		}
+	}
+}
+
+// copies vertexCount vertices of Layout, transforming the position (the first
+// attribute, three floats) by a column major 4x4 matrix as glUniformMatrix4fv takes it.
+// other attributes are copied as they are, so meshes with normals should only
+// be batched with rotations they can ignore or without a transform
+template <typename Layout>
+void transformVertices(const void* source, uint32_t vertexCount, const float* transform, void* destination) {
+	static_assert(Layout::sizes[0] == 3 * sizeof(float) && Layout::offsets[0] == 0, "batched layouts start with a float3 position");
+	std::memcpy(destination, source, (size_t)vertexCount * Layout::stride);
+	if (!transform) {
+		return;
+	}
+	unsigned char* out = (unsigned char*)destination;
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		float p[3];
+		std::memcpy(p, out + (size_t)v * Layout::stride, sizeof(p));
+		float t[3];
+		for (int r = 0; r < 3; r++) {
+			t[r] = transform[r] * p[0] + transform[4 + r] * p[1] + transform[8 + r] * p[2] + transform[12 + r];
+		}
+		std::memcpy(out + (size_t)v * Layout::stride, t, sizeof(t));
+	}
+}
+
+// merges objects that never move into one mesh per key at load time; the
+// merged meshes live in a MeshPool, so rendering every batch binds one VAO
+template <typename Layout>
+class StaticBatcher {
+public:
+	StaticBatcher(uint32_t verticesPerPage = 1 << 20, uint32_t indicesPerPage = 3 << 20, unsigned int program = 0)
+		: pool(verticesPerPage, indicesPerPage, program), verticesPerPage(verticesPerPage), indicesPerPage(indicesPerPage) {}
+
+	StaticBatcher(const StaticBatcher&) = delete;
+	StaticBatcher& operator=(const StaticBatcher&) = delete;
+
+	// queues an object; its vertices are pre-transformed into world space
+	void add(const BatchKey& key, const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount,
+		const float* transform = nullptr) {
+		if (!batchableMode(key.mode)) {
+			std::cout << "ERROR::BATCHER::MODE_NOT_BATCHABLE " << key.mode << std::endl;
+			return;
+		}
+		Pending& batch = pendingFor(key);
+		size_t firstVertex = batch.vertices.size() / Layout::stride;
+		batch.vertices.resize(batch.vertices.size() + (size_t)vertexCount * Layout::stride);
+		transformVertices<Layout>(vertices, vertexCount, transform, &batch.vertices[firstVertex * Layout::stride]);
+		for (uint32_t i = 0; i < indexCount; i++) {
+			batch.indices.push_back((unsigned int)firstVertex + indices[i]);
+		}
+		batch.objectSizes.push_back({ vertexCount, indexCount });
+		stats.objects++;
+	}
+
+	// uploads the queued objects, one mesh per key, split only where a batch
+	// outgrows a pool page
+	void build() {
+		std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.key < b.key; });
+		for (Pending& batch : pending) {
+			size_t vertexStart = 0, indexStart = 0;
+			size_t vertexEnd = 0, indexEnd = 0;
+			for (size_t o = 0; o <= batch.objectSizes.size(); o++) {
+				bool last = o == batch.objectSizes.size();
+				bool fits = !last && vertexEnd - vertexStart + batch.objectSizes[o].first <= verticesPerPage
+					&& indexEnd - indexStart + batch.objectSizes[o].second <= indicesPerPage;
+				if ((last || !fits) && indexEnd > indexStart) {
+					upload(batch, vertexStart, vertexEnd, indexStart, indexEnd);
+					vertexStart = vertexEnd;
+					indexStart = indexEnd;
+				}
+				if (!last) {
+					vertexEnd += batch.objectSizes[o].first;
+					indexEnd += batch.objectSizes[o].second;
+				}
+			}
+		}
+		stats.batches = (unsigned int)pending.size();
+		pending.clear();
+		pendingIndex.clear();
+
+		// render walks the pool page by page, so each page's VAO is bound once
+		std::stable_sort(batches.begin(), batches.end(), [](const Batch& a, const Batch& b) {
+			return a.mesh.page != b.mesh.page ? a.mesh.page < b.mesh.page : a.key < b.key;
+		});
+	}
+
+	// draws every batch page by page, calling apply whenever the key changes.
+	// all parts of a key that share a page go out in one multi-draw
+	void render(const std::function<void(const BatchKey&)>& apply = applyBatchKey) {
+		pool.beginFrame();
+		stats.drawCalls = 0;
+		stats.stateChanges = 0;
+		const BatchKey* current = nullptr;
+		for (size_t begin = 0; begin < batches.size();) {
+			const Batch& first = batches[begin];
+			size_t end = begin;
+			counts.clear();
+			offsets.clear();
+			baseVertices.clear();
+			while (end < batches.size() && batches[end].mesh.page == first.mesh.page && batches[end].key == first.key) {
+				const MeshAllocation& mesh = batches[end].mesh;
+				counts.push_back(mesh.indexCount);
+				offsets.push_back((const void*)((size_t)mesh.firstIndex * sizeof(unsigned int)));
+				baseVertices.push_back(mesh.baseVertex);
+				end++;
+			}
+
+			if (!current || !(*current == first.key)) {
+				apply(first.key);
+				current = &first.key;
+				stats.stateChanges++;
+			}
+			pool.bind(first.mesh.page);
+			if (counts.size() == 1) {
+				glDrawElementsBaseVertex(first.key.mode, counts[0], GL_UNSIGNED_INT, offsets[0], baseVertices[0]);
+			}
+			else {
+				glMultiDrawElementsBaseVertex(first.key.mode, counts.data(), GL_UNSIGNED_INT, offsets.data(),
+					(GLsizei)counts.size(), baseVertices.data());
+			}
+			stats.drawCalls++;
+			begin = end;
+		}
+	}
+
+	BatchStats getStats() const {
+		return stats;
+	}
+
+	// deletes the merged meshes; must be called while the GL context is still alive
+	void clear() {
+		pool.clear();
+		batches.clear();
+		pending.clear();
+		pendingIndex.clear();
+		stats = BatchStats();
+	}
+
+private:
+	struct Pending {
+		BatchKey key;
+		std::vector<unsigned char> vertices;
+		std::vector<unsigned int> indices;
+		std::vector<std::pair<uint32_t, uint32_t>> objectSizes;
+	};
+
+	struct Batch {
+		BatchKey key;
+		MeshAllocation mesh;
+	};
+
+	MeshPool<Layout> pool;
+	uint32_t verticesPerPage;
+	uint32_t indicesPerPage;
+	std::vector<Pending> pending;
+	std::map<BatchKey, size_t> pendingIndex;
+	std::vector<Batch> batches;
+	BatchStats stats;
+
+	// draw arguments of one page and key, reused across renders
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<GLint> baseVertices;
+
+	Pending& pendingFor(const BatchKey& key) {
+		auto found = pendingIndex.find(key);
+		if (found != pendingIndex.end()) {
+			return pending[found->second];
+		}
+		pendingIndex[key] = pending.size();
+		pending.emplace_back();
+		pending.back().key = key;
+		return pending.back();
+	}
+
+	void upload(const Pending& batch, size_t vertexStart, size_t vertexEnd, size_t indexStart, size_t indexEnd) {
+		// rebase the indices of this part onto its first vertex
+		std::vector<unsigned int> indices(batch.indices.begin() + indexStart, batch.indices.begin() + indexEnd);
+		for (unsigned int& index : indices) {
+			index -= (unsigned int)vertexStart;
+		}
+		Batch merged;
+		merged.key = batch.key;
+		merged.mesh = pool.add(&batch.vertices[vertexStart * Layout::stride], (uint32_t)(vertexEnd - vertexStart),
+			indices.data(), (uint32_t)indices.size());
+		if (merged.mesh.valid()) {
+			batches.push_back(merged);
+		}
+	}
+};
+
+// concatenates small moving meshes every frame: submissions are sorted by key,
+// transformed on the CPU straight into stream buffers and drawn with one call
+// per key. a key whose data outgrows what is left of the frame's stream space
+// is split over several draws, and objects that fit nowhere are counted as
+// dropped. submitted vertex and index data must stay valid until render()
+template <typename Layout>
+class DynamicBatcher {
+public:
+	DynamicBatcher(size_t vertexBytesPerFrame = 4 << 20, size_t indexBytesPerFrame = 2 << 20, unsigned int program = 0) {
+		// the index stream is mapped through GL_COPY_WRITE_BUFFER so mapping
+		// never touches the element binding of whichever VAO is bound
+		vertexStream.reset(new StreamBuffer(GL_ARRAY_BUFFER, vertexBytesPerFrame));
+		indexStream.reset(new StreamBuffer(GL_COPY_WRITE_BUFFER, indexBytesPerFrame));
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexStream->buffer());
+		Layout::setup(vertexStream->buffer(), program);
+		glBindVertexArray(0);
+	}
+
+	~DynamicBatcher() {
+		clear();
+	}
+
+	DynamicBatcher(const DynamicBatcher&) = delete;
+	DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+	void beginFrame() {
+		submissions.clear();
+		vertexStream->beginFrame();
+		indexStream->beginFrame();
+	}
+
+	void submit(const BatchKey& key, const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount,
+		const float* transform = nullptr) {
+		if (!batchableMode(key.mode)) {
+			std::cout << "ERROR::BATCHER::MODE_NOT_BATCHABLE " << key.mode << std::endl;
+			return;
+		}
+		Submission submission;
+		submission.key = key;
+		submission.vertices = vertices;
+		submission.vertexCount = vertexCount;
+		submission.indices = indices;
+		submission.indexCount = indexCount;
+		if (transform) {
+			std::memcpy(submission.transform, transform, sizeof(submission.transform));
+			submission.hasTransform = true;
+		}
+		submissions.push_back(submission);
+	}
+
+	// writes and draws this frame's submissions, calling apply whenever the key changes
+	void render(const std::function<void(const BatchKey&)>& apply = applyBatchKey) {
+		std::stable_sort(submissions.begin(), submissions.end(), [](const Submission& a, const Submission& b) { return a.key < b.key; });
+		stats.objects = (unsigned int)submissions.size();
+		stats.batches = 0;
+		stats.drawCalls = 0;
+		stats.stateChanges = 0;
+		stats.dropped = 0;
+
+		// write every batch first, so the streams are flushed once before drawing
+		struct Draw {
+			size_t submission;
+			GLint baseVertex;
+			size_t indexOffset;
+			GLsizei indexCount;
+		};
+		std::vector<Draw> draws;
+		for (size_t begin = 0; begin < submissions.size();) {
+			size_t end = begin;
+			while (end < submissions.size() && submissions[end].key == submissions[begin].key) {
+				end++;
+			}
+			stats.batches++;
+
+			// take as many of the key's submissions as the streams still hold
+			for (size_t first = begin; first < end;) {
+				size_t vertexRoom = vertexStream->available(Layout::stride) / Layout::stride;
+				size_t indexRoom = indexStream->available(sizeof(unsigned int)) / sizeof(unsigned int);
+				size_t last = first;
+				size_t vertexCount = 0, indexCount = 0;
+				while (last < end && vertexCount + submissions[last].vertexCount <= vertexRoom
+					&& indexCount + submissions[last].indexCount <= indexRoom) {
+					vertexCount += submissions[last].vertexCount;
+					indexCount += submissions[last].indexCount;
+					last++;
+				}
+				if (last == first) {
+					// this one does not fit; a smaller one after it still might
+					stats.dropped++;
+					first++;
+					continue;
+				}
+
+				StreamAllocation vertexSpace = vertexStream->allocate(vertexCount * Layout::stride, Layout::stride);
+				StreamAllocation indexSpace = indexStream->allocate(indexCount * sizeof(unsigned int), sizeof(unsigned int));
+				if (!vertexSpace.valid() || !indexSpace.valid()) {
+					stats.dropped += (unsigned int)(end - first);
+					break;
+				}
+				unsigned char* vertexOut = (unsigned char*)vertexSpace.data;
+				unsigned int* indexOut = (unsigned int*)indexSpace.data;
+				uint32_t firstVertex = 0;
+				for (size_t s = first; s < last; s++) {
+					const Submission& submission = submissions[s];
+					transformVertices<Layout>(submission.vertices, submission.vertexCount,
+						submission.hasTransform ? submission.transform : nullptr, vertexOut + (size_t)firstVertex * Layout::stride);
+					for (uint32_t i = 0; i < submission.indexCount; i++) {
+						*indexOut++ = firstVertex + submission.indices[i];
+					}
+					firstVertex += submission.vertexCount;
+				}
+				draws.push_back({ first, (GLint)(vertexSpace.offset / Layout::stride), indexSpace.offset, (GLsizei)indexCount });
+				first = last;
+			}
+			begin = end;
+		}
+		vertexStream->flush();
+		indexStream->flush();
+
+		glBindVertexArray(VAO);
+		const BatchKey* current = nullptr;
+		for (const Draw& draw : draws) {
+			const BatchKey& key = submissions[draw.submission].key;
+			if (!current || !(*current == key)) {
+				apply(key);
+				current = &key;
+				stats.stateChanges++;
+			}
+			glDrawElementsBaseVertex(key.mode, draw.indexCount, GL_UNSIGNED_INT, (void*)draw.indexOffset, draw.baseVertex);
+			stats.drawCalls++;
+		}
+	}
+
+	// fences this frame's stream regions; call after render
+	void endFrame() {
+		vertexStream->endFrame();
+		indexStream->endFrame();
+	}
+
+	BatchStats getStats() const {
+		return stats;
+	}
+
+	// deletes the streams and VAO; must be called while the GL context is still alive
+	void clear() {
+		if (VAO != 0) {
+			glDeleteVertexArrays(1, &VAO);
+			VAO = 0;
+		}
+		if (vertexStream) {
+			vertexStream->clear();
+			indexStream->clear();
+		}
+	}
+
+private:
+	struct Submission {
+		BatchKey key;
+		const void* vertices = nullptr;
+		uint32_t vertexCount = 0;
+		const unsigned int* indices = nullptr;
+		uint32_t indexCount = 0;
+		float transform[16];
+		bool hasTransform = false;
+	};
+
+	unsigned int VAO = 0;
+	std::unique_ptr<StreamBuffer> vertexStream;
+	std::unique_ptr<StreamBuffer> indexStream;
+	std::vector<Submission> submissions;
+	BatchStats stats;
+};
+
+#endif
@@ -0,0 +1,507 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "frustum.h"
+
+struct Aabb {
+	float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	void grow(const Aabb& other) {
+		for (int c = 0; c < 3; c++) {
+			min[c] = std::min(min[c], other.min[c]);
+			max[c] = std::max(max[c], other.max[c]);
+		}
+	}
+
+	void grow(const float* point) {
+		for (int c = 0; c < 3; c++) {
+			min[c] = std::min(min[c], point[c]);
+			max[c] = std::max(max[c], point[c]);
+		}
+	}
+
+	// half the surface area, which is all SAH needs
+	float halfArea() const {
+		float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+		return dx < 0.0f ? 0.0f : dx * dy + dy * dz + dz * dx;
+	}
+};
+
+// 32 bytes, two to a cache line. nodes are stored depth first, so the left
+// child of an interior node is the node right after it and every subtree
+// covers a contiguous run of nodes and of object indices
+struct BvhNode {
+	float boundsMin[3];
+	unsigned int offset;	// interior: index of the right child; leaf: first entry in Bvh::objectIndices()
+	float boundsMax[3];
+	unsigned int count;		// objects in a leaf, 0 for interior nodes
+};
+
+const unsigned int BVH_NO_HIT = ~0u;
+const int BVH_MAX_DEPTH = 64;
+
+// bounding volume hierarchy over object boxes for frustum, ray and
+// neighbourhood queries. built top down with binned SAH; moving objects are
+// handled by updating their boxes and refitting, which keeps the topology
+class Bvh {
+public:
+	static const int BINS = 16;
+	static const unsigned int MAX_LEAF_SIZE = 8;
+	static const size_t MIN_OBJECTS_PER_THREAD = 32768;
+
+	// builds over count object boxes; object i is reported as i by the queries.
+	// large scenes build their top subtrees on up to threads threads
+	void build(const Aabb* objectBounds, size_t count, unsigned int threads = 0) {
+		boxes.assign(objectBounds, objectBounds + count);
+		centers.resize(count * 3);
+		for (size_t i = 0; i < count; i++) {
+			for (int c = 0; c < 3; c++) {
+				centers[i * 3 + c] = (boxes[i].min[c] + boxes[i].max[c]) * 0.5f;
+			}
+		}
+		objects.resize(count);
+		std::iota(objects.begin(), objects.end(), 0u);
+		nodes.clear();
+		if (count == 0) {
+			return;
+		}
+
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		// each parallel level doubles the subtrees being built at once
+		int parallelLevels = 0;
+		while ((1u << parallelLevels) < threads) {
+			parallelLevels++;
+		}
+		if (parallelLevels == 0) {
+			nodes.reserve(count / MAX_LEAF_SIZE * 4);
+			buildNode(nodes, 0, count, 0);
+		}
+		else {
+			nodes = buildParallel(0, count, 0, parallelLevels);
+		}
+	}
+
+	// replaces an object's box; call refit once all moved objects are updated
+	void update(unsigned int object, const Aabb& bounds) {
+		boxes[object] = bounds;
+	}
+
+	// recomputes every node's bounds bottom up from the current object boxes.
+	// much cheaper than a build, but the tree degrades when objects move far
+	void refit() {
+		for (size_t i = nodes.size(); i-- > 0;) {
+			BvhNode& node = nodes[i];
+			Aabb bounds;
+			if (node.count > 0) {
+				for (unsigned int k = 0; k < node.count; k++) {
+					bounds.grow(boxes[objects[node.offset + k]]);
+				}
+			}
+			else {
+				bounds.grow(nodeBounds(nodes[i + 1]));
+				bounds.grow(nodeBounds(nodes[node.offset]));
+			}
+			setBounds(node, bounds);
+		}
+	}
+
+	// appends the objects whose boxes touch the frustum to out, returning how many there are
+	size_t queryFrustum(const Frustum& frustum, std::vector<unsigned int>& out) const {
+		size_t before = out.size();
+		if (nodes.empty()) {
+			return 0;
+		}
+		// a plane drops out of the mask once a node is entirely inside it
+		struct Entry {
+			unsigned int node;
+			unsigned int planeMask;
+		};
+		Entry stack[BVH_MAX_DEPTH * 2];
+		int top = 0;
+		stack[top++] = { 0, 0x3F };
+		while (top > 0) {
+			Entry entry = stack[--top];
+			const BvhNode& node = nodes[entry.node];
+			unsigned int mask = entry.planeMask;
+			if (mask != 0 && !boxInPlanes(frustum, node.boundsMin, node.boundsMax, mask)) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (unsigned int k = 0; k < node.count; k++) {
+					unsigned int object = objects[node.offset + k];
+					unsigned int objectMask = mask;
+					if (mask == 0 || boxInPlanes(frustum, boxes[object].min, boxes[object].max, objectMask)) {
+						out.push_back(object);
+					}
+				}
+				continue;
+			}
+			stack[top++] = { node.offset, mask };
+			stack[top++] = { entry.node + 1, mask };
+		}
+		return out.size() - before;
+	}
+
+	// closest object along the ray within maxDistance, or BVH_NO_HIT. intersect(object,
+	// closest) returns the distance the ray hits the object at, or a negative value
+	// for a miss, so callers can test the actual geometry inside the box
+	template <typename Intersect>
+	unsigned int raycast(const float* origin, const float* direction, float& maxDistance, Intersect&& intersect) const {
+		unsigned int hit = BVH_NO_HIT;
+		if (nodes.empty()) {
+			return hit;
+		}
+		float inverse[3];
+		for (int c = 0; c < 3; c++) {
+			inverse[c] = 1.0f / direction[c];
+		}
+		// entries keep the distance the ray enters them at, so boxes behind a
+		// hit found meanwhile are skipped
+		struct Entry {
+			unsigned int node;
+			float distance;
+		};
+		Entry stack[BVH_MAX_DEPTH * 2];
+		int top = 0;
+		float rootDistance = rayBox(origin, inverse, nodes[0].boundsMin, nodes[0].boundsMax, maxDistance);
+		if (rootDistance < 0.0f) {
+			return hit;
+		}
+		stack[top++] = { 0, rootDistance };
+		while (top > 0) {
+			Entry entry = stack[--top];
+			if (entry.distance > maxDistance) {
+				continue;
+			}
+			const BvhNode& node = nodes[entry.node];
+			if (node.count > 0) {
+				for (unsigned int k = 0; k < node.count; k++) {
+					unsigned int object = objects[node.offset + k];
+					float distance = intersect(object, maxDistance);
+					if (distance >= 0.0f && distance < maxDistance) {
+						maxDistance = distance;
+						hit = object;
+					}
+				}
+				continue;
+			}
+			// the nearer child is visited first so the farther one may be cut by its hit
+			Entry nearChild = { entry.node + 1, 0.0f }, farChild = { node.offset, 0.0f };
+			nearChild.distance = rayBox(origin, inverse, nodes[nearChild.node].boundsMin, nodes[nearChild.node].boundsMax, maxDistance);
+			farChild.distance = rayBox(origin, inverse, nodes[farChild.node].boundsMin, nodes[farChild.node].boundsMax, maxDistance);
+			if (farChild.distance >= 0.0f && (nearChild.distance < 0.0f || farChild.distance < nearChild.distance)) {
+				std::swap(nearChild, farChild);
+			}
+			if (farChild.distance >= 0.0f) {
+				stack[top++] = farChild;
+			}
+			if (nearChild.distance >= 0.0f) {
+				stack[top++] = nearChild;
+			}
+		}
+		return hit;
+	}
+
+	// closest object box along the ray
+	unsigned int raycast(const float* origin, const float* direction, float& maxDistance) const {
+		float inverse[3];
+		for (int c = 0; c < 3; c++) {
+			inverse[c] = 1.0f / direction[c];
+		}
+		return raycast(origin, direction, maxDistance, [&](unsigned int object, float closest) {
+			return rayBox(origin, inverse, boxes[object].min, boxes[object].max, closest);
+		});
+	}
+
+	// appends the objects whose boxes come within radius of center to out,
+	// returning how many there are
+	size_t querySphere(const float* center, float radius, std::vector<unsigned int>& out) const {
+		size_t before = out.size();
+		float radiusSquared = radius * radius;
+		forEachOverlap([&](const float* minCorner, const float* maxCorner) {
+			return boxDistanceSquared(center, minCorner, maxCorner) <= radiusSquared;
+		}, out);
+		return out.size() - before;
+	}
+
+	// appends the objects whose boxes overlap bounds to out, returning how many there are
+	size_t queryBox(const Aabb& bounds, std::vector<unsigned int>& out) const {
+		size_t before = out.size();
+		forEachOverlap([&](const float* minCorner, const float* maxCorner) {
+			return minCorner[0] <= bounds.max[0] && maxCorner[0] >= bounds.min[0]
+				&& minCorner[1] <= bounds.max[1] && maxCorner[1] >= bounds.min[1]
+				&& minCorner[2] <= bounds.max[2] && maxCorner[2] >= bounds.min[2];
+		}, out);
+		return out.size() - before;
+	}
+
+	const std::vector<BvhNode>& getNodes() const {
+		return nodes;
+	}
+
+	const std::vector<unsigned int>& objectIndices() const {
+		return objects;
+	}
+
+	const Aabb& objectBounds(unsigned int object) const {
+		return boxes[object];
+	}
+
+	size_t size() const {
+		return boxes.size();
+	}
+
+	// entry distance of the ray into the box, clamped to 0 when it starts
+	// inside, or -1 when it misses the box before maxDistance
+	static float rayBox(const float* origin, const float* inverse, const float* minCorner, const float* maxCorner,
+		float maxDistance) {
+		float enter = 0.0f, exit = maxDistance;
+		for (int c = 0; c < 3; c++) {
+			float t0 = (minCorner[c] - origin[c]) * inverse[c];
+			float t1 = (maxCorner[c] - origin[c]) * inverse[c];
+			// min / max with the running interval first keeps NaNs from 0 * inf out
+			enter = std::max(enter, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
+		}
+		return enter <= exit ? enter : -1.0f;
+	}
+
+private:
+	static Aabb nodeBounds(const BvhNode& node) {
+		Aabb bounds;
+		std::copy(node.boundsMin, node.boundsMin + 3, bounds.min);
+		std::copy(node.boundsMax, node.boundsMax + 3, bounds.max);
+		return bounds;
+	}
+
+	static void setBounds(BvhNode& node, const Aabb& bounds) {
+		std::copy(bounds.min, bounds.min + 3, node.boundsMin);
+		std::copy(bounds.max, bounds.max + 3, node.boundsMax);
+	}
+
+	// false when the box is outside one of the planes in mask; planes the box is
+	// entirely inside are cleared from mask
+	static bool boxInPlanes(const Frustum& frustum, const float* minCorner, const float* maxCorner, unsigned int& mask) {
+		for (int p = 0; p < 6; p++) {
+			if (!(mask & (1u << p))) {
+				continue;
+			}
+			const float* plane = frustum.planes[p];
+			float distance = plane[3], reach = 0.0f;
+			for (int c = 0; c < 3; c++) {
+				float center = (minCorner[c] + maxCorner[c]) * 0.5f, extent = (maxCorner[c] - minCorner[c]) * 0.5f;
+				distance += plane[c] * center;
+				reach += std::fabs(plane[c]) * extent;
+			}
+			if (distance + reach < 0.0f) {
+				return false;
+			}
+			if (distance - reach >= 0.0f) {
+				mask &= ~(1u << p);
+			}
+		}
+		return true;
+	}
+
+	static float boxDistanceSquared(const float* point, const float* minCorner, const float* maxCorner) {
+		float distance = 0.0f;
+		for (int c = 0; c < 3; c++) {
+			float d = std::max(std::max(minCorner[c] - point[c], point[c] - maxCorner[c]), 0.0f);
+			distance += d * d;
+		}
+		return distance;
+	}
+
+	template <typename Overlaps>
+	void forEachOverlap(Overlaps&& overlaps, std::vector<unsigned int>& out) const {
+		if (nodes.empty()) {
+			return;
+		}
+		unsigned int stack[BVH_MAX_DEPTH * 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			unsigned int index = stack[--top];
+			const BvhNode& node = nodes[index];
+			if (!overlaps(node.boundsMin, node.boundsMax)) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (unsigned int k = 0; k < node.count; k++) {
+					unsigned int object = objects[node.offset + k];
+					if (overlaps(boxes[object].min, boxes[object].max)) {
+						out.push_back(object);
+					}
+				}
+				continue;
+			}
+			stack[top++] = node.offset;
+			stack[top++] = index + 1;
+		}
+	}
+
+	// bounds of the objects in [begin, end) and of their centers
+	void rangeBounds(size_t begin, size_t end, Aabb& bounds, Aabb& centerBounds) const {
+		for (size_t i = begin; i < end; i++) {
+			bounds.grow(boxes[objects[i]]);
+			centerBounds.grow(&centers[objects[i] * 3]);
+		}
+	}
+
+	// partitions objects[begin, end) at the cheapest binned SAH split and
+	// returns where the right side starts, or begin when a leaf is cheaper
+	size_t split(size_t begin, size_t end, const Aabb& bounds, const Aabb& centerBounds, int depth) {
+		size_t count = end - begin;
+		if (count <= 2 || depth >= BVH_MAX_DEPTH - 1) {
+			return begin;
+		}
+		struct Bin {
+			Aabb bounds;
+			size_t count = 0;
+		};
+		// one pass over the objects fills the bins of all three axes
+		float scales[3];
+		for (int axis = 0; axis < 3; axis++) {
+			float extent = centerBounds.max[axis] - centerBounds.min[axis];
+			scales[axis] = extent > 0.0f ? BINS / extent : 0.0f;
+		}
+		Bin bins[3][BINS];
+		for (size_t i = begin; i < end; i++) {
+			unsigned int object = objects[i];
+			const Aabb& box = boxes[object];
+			for (int axis = 0; axis < 3; axis++) {
+				int bin = std::min(BINS - 1, (int)((centers[object * 3 + axis] - centerBounds.min[axis]) * scales[axis]));
+				bins[axis][bin].bounds.grow(box);
+				bins[axis][bin].count++;
+			}
+		}
+
+		float bestCost = FLT_MAX, bestScale = 0.0f;
+		int bestAxis = -1, bestBin = 0;
+		for (int axis = 0; axis < 3; axis++) {
+			if (scales[axis] == 0.0f) {
+				continue;
+			}
+			// sweep from the right, then from the left, costing every split plane
+			float rightCosts[BINS];
+			Aabb right;
+			size_t rightCount = 0;
+			for (int b = BINS - 1; b > 0; b--) {
+				right.grow(bins[axis][b].bounds);
+				rightCount += bins[axis][b].count;
+				rightCosts[b] = rightCount * right.halfArea();
+			}
+			Aabb left;
+			size_t leftCount = 0;
+			for (int b = 0; b < BINS - 1; b++) {
+				left.grow(bins[axis][b].bounds);
+				leftCount += bins[axis][b].count;
+				if (leftCount == 0 || leftCount == count) {
+					continue;
+				}
+				float cost = leftCount * left.halfArea() + rightCosts[b + 1];
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+					bestScale = scales[axis];
+				}
+			}
+		}
+
+		// one traversal step costs about as much as one object test
+		float leafCost = count * bounds.halfArea();
+		float splitCost = bounds.halfArea() + bestCost;
+		if (count <= MAX_LEAF_SIZE && (bestAxis < 0 || leafCost <= splitCost)) {
+			return begin;
+		}
+		if (bestAxis < 0) {
+			// every center is the same, any halving is as good as another
+			return begin + count / 2;
+		}
+		auto middle = std::partition(objects.begin() + begin, objects.begin() + end, [&](unsigned int object) {
+			return std::min(BINS - 1, (int)((centers[object * 3 + bestAxis] - centerBounds.min[bestAxis]) * bestScale)) <= bestBin;
+		});
+		return (size_t)(middle - objects.begin());
+	}
+
+	// appends the subtree over objects[begin, end) to out, depth first
+	void buildNode(std::vector<BvhNode>& out, size_t begin, size_t end, int depth) {
+		Aabb bounds, centerBounds;
+		rangeBounds(begin, end, bounds, centerBounds);
+		size_t index = out.size();
+		out.push_back(BvhNode());
+		setBounds(out[index], bounds);
+
+		size_t middle = split(begin, end, bounds, centerBounds, depth);
+		if (middle == begin) {
+			out[index].offset = (unsigned int)begin;
+			out[index].count = (unsigned int)(end - begin);
+			return;
+		}
+		buildNode(out, begin, middle, depth + 1);
+		out[index].offset = (unsigned int)out.size();
+		out[index].count = 0;
+		buildNode(out, middle, end, depth + 1);
+	}
+
+	// builds both halves of the top levels at once, each into its own node
+	// list, then joins the lists with the child indices moved along
+	std::vector<BvhNode> buildParallel(size_t begin, size_t end, int depth, int parallelLevels) {
+		std::vector<BvhNode> out;
+		if (parallelLevels == 0 || end - begin < MIN_OBJECTS_PER_THREAD * 2) {
+			buildNode(out, begin, end, depth);
+			return out;
+		}
+		Aabb bounds, centerBounds;
+		rangeBounds(begin, end, bounds, centerBounds);
+		BvhNode root;
+		setBounds(root, bounds);
+		size_t middle = split(begin, end, bounds, centerBounds, depth);
+		if (middle == begin) {
+			root.offset = (unsigned int)begin;
+			root.count = (unsigned int)(end - begin);
+			out.push_back(root);
+			return out;
+		}
+
+		std::vector<BvhNode> left;
+		std::thread worker([&]() {
+			left = buildParallel(begin, middle, depth + 1, parallelLevels - 1);
+		});
+		std::vector<BvhNode> right = buildParallel(middle, end, depth + 1, parallelLevels - 1);
+		worker.join();
+
+		root.offset = (unsigned int)(1 + left.size());
+		root.count = 0;
+		out.reserve(1 + left.size() + right.size());
+		out.push_back(root);
+		for (const std::vector<BvhNode>* half : { &left, &right }) {
+			unsigned int base = (unsigned int)out.size();
+			for (BvhNode node : *half) {
+				if (node.count == 0) {
+					node.offset += base;
+				}
+				out.push_back(node);
+			}
+		}
+		return out;
+	}
+
+	std::vector<BvhNode> nodes;
+	std::vector<unsigned int> objects;		// object indices in leaf order
+	std::vector<Aabb> boxes;
+	std::vector<float> centers;
+};
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <cmath>
+#include <iostream>
+#include "frustum.h"
+#include "gl_extensions.h"
+#include "simd_math.h"
+
+// how view depth lands in the depth buffer. reversed depth puts the near
+// plane at 1 and infinity at 0, so the distant end of the scene gets the
+// small floats with their dense exponents; with a floating point depth
+// buffer that roughly cancels the 1 / z falloff of perspective depth.
+// the gain needs glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE): in the
+// default -1 to 1 clip depth, the * 0.5 + 0.5 to window depth rounds the
+// small values away again, so DEPTH_REVERSED only keeps the infinite far
+// plane and the GL_GREATER conventions working without it
+enum DepthMode {
+	DEPTH_STANDARD,					// near at 0, far at 1, GL_LESS
+	DEPTH_REVERSED,					// near at 1, far at 0, GL_GREATER, -1 to 1 clip depth
+	DEPTH_REVERSED_ZERO_TO_ONE		// as DEPTH_REVERSED with 0 to 1 clip depth through ARB_clip_control
+};
+
+// the better of the reversed modes on the current context; needs loadGLExtensions first
+inline DepthMode reversedDepthMode() {
+	return glext.clipControl ? DEPTH_REVERSED_ZERO_TO_ONE : DEPTH_REVERSED;
+}
+
+// sets clip control, depth test and clear depth for mode. reversed depth is
+// meant for a GL_DEPTH_COMPONENT32F depth buffer; 24 bit fixed point depth
+// is evenly spaced and gains nothing from being flipped
+inline void applyDepthMode(DepthMode mode) {
+	if (mode == DEPTH_REVERSED_ZERO_TO_ONE && !glext.clipControl) {
+		std::cout << "ERROR::CAMERA::CLIP_CONTROL_NOT_SUPPORTED" << std::endl;
+	}
+	if (glext.clipControl) {
+		glext.ClipControl(GL_LOWER_LEFT, mode == DEPTH_REVERSED_ZERO_TO_ONE ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+	}
+	bool reversed = mode != DEPTH_STANDARD;
+	glDepthFunc(reversed ? GL_GREATER : GL_LESS);
+	glClearDepth(reversed ? 0.0 : 1.0);
+}
+
+// right handed perspective for mode; a farPlane of 0 puts the far plane at
+// infinity, which reversed depth handles without losing precision up close
+inline Mat4 perspectiveProjection(float fovY, float aspect, float nearPlane, float farPlane, DepthMode mode) {
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	bool infinite = farPlane <= 0.0f;
+	// clip z = a * view z + b, with clip w = -view z
+	float a, b;
+	if (mode == DEPTH_STANDARD) {
+		a = infinite ? -1.0f : (farPlane + nearPlane) / (nearPlane - farPlane);
+		b = infinite ? -2.0f * nearPlane : 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+	}
+	else if (mode == DEPTH_REVERSED) {
+		a = infinite ? 1.0f : (farPlane + nearPlane) / (farPlane - nearPlane);
+		b = infinite ? 2.0f * nearPlane : 2.0f * farPlane * nearPlane / (farPlane - nearPlane);
+	}
+	else {
+		a = infinite ? 0.0f : nearPlane / (farPlane - nearPlane);
+		b = infinite ? nearPlane : farPlane * nearPlane / (farPlane - nearPlane);
+	}
+	return Mat4(f / aspect, 0, 0, 0, 0, f, 0, 0, 0, 0, a, -1, 0, 0, b, 0);
+}
+
+// a perspective camera that builds its matrices and frustum planes only
+// when something they depend on changed. the projection can carry a sub
+// pixel jitter for temporal antialiasing; culling and the previous frame's
+// matrix for reprojection use the unjittered one
+class Camera {
+public:
+	// fovY in radians; a farPlane of 0 is infinite
+	Camera(float fovY = 0.785398f, float aspect = 16.0f / 9.0f, float nearPlane = 0.1f, float farPlane = 0.0f,
+		DepthMode depthMode = DEPTH_STANDARD)
+		: fovY(fovY), aspect(aspect), nearPlane(nearPlane), farPlane(farPlane), depthMode(depthMode) {}
+
+	void setPosition(const Vec3& value) {
+		position = value;
+		viewDirty = true;
+	}
+
+	const Vec3& getPosition() const {
+		return position;
+	}
+
+	// rotation from looking down -z with y up
+	void setOrientation(const Quat& value) {
+		orientation = normalize(value);
+		viewDirty = true;
+	}
+
+	const Quat& getOrientation() const {
+		return orientation;
+	}
+
+	// radians; yaw turns left around y, pitch looks up
+	void setYawPitch(float yaw, float pitch) {
+		setOrientation(Quat::fromAxisAngle(Vec3(0.0f, 1.0f, 0.0f), yaw) * Quat::fromAxisAngle(Vec3(1.0f, 0.0f, 0.0f), pitch));
+	}
+
+	// turns to face target, keeping y up
+	void lookAt(const Vec3& target) {
+		Vec3 direction = normalize(target - position);
+		setYawPitch(std::atan2(-direction.x, -direction.z), std::asin(std::fmax(-1.0f, std::fmin(1.0f, direction.y))));
+	}
+
+	Vec3 forward() const {
+		return rotate(orientation, Vec3(0.0f, 0.0f, -1.0f));
+	}
+
+	Vec3 right() const {
+		return rotate(orientation, Vec3(1.0f, 0.0f, 0.0f));
+	}
+
+	Vec3 up() const {
+		return rotate(orientation, Vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	void setPerspective(float fovYValue, float aspectValue, float nearValue, float farValue = 0.0f) {
+		fovY = fovYValue;
+		aspect = aspectValue;
+		nearPlane = nearValue;
+		farPlane = farValue;
+		projectionDirty = true;
+	}
+
+	void setDepthMode(DepthMode mode) {
+		depthMode = mode;
+		projectionDirty = true;
+	}
+
+	DepthMode getDepthMode() const {
+		return depthMode;
+	}
+
+	// the size jitter is measured against; also sets the aspect ratio
+	void setViewport(int width, int height) {
+		viewportWidth = width > 0 ? width : 1;
+		viewportHeight = height > 0 ? height : 1;
+		aspect = (float)viewportWidth / viewportHeight;
+		projectionDirty = true;
+	}
+
+	// shifts the image by x, y pixels, normally within half a pixel
+	void setJitter(float x, float y) {
+		jitterX = x;
+		jitterY = y;
+		jitterDirty = true;
+	}
+
+	float getJitterX() const {
+		return jitterX;
+	}
+
+	float getJitterY() const {
+		return jitterY;
+	}
+
+	// jitters through the first length points of the Halton (2, 3) sequence,
+	// one per beginFrame; 0 stops jittering
+	void setJitterSequence(unsigned int length) {
+		jitterSequence = length;
+		jitterIndex = 0;
+		if (length == 0) {
+			setJitter(0.0f, 0.0f);
+		}
+	}
+
+	// call once a frame before moving the camera: keeps this view projection
+	// for reprojection and steps the jitter sequence
+	void beginFrame() {
+		previousViewProjection = getUnjitteredViewProjection();
+		if (jitterSequence > 0) {
+			jitterIndex = jitterIndex % jitterSequence + 1;
+			setJitter(halton(jitterIndex, 2) - 0.5f, halton(jitterIndex, 3) - 0.5f);
+		}
+	}
+
+	const Mat4& getView() const {
+		update();
+		return view;
+	}
+
+	// jittered
+	const Mat4& getProjection() const {
+		update();
+		return projection;
+	}
+
+	// jittered, for drawing
+	const Mat4& getViewProjection() const {
+		update();
+		return viewProjection;
+	}
+
+	const Mat4& getUnjitteredViewProjection() const {
+		update();
+		return unjitteredViewProjection;
+	}
+
+	// the unjittered view projection as of the last beginFrame
+	const Mat4& getPreviousViewProjection() const {
+		return previousViewProjection;
+	}
+
+	// jittered view projection of the camera moved to the origin, for camera
+	// relative rendering: object translations get the camera position taken
+	// off on the CPU (in double for large worlds) so no large coordinates
+	// reach the GPU
+	const Mat4& getRelativeViewProjection() const {
+		update();
+		return relativeViewProjection;
+	}
+
+	// world space planes of the unjittered view. the near and far planes come
+	// from the camera axis rather than the matrix, which works the same for
+	// every depth mode; with an infinite far plane the far plane is
+	// (0, 0, 0, 1) and passes everything
+	const Frustum& getFrustum() const {
+		update();
+		if (frustumDirty) {
+			frustum = extractFrustum(unjitteredViewProjection.m);
+			Vec3 axis = forward();
+			float distance = dot(axis, position);
+			float* nearEquation = frustum.planes[Frustum::NEAR_PLANE];
+			float* farEquation = frustum.planes[Frustum::FAR_PLANE];
+			nearEquation[0] = axis.x;
+			nearEquation[1] = axis.y;
+			nearEquation[2] = axis.z;
+			nearEquation[3] = -(distance + nearPlane);
+			if (farPlane > 0.0f) {
+				farEquation[0] = -axis.x;
+				farEquation[1] = -axis.y;
+				farEquation[2] = -axis.z;
+				farEquation[3] = distance + farPlane;
+			}
+			else {
+				farEquation[0] = farEquation[1] = farEquation[2] = 0.0f;
+				farEquation[3] = 1.0f;
+			}
+			frustumDirty = false;
+		}
+		return frustum;
+	}
+
+private:
+	// radical inverse of index in base, in [0, 1)
+	static float halton(unsigned int index, unsigned int base) {
+		float result = 0.0f, fraction = 1.0f;
+		while (index > 0) {
+			fraction /= (float)base;
+			result += fraction * (float)(index % base);
+			index /= base;
+		}
+		return result;
+	}
+
+	void update() const {
+		if (!viewDirty && !projectionDirty && !jitterDirty) {
+			return;
+		}
+		if (viewDirty) {
+			rotationView = Mat4::rotation(conjugate(orientation));
+			view = rotationView * Mat4::translation(-position);
+		}
+		if (projectionDirty) {
+			unjitteredProjection = perspectiveProjection(fovY, aspect, nearPlane, farPlane, depthMode);
+		}
+		if (viewDirty || projectionDirty) {
+			unjitteredViewProjection = unjitteredProjection * view;
+			frustumDirty = true;
+		}
+
+		// clip x gains m[8] * view z and is divided by -view z, so the shift
+		// goes in negated
+		projection = unjitteredProjection;
+		projection.m[8] -= 2.0f * jitterX / viewportWidth;
+		projection.m[9] -= 2.0f * jitterY / viewportHeight;
+		viewProjection = projection * view;
+		relativeViewProjection = projection * rotationView;
+		viewDirty = projectionDirty = jitterDirty = false;
+	}
+
+	Vec3 position;
+	Quat orientation;
+	float fovY, aspect, nearPlane, farPlane;
+	DepthMode depthMode;
+
+	int viewportWidth = 1920, viewportHeight = 1080;
+	float jitterX = 0.0f, jitterY = 0.0f;
+	unsigned int jitterSequence = 0, jitterIndex = 0;
+
+	// built on demand by the const getters
+	mutable Mat4 view, rotationView, unjitteredProjection, projection;
+	mutable Mat4 viewProjection, unjitteredViewProjection, relativeViewProjection;
+	mutable Frustum frustum;
+	mutable bool viewDirty = true, projectionDirty = true, jitterDirty = true, frustumDirty = true;
+	Mat4 previousViewProjection;
+};
+
+#endif
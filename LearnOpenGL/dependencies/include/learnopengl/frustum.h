@@ -0,0 +1,45 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cmath>
+
+// six planes (a, b, c, d) with a * x + b * y + c * z + d >= 0 inside and
+// unit length normals, in the space of the matrix they were taken from
+struct Frustum {
+	enum { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE };
+	float planes[6][4];
+};
+
+// extracts the planes of a column major projection * view (* model) matrix, so
+// giving it a model view projection puts the planes in object space
+inline Frustum extractFrustum(const float* m) {
+	Frustum frustum;
+	for (int i = 0; i < 3; i++) {
+		for (int c = 0; c < 4; c++) {
+			float row = m[c * 4 + i], w = m[c * 4 + 3];
+			frustum.planes[i * 2][c] = w + row;
+			frustum.planes[i * 2 + 1][c] = w - row;
+		}
+	}
+	for (float* plane : frustum.planes) {
+		float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length > 0.0f) {
+			for (int c = 0; c < 4; c++) {
+				plane[c] /= length;
+			}
+		}
+	}
+	return frustum;
+}
+
+// false when the sphere is entirely outside one of the planes
+inline bool sphereInFrustum(const Frustum& frustum, const float* center, float radius) {
+	for (const float* plane : frustum.planes) {
+		if (plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cfloat>
+#include <thread>
+#include <vector>
+#include "frustum.h"
+
+// SSE2 is always there on x64; the AVX loop is compiled alongside it for
+// AVX whatever the build flags say, and picked at run time when the CPU and
+// OS support it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLING_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__GNUC__)
+#define FRUSTUM_CULLING_AVX
+#include <immintrin.h>
+#endif
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(FRUSTUM_CULLING_AVX) && !defined(_MSC_VER) && !defined(__AVX__)
+#define FRUSTUM_CULLING_TARGET_AVX __attribute__((target("avx")))
+#else
+#define FRUSTUM_CULLING_TARGET_AVX
+#endif
+
+// bounding volumes of many objects as structure of arrays, so the culler
+// loads the same component of 4 objects at once, or 8 where AVX is available.
+// spheres and boxes share the store: a sphere has zero extents and a box,
+// kept as center and half extents, zero radius. the arrays are padded to a
+// multiple of 8, which either width divides, with volumes that are never visible
+class CullingBounds {
+public:
+	static const size_t WIDTH = 8;	// padding, the widest loop
+
+	unsigned int addSphere(const float* center, float radius) {
+		unsigned int index = grow();
+		setSphere(index, center, radius);
+		return index;
+	}
+
+	unsigned int addBox(const float* minCorner, const float* maxCorner) {
+		unsigned int index = grow();
+		setBox(index, minCorner, maxCorner);
+		return index;
+	}
+
+	void setSphere(unsigned int index, const float* center, float radius) {
+		x[index] = center[0];
+		y[index] = center[1];
+		z[index] = center[2];
+		r[index] = radius;
+		if (boxes) {
+			ex[index] = ey[index] = ez[index] = 0.0f;
+		}
+	}
+
+	void setBox(unsigned int index, const float* minCorner, const float* maxCorner) {
+		if (!boxes) {
+			// the extent arrays only exist once a box is added, spheres cull without them
+			boxes = true;
+			ex.assign(x.size(), 0.0f);
+			ey.assign(x.size(), 0.0f);
+			ez.assign(x.size(), 0.0f);
+		}
+		x[index] = (minCorner[0] + maxCorner[0]) * 0.5f;
+		y[index] = (minCorner[1] + maxCorner[1]) * 0.5f;
+		z[index] = (minCorner[2] + maxCorner[2]) * 0.5f;
+		ex[index] = (maxCorner[0] - minCorner[0]) * 0.5f;
+		ey[index] = (maxCorner[1] - minCorner[1]) * 0.5f;
+		ez[index] = (maxCorner[2] - minCorner[2]) * 0.5f;
+		r[index] = 0.0f;
+	}
+
+	void reserve(size_t count) {
+		size_t padded = (count + WIDTH - 1) / WIDTH * WIDTH;
+		for (std::vector<float>* component : { &x, &y, &z, &r }) {
+			component->reserve(padded);
+		}
+	}
+
+	void clear() {
+		for (std::vector<float>* component : { &x, &y, &z, &r, &ex, &ey, &ez }) {
+			component->clear();
+		}
+		count = 0;
+		boxes = false;
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	// size rounded up to WIDTH, the length of every array
+	size_t paddedSize() const {
+		return x.size();
+	}
+
+	bool hasBoxes() const {
+		return boxes;
+	}
+
+	std::vector<float> x, y, z, r;		// centers and sphere radii
+	std::vector<float> ex, ey, ez;		// box half extents, empty without boxes
+
+private:
+	unsigned int grow() {
+		if (count == x.size()) {
+			size_t padded = x.size() + WIDTH;
+			x.resize(padded, 0.0f);
+			y.resize(padded, 0.0f);
+			z.resize(padded, 0.0f);
+			// a negative infinite radius is outside every plane
+			r.resize(padded, -FLT_MAX);
+			if (boxes) {
+				ex.resize(padded, 0.0f);
+				ey.resize(padded, 0.0f);
+				ez.resize(padded, 0.0f);
+			}
+		}
+		return (unsigned int)count++;
+	}
+
+	size_t count = 0;
+	bool boxes = false;
+};
+
+inline unsigned int lowestCullBit(unsigned int mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// true when the CPU has AVX and the OS saves the ymm registers
+inline bool frustumCullingHasAvx() {
+#if defined(FRUSTUM_CULLING_AVX) && defined(_MSC_VER)
+	static const bool supported = []() {
+		int info[4];
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+		return osxsave && avx && (_xgetbv(0) & 6) == 6;
+	}();
+	return supported;
+#elif defined(FRUSTUM_CULLING_AVX)
+	static const bool supported = __builtin_cpu_supports("avx");
+	return supported;
+#else
+	return false;
+#endif
+}
+
+// name of the loop cullBoundsRange runs on this machine
+inline const char* frustumCullingPath() {
+#if defined(FRUSTUM_CULLING_SSE2)
+	return frustumCullingHasAvx() ? "avx" : "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+#if defined(FRUSTUM_CULLING_AVX)
+// 8 volumes per iteration; only called when frustumCullingHasAvx
+FRUSTUM_CULLING_TARGET_AVX inline size_t cullBoundsRangeAvx(const Frustum& frustum, const CullingBounds& bounds,
+	size_t begin, size_t end, unsigned int* visible) {
+	const bool boxes = bounds.hasBoxes();
+	size_t count = 0;
+	size_t i = begin;
+	__m256 planes[6][4], absNormals[6][3];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+		}
+		for (int c = 0; c < 3; c++) {
+			absNormals[p][c] = _mm256_set1_ps(std::fabs(frustum.planes[p][c]));
+		}
+	}
+	const __m256 zero = _mm256_setzero_ps();
+	for (; i < end; i += CullingBounds::WIDTH) {
+		__m256 cx = _mm256_loadu_ps(&bounds.x[i]), cy = _mm256_loadu_ps(&bounds.y[i]), cz = _mm256_loadu_ps(&bounds.z[i]);
+		__m256 radius = _mm256_loadu_ps(&bounds.r[i]);
+		__m256 ex = zero, ey = zero, ez = zero;
+		if (boxes) {
+			ex = _mm256_loadu_ps(&bounds.ex[i]);
+			ey = _mm256_loadu_ps(&bounds.ey[i]);
+			ez = _mm256_loadu_ps(&bounds.ez[i]);
+		}
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes[p][0], cx), _mm256_mul_ps(planes[p][1], cy)),
+				_mm256_add_ps(_mm256_mul_ps(planes[p][2], cz), planes[p][3]));
+			__m256 reach = radius;
+			if (boxes) {
+				reach = _mm256_add_ps(reach, _mm256_add_ps(_mm256_mul_ps(absNormals[p][0], ex),
+					_mm256_add_ps(_mm256_mul_ps(absNormals[p][1], ey), _mm256_mul_ps(absNormals[p][2], ez))));
+			}
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+		}
+		unsigned int mask = (unsigned int)_mm256_movemask_ps(inside);
+		while (mask) {
+			visible[count++] = (unsigned int)i + lowestCullBit(mask);
+			mask &= mask - 1;
+		}
+	}
+	return count;
+}
+#endif
+
+// writes the indices of the volumes in [begin, end) that touch the frustum to
+// visible, in order, and returns how many there are. begin is a multiple of
+// CullingBounds::WIDTH and end may run into the padding
+inline size_t cullBoundsRange(const Frustum& frustum, const CullingBounds& bounds, size_t begin, size_t end,
+	unsigned int* visible) {
+#if defined(FRUSTUM_CULLING_AVX)
+	if (frustumCullingHasAvx()) {
+		return cullBoundsRangeAvx(frustum, bounds, begin, end, visible);
+	}
+#endif
+	const bool boxes = bounds.hasBoxes();
+	size_t count = 0;
+	size_t i = begin;
+#if defined(FRUSTUM_CULLING_SSE2)
+	__m128 planes[6][4], absNormals[6][3];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+		}
+		for (int c = 0; c < 3; c++) {
+			absNormals[p][c] = _mm_set1_ps(std::fabs(frustum.planes[p][c]));
+		}
+	}
+	const __m128 zero = _mm_setzero_ps();
+	for (; i < end; i += 4) {
+		__m128 cx = _mm_loadu_ps(&bounds.x[i]), cy = _mm_loadu_ps(&bounds.y[i]), cz = _mm_loadu_ps(&bounds.z[i]);
+		__m128 radius = _mm_loadu_ps(&bounds.r[i]);
+		__m128 ex = zero, ey = zero, ez = zero;
+		if (boxes) {
+			ex = _mm_loadu_ps(&bounds.ex[i]);
+			ey = _mm_loadu_ps(&bounds.ey[i]);
+			ez = _mm_loadu_ps(&bounds.ez[i]);
+		}
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy)),
+				_mm_add_ps(_mm_mul_ps(planes[p][2], cz), planes[p][3]));
+			__m128 reach = radius;
+			if (boxes) {
+				reach = _mm_add_ps(reach, _mm_add_ps(_mm_mul_ps(absNormals[p][0], ex),
+					_mm_add_ps(_mm_mul_ps(absNormals[p][1], ey), _mm_mul_ps(absNormals[p][2], ez))));
+			}
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+		}
+		unsigned int mask = (unsigned int)_mm_movemask_ps(inside);
+		while (mask) {
+			visible[count++] = (unsigned int)i + lowestCullBit(mask);
+			mask &= mask - 1;
+		}
+	}
+#else
+	for (; i < end; i++) {
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++) {
+			const float* plane = frustum.planes[p];
+			float reach = bounds.r[i];
+			if (boxes) {
+				reach += std::fabs(plane[0]) * bounds.ex[i] + std::fabs(plane[1]) * bounds.ey[i] + std::fabs(plane[2]) * bounds.ez[i];
+			}
+			inside = plane[0] * bounds.x[i] + plane[1] * bounds.y[i] + plane[2] * bounds.z[i] + plane[3] + reach >= 0.0f;
+		}
+		if (inside) {
+			visible[count++] = (unsigned int)i;
+		}
+	}
+#endif
+	return count;
+}
+
+// culls every volume against the frustum and writes the indices of the
+// visible ones to the front of visible, returning how many. large sets are
+// split across threads, each culling its own range in place before the
+// ranges are moved together
+inline size_t cullFrustum(const Frustum& frustum, const CullingBounds& bounds, std::vector<unsigned int>& visible,
+	unsigned int threads = 0) {
+	const size_t MIN_OBJECTS_PER_THREAD = 65536;
+	size_t total = bounds.paddedSize();
+	if (visible.size() < total) {
+		visible.resize(total);
+	}
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = (unsigned int)std::min<size_t>(threads, std::max<size_t>(1, total / MIN_OBJECTS_PER_THREAD));
+	if (threads <= 1) {
+		return cullBoundsRange(frustum, bounds, 0, total, visible.data());
+	}
+
+	// chunks start on whole SIMD groups; the calling thread culls the last one itself
+	size_t chunk = (total / threads + CullingBounds::WIDTH - 1) / CullingBounds::WIDTH * CullingBounds::WIDTH;
+	std::vector<size_t> counts(threads, 0);
+	auto cullChunk = [&](unsigned int t) {
+		size_t begin = std::min(total, t * chunk);
+		size_t end = t + 1 == threads ? total : std::min(total, (t + 1) * chunk);
+		counts[t] = cullBoundsRange(frustum, bounds, begin, end, visible.data() + begin);
+	};
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t + 1 < threads; t++) {
+		workers.emplace_back(cullChunk, t);
+	}
+	cullChunk(threads - 1);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	size_t count = counts[0];
+	for (unsigned int t = 1; t < threads; t++) {
+		// the chunks are packed to the front, never forwards, so the destination
+		// only overlaps the source when they coincide and nothing has to move
+		size_t begin = std::min(total, t * chunk);
+		if (count != begin) {
+			std::copy(visible.begin() + begin, visible.begin() + begin + counts[t], visible.begin() + count);
+		}
+		count += counts[t];
+	}
+	return count;
+}
+
+#endif
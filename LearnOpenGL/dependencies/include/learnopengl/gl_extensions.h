@@ -0,0 +1,106 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+#include <cstring>
+
+// glad was generated for plain GL 3.3 core, so extensions are detected and
+// their entry points loaded at runtime
+
+// EXT/ARB_texture_filter_anisotropic
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+// ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// ARB_draw_indirect and ARB_multi_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#define GL_DRAW_INDIRECT_BUFFER_BINDING 0x8F43
+#endif
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+// ARB_clip_control
+#ifndef GL_ZERO_TO_ONE
+#define GL_CLIP_ORIGIN 0x935C
+#define GL_CLIP_DEPTH_MODE 0x935D
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+typedef void (APIENTRYP PFNGLCLIPCONTROLPROC)(GLenum origin, GLenum depth);
+
+// ARB_bindless_texture
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+
+// entry points of the optional extensions; null when the extension is missing
+struct GLExtensionProcs {
+	bool bindlessTexture = false;
+	PFNGLGETTEXTUREHANDLEARBPROC GetTextureHandleARB = nullptr;
+	PFNGLMAKETEXTUREHANDLERESIDENTARBPROC MakeTextureHandleResidentARB = nullptr;
+	PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC MakeTextureHandleNonResidentARB = nullptr;
+
+	bool bufferStorage = false;
+	PFNGLBUFFERSTORAGEPROC BufferStorage = nullptr;
+
+	bool clipControl = false;
+	PFNGLCLIPCONTROLPROC ClipControl = nullptr;
+
+	bool multiDrawIndirect = false;		// also needs ARB_draw_indirect for the buffer target
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+};
+
+inline GLExtensionProcs glext;
+
+// checks the extension list of the current context
+inline bool hasGLExtension(const char* name) {
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension && std::strcmp(extension, name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// loads the optional extensions; call once after gladLoadGLLoader with the same loader
+inline void loadGLExtensions(GLADloadproc load) {
+	glext = GLExtensionProcs();
+
+	if (hasGLExtension("GL_ARB_bindless_texture")) {
+		glext.GetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARBPROC)load("glGetTextureHandleARB");
+		glext.MakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)load("glMakeTextureHandleResidentARB");
+		glext.MakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)load("glMakeTextureHandleNonResidentARB");
+		glext.bindlessTexture = glext.GetTextureHandleARB && glext.MakeTextureHandleResidentARB
+			&& glext.MakeTextureHandleNonResidentARB;
+	}
+
+	if (hasGLExtension("GL_ARB_buffer_storage")) {
+		glext.BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+		glext.bufferStorage = glext.BufferStorage != nullptr;
+	}
+
+	if (hasGLExtension("GL_ARB_clip_control")) {
+		glext.ClipControl = (PFNGLCLIPCONTROLPROC)load("glClipControl");
+		glext.clipControl = glext.ClipControl != nullptr;
+	}
+
+	if (hasGLExtension("GL_ARB_draw_indirect") && hasGLExtension("GL_ARB_multi_draw_indirect")) {
+		glext.MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+		glext.multiDrawIndirect = glext.MultiDrawElementsIndirect != nullptr;
+	}
+}
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef HDR_IMAGE_H
+#define HDR_IMAGE_H
+
+#include <glad/glad.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../stb_image/stb_image.h"
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define HDR_IMAGE_F16C
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HDR_IMAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+// video memory formats a float image can be uploaded as
+enum class HdrFormat {
+	RGBA32F,	// 16 bytes per pixel, exact
+	RGBA16F,	// 8 bytes per pixel, half floats
+	RGB9_E5		// 4 bytes per pixel, three 9 bit mantissas sharing a 5 bit exponent
+};
+
+// linear RGBA float image
+struct HdrImage {
+	int width = 0, height = 0;
+	std::vector<float> pixels;
+
+	bool valid() const {
+		return !pixels.empty();
+	}
+};
+
+// one mip level converted to the bytes glTexImage2D expects for a format
+struct HdrLevel {
+	int width, height;
+	std::vector<unsigned char> data;
+};
+
+// decodes .hdr files, 16 bit PNGs and regular 8 bit images into linear floats
+inline HdrImage loadHdrImage(const std::string& path, bool flipVertically = false) {
+	HdrImage image;
+	int nChannels;
+	stbi_set_flip_vertically_on_load(flipVertically);
+
+	if (!stbi_is_hdr(path.c_str()) && stbi_is_16_bit(path.c_str())) {
+		// stbi_loadf would truncate 16 bit PNGs to 8 bits before converting
+		unsigned short* data = stbi_load_16(path.c_str(), &image.width, &image.height, &nChannels, 4);
+		if (data) {
+			size_t count = (size_t)image.width * image.height * 4;
+			image.pixels.resize(count);
+			for (size_t i = 0; i < count; i++) {
+				image.pixels[i] = data[i] / 65535.0f;
+			}
+			stbi_image_free(data);
+		}
+	}
+	else {
+		// 8 bit images are converted to linear space with stb_image's 2.2 gamma
+		float* data = stbi_loadf(path.c_str(), &image.width, &image.height, &nChannels, 4);
+		if (data) {
+			image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+			stbi_image_free(data);
+		}
+	}
+
+	if (!image.valid()) {
+		std::cout << "Failed to load: " << path << std::endl;
+	}
+	return image;
+}
+
+// rounds to the nearest even half, overflowing to infinity and keeping NaNs
+inline uint16_t floatToHalf(float value) {
+	uint32_t f;
+	std::memcpy(&f, &value, sizeof(f));
+	uint32_t sign = f & 0x80000000u;
+	f ^= sign;
+
+	uint32_t h;
+	if (f >= (127u + 16) << 23) {
+		h = f > 255u << 23 ? 0x7e00 : 0x7c00;
+	}
+	else if (f < 113u << 23) {
+		// subnormal or zero; let the FPU round the mantissa
+		const uint32_t magicBits = ((127u - 15) + (23 - 10) + 1) << 23;
+		float magic, sum;
+		std::memcpy(&magic, &magicBits, sizeof(magic));
+		std::memcpy(&sum, &f, sizeof(sum));
+		sum += magic;
+		std::memcpy(&h, &sum, sizeof(h));
+		h -= magicBits;
+	}
+	else {
+		uint32_t mantissaOdd = (f >> 13) & 1;
+		f += ((uint32_t)(15 - 127) << 23) + 0xfff + mantissaOdd;
+		h = f >> 13;
+	}
+	return (uint16_t)(h | (sign >> 16));
+}
+
+// converts count floats to halves, eight at a time with F16C or four at a time with SSE2
+inline void floatToHalf(const float* src, uint16_t* dst, size_t count) {
+	size_t i = 0;
+#if defined(HDR_IMAGE_F16C)
+	for (; i + 8 <= count; i += 8) {
+		__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i*)(dst + i), halves);
+	}
+#elif defined(HDR_IMAGE_SSE2)
+	const __m128i signMask		= _mm_set1_epi32((int)0x80000000u);
+	const __m128i maxHalf		= _mm_set1_epi32((127 + 16) << 23);
+	const __m128i nanBit		= _mm_set1_epi32(0x200);
+	const __m128i infinity		= _mm_set1_epi32(0x7c00);
+	const __m128i minNormal		= _mm_set1_epi32((127 - 14) << 23);
+	const __m128i subnormMagic	= _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i normalBias	= _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i packed[2];
+		for (int half = 0; half < 2; half++) {
+			__m128 f = _mm_loadu_ps(src + i + half * 4);
+			__m128 sign = _mm_and_ps(_mm_castsi128_ps(signMask), f);
+			__m128 absf = _mm_xor_ps(f, sign);
+			__m128i bits = _mm_castps_si128(absf);
+
+			// infinities and NaNs
+			__m128i isRegular = _mm_cmpgt_epi32(maxHalf, bits);
+			__m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+			__m128i special = _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+
+			// subnormals
+			__m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+			__m128 subnormalSum = _mm_add_ps(absf, _mm_castsi128_ps(subnormMagic));
+			__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalSum), subnormMagic);
+
+			// normals, rounding to nearest even
+			__m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+			__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd), 13);
+
+			__m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+			__m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+			packed[half] = _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+		}
+		// lanes are sign extended halves, so signed saturation keeps their bits
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(packed[0], packed[1]));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+// packs a color into GL_UNSIGNED_INT_5_9_9_9_REV as described by EXT_texture_shared_exponent
+inline uint32_t packRGB9E5(float r, float g, float b) {
+	const int mantissaBits = 9, bias = 15, maxExponent = 31;
+	const float maxValue = (float)((1 << mantissaBits) - 1) / (1 << mantissaBits) * (float)(1 << (maxExponent - bias));
+
+	// negative values and NaNs become zero
+	float rc = r > 0.0f ? (r < maxValue ? r : maxValue) : 0.0f;
+	float gc = g > 0.0f ? (g < maxValue ? g : maxValue) : 0.0f;
+	float bc = b > 0.0f ? (b < maxValue ? b : maxValue) : 0.0f;
+	float maxc = rc > gc ? (rc > bc ? rc : bc) : (gc > bc ? gc : bc);
+
+	int exponent;
+	std::frexp(maxc, &exponent);	// maxc = m * 2^exponent with m in [0.5, 1)
+	int sharedExponent = (exponent - 1 > -bias - 1 ? exponent - 1 : -bias - 1) + 1 + bias;
+
+	float scale = std::ldexp(1.0f, sharedExponent - bias - mantissaBits);
+	int maxMantissa = (int)std::floor(maxc / scale + 0.5f);
+	if (maxMantissa == 1 << mantissaBits) {
+		sharedExponent++;
+		scale *= 2.0f;
+	}
+
+	uint32_t rm = (uint32_t)std::floor(rc / scale + 0.5f);
+	uint32_t gm = (uint32_t)std::floor(gc / scale + 0.5f);
+	uint32_t bm = (uint32_t)std::floor(bc / scale + 0.5f);
+	return rm | (gm << 9) | (bm << 18) | ((uint32_t)sharedExponent << 27);
+}
+
+inline void floatToRGB9E5(const float* rgba, uint32_t* dst, size_t pixelCount) {
+	for (size_t i = 0; i < pixelCount; i++) {
+		dst[i] = packRGB9E5(rgba[i * 4 + 0], rgba[i * 4 + 1], rgba[i * 4 + 2]);
+	}
+}
+
+// halves an image with a box filter. levels keep the floor sizes GL expects,
+// so on odd sizes the last column and row are folded into the edge texels,
+// whose footprint grows to 3 texels, instead of being dropped
+inline HdrImage downsampleHdrImage(const HdrImage& image) {
+	HdrImage half;
+	half.width = image.width > 1 ? image.width / 2 : 1;
+	half.height = image.height > 1 ? image.height / 2 : 1;
+	half.pixels.resize((size_t)half.width * half.height * 4);
+
+	for (int y = 0; y < half.height; y++) {
+		int y0 = y * 2, y1 = y + 1 == half.height ? image.height - 1 : y * 2 + 1;
+		for (int x = 0; x < half.width; x++) {
+			int x0 = x * 2, x1 = x + 1 == half.width ? image.width - 1 : x * 2 + 1;
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int sy = y0; sy <= y1; sy++) {
+				for (int sx = x0; sx <= x1; sx++) {
+					const float* texel = &image.pixels[((size_t)sy * image.width + sx) * 4];
+					for (int c = 0; c < 4; c++) {
+						sum[c] += texel[c];
+					}
+				}
+			}
+			float scale = 1.0f / ((y1 - y0 + 1) * (x1 - x0 + 1));
+			for (int c = 0; c < 4; c++) {
+				half.pixels[((size_t)y * half.width + x) * 4 + c] = sum[c] * scale;
+			}
+		}
+	}
+	return half;
+}
+
+inline GLenum hdrInternalFormat(HdrFormat format) {
+	switch (format) {
+	case HdrFormat::RGBA16F:	return GL_RGBA16F;
+	case HdrFormat::RGB9_E5:	return GL_RGB9_E5;
+	default:					return GL_RGBA32F;
+	}
+}
+
+// converts one image level to the texel layout of a format
+inline HdrLevel convertHdrLevel(const HdrImage& image, HdrFormat format) {
+	HdrLevel level{ image.width, image.height, {} };
+	size_t pixelCount = (size_t)image.width * image.height;
+
+	switch (format) {
+	case HdrFormat::RGBA16F:
+		level.data.resize(pixelCount * 4 * sizeof(uint16_t));
+		floatToHalf(image.pixels.data(), (uint16_t*)level.data.data(), pixelCount * 4);
+		break;
+	case HdrFormat::RGB9_E5:
+		level.data.resize(pixelCount * sizeof(uint32_t));
+		floatToRGB9E5(image.pixels.data(), (uint32_t*)level.data.data(), pixelCount);
+		break;
+	default:
+		level.data.resize(pixelCount * 4 * sizeof(float));
+		std::memcpy(level.data.data(), image.pixels.data(), level.data.size());
+		break;
+	}
+	return level;
+}
+
+// converts the image and its mip chain; mips are built on the CPU since
+// RGB9_E5 is not color renderable and so cannot use glGenerateMipmap
+inline std::vector<HdrLevel> convertHdrImage(const HdrImage& image, HdrFormat format, bool mipmaps = true) {
+	std::vector<HdrLevel> levels;
+	levels.push_back(convertHdrLevel(image, format));
+
+	HdrImage current = image;
+	while (mipmaps && (current.width > 1 || current.height > 1)) {
+		current = downsampleHdrImage(current);
+		levels.push_back(convertHdrLevel(current, format));
+	}
+	return levels;
+}
+
+// uploads already converted levels into the currently bound GL_TEXTURE_2D
+inline void uploadHdrLevels(const std::vector<HdrLevel>& levels, HdrFormat format) {
+	GLenum pixelFormat = format == HdrFormat::RGB9_E5 ? GL_RGB : GL_RGBA;
+	GLenum type = format == HdrFormat::RGBA16F ? GL_HALF_FLOAT
+		: format == HdrFormat::RGB9_E5 ? GL_UNSIGNED_INT_5_9_9_9_REV : GL_FLOAT;
+
+	for (size_t i = 0; i < levels.size(); i++) {
+		glTexImage2D(GL_TEXTURE_2D, (GLint)i, hdrInternalFormat(format), levels[i].width, levels[i].height, 0,
+			pixelFormat, type, levels[i].data.data());
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+}
+
+// creates a texture from a float image and returns its GL name; wrapping and
+// filtering are left to the sampler object bound alongside it
+inline unsigned int createHdrTexture(const HdrImage& image, HdrFormat format, bool mipmaps = true) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	uploadHdrLevels(convertHdrImage(image, format, mipmaps), format);
+	return texture;
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gl_extensions.h"
+#include "mesh_pool.h"
+#include "stream_buffer.h"
+
+// layout read by glMultiDrawElementsIndirect; firstIndex counts indices, not bytes
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;	// 0 skips the draw, so culled objects can keep their slot
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+struct IndirectDrawStats {
+	bool indirect = false;				// ARB_multi_draw_indirect instead of the 3.3 fallback
+	unsigned int commands = 0;			// commands submitted this frame
+	unsigned int drawCalls = 0;			// GL draw calls they took
+};
+
+// command drawing a mesh of a MeshPool; bind the mesh's page before submitting
+inline DrawElementsIndirectCommand indirectCommand(const MeshAllocation& mesh, GLuint instanceCount = 1, GLuint baseInstance = 0) {
+	return { (GLuint)mesh.indexCount, instanceCount, mesh.firstIndex, mesh.baseVertex, baseInstance };
+}
+
+// fills out[i] with makeCommand(i), splitting the range across threads; small
+// ranges stay on the calling thread since starting threads costs more than they save
+template <typename MakeCommand>
+void buildIndirectCommands(DrawElementsIndirectCommand* out, size_t count, MakeCommand makeCommand, unsigned int threads = 0) {
+	const size_t MIN_COMMANDS_PER_THREAD = 8192;
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = (unsigned int)std::min<size_t>(threads, std::max<size_t>(1, count / MIN_COMMANDS_PER_THREAD));
+
+	auto buildRange = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = makeCommand(i);
+		}
+	};
+	if (threads <= 1) {
+		buildRange(0, count);
+		return;
+	}
+
+	// the calling thread builds the last chunk itself
+	size_t chunk = (count + threads - 1) / threads;
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t + 1 < threads; t++) {
+		workers.emplace_back(buildRange, t * chunk, std::min(count, (t + 1) * chunk));
+	}
+	buildRange((threads - 1) * chunk, count);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+// per frame command list submitted with one glMultiDrawElementsIndirect call.
+// commands are written straight into a stream buffer bound to
+// GL_DRAW_INDIRECT_BUFFER. without ARB_multi_draw_indirect they stay on the CPU
+// and go through glMultiDrawElementsBaseVertex, with instanced commands drawn
+// one by one; baseInstance has no 3.3 equivalent and is ignored there
+class IndirectDrawBuffer {
+public:
+	IndirectDrawBuffer(size_t maxCommandsPerFrame, bool allowIndirect = true)
+		: maxCommands(maxCommandsPerFrame) {
+		stats.indirect = allowIndirect && glext.multiDrawIndirect;
+		if (stats.indirect) {
+			commandStream.reset(new StreamBuffer(GL_DRAW_INDIRECT_BUFFER, maxCommandsPerFrame * sizeof(DrawElementsIndirectCommand)));
+		}
+		else {
+			cpuCommands.resize(maxCommandsPerFrame);
+		}
+	}
+
+	~IndirectDrawBuffer() {
+		clear();
+	}
+
+	IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+	IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+
+	void beginFrame() {
+		if (commandStream) {
+			commandStream->beginFrame();
+		}
+		cpuUsed = 0;
+		stats.commands = 0;
+		stats.drawCalls = 0;
+	}
+
+	// space for the next count commands, to be filled before submit(); any
+	// thread may write it. returns null when the frame is out of space
+	DrawElementsIndirectCommand* reserve(size_t count) {
+		pending = count;
+		pendingOffset = 0;
+		if (commandStream) {
+			StreamAllocation space = commandStream->allocate(count * sizeof(DrawElementsIndirectCommand), sizeof(DrawElementsIndirectCommand));
+			if (!space.valid()) {
+				pending = 0;
+				return nullptr;
+			}
+			pendingOffset = space.offset;
+			return (DrawElementsIndirectCommand*)space.data;
+		}
+		if (cpuUsed + count > maxCommands) {
+			std::cout << "ERROR::INDIRECT_DRAW::OUT_OF_SPACE " << count << " commands requested, "
+				<< maxCommands - cpuUsed << " left this frame" << std::endl;
+			pending = 0;
+			return nullptr;
+		}
+		DrawElementsIndirectCommand* commands = &cpuCommands[cpuUsed];
+		pendingOffset = cpuUsed;
+		cpuUsed += count;
+		return commands;
+	}
+
+	// reserves and fills count commands with makeCommand(i) across threads
+	template <typename MakeCommand>
+	bool build(size_t count, MakeCommand makeCommand, unsigned int threads = 0) {
+		DrawElementsIndirectCommand* commands = reserve(count);
+		if (!commands) {
+			return false;
+		}
+		buildIndirectCommands(commands, count, makeCommand, threads);
+		return true;
+	}
+
+	// draws the commands of the last reserve() with the bound VAO and program
+	void submit(GLenum indexType = GL_UNSIGNED_INT, GLenum mode = GL_TRIANGLES) {
+		if (pending == 0) {
+			return;
+		}
+		stats.commands += (unsigned int)pending;
+
+		if (commandStream) {
+			commandStream->flush();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream->buffer());
+			glext.MultiDrawElementsIndirect(mode, indexType, (const void*)pendingOffset, (GLsizei)pending, 0);
+			stats.drawCalls++;
+			pending = 0;
+			return;
+		}
+
+		size_t indexSize = indexType == GL_UNSIGNED_BYTE ? 1 : indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+		counts.clear();
+		offsets.clear();
+		baseVertices.clear();
+		for (size_t i = pendingOffset; i < pendingOffset + pending; i++) {
+			const DrawElementsIndirectCommand& command = cpuCommands[i];
+			const void* offset = (const void*)(command.firstIndex * indexSize);
+			if (command.instanceCount == 1) {
+				counts.push_back((GLsizei)command.count);
+				offsets.push_back(offset);
+				baseVertices.push_back(command.baseVertex);
+			}
+			else if (command.instanceCount > 1) {
+				glDrawElementsInstancedBaseVertex(mode, (GLsizei)command.count, indexType, offset,
+					(GLsizei)command.instanceCount, command.baseVertex);
+				stats.drawCalls++;
+			}
+		}
+		if (!counts.empty()) {
+			glMultiDrawElementsBaseVertex(mode, counts.data(), indexType, offsets.data(), (GLsizei)counts.size(), baseVertices.data());
+			stats.drawCalls++;
+		}
+		pending = 0;
+	}
+
+	// fences this frame's commands; call after the last submit
+	void endFrame() {
+		if (commandStream) {
+			commandStream->endFrame();
+		}
+	}
+
+	bool isIndirect() const {
+		return stats.indirect;
+	}
+
+	IndirectDrawStats getStats() const {
+		return stats;
+	}
+
+	// deletes the command stream; must be called while the GL context is still alive
+	void clear() {
+		if (commandStream) {
+			commandStream->clear();
+		}
+	}
+
+private:
+	size_t maxCommands;
+	std::unique_ptr<StreamBuffer> commandStream;
+	std::vector<DrawElementsIndirectCommand> cpuCommands;	// fallback only
+	size_t cpuUsed = 0;
+	size_t pending = 0;				// commands of the last reserve
+	size_t pendingOffset = 0;		// their byte offset in the stream, or index in cpuCommands
+	std::vector<GLsizei> counts;
+	std::vector<const void*> offsets;
+	std::vector<GLint> baseVertices;
+	IndirectDrawStats stats;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "batcher.h"
+#include "stream_buffer.h"
+
+// instance attributes sit at fixed locations above the vertex attributes, so
+// every program drawing instances declares
+//     layout (location = 8) in mat4 aInstanceModel;
+//     layout (location = 12) in vec4 aInstanceColor;
+const GLuint INSTANCE_MODEL_LOCATION = 8;		// a mat4 takes locations 8 to 11
+const GLuint INSTANCE_COLOR_LOCATION = 12;
+
+// per instance stream, read once per instance through glVertexAttribDivisor
+struct InstanceData {
+	float transform[16];	// column major model matrix
+	float color[4];
+};
+
+struct InstanceStats {
+	unsigned int instances = 0;		// instances submitted this frame
+	unsigned int groups = 0;		// distinct mesh and material pairs
+	unsigned int drawCalls = 0;
+	unsigned int stateChanges = 0;
+};
+
+// draws every submitted copy of a mesh with the same material in one
+// glDrawElementsInstanced call. instance data is written to a stream buffer
+// each frame, grouped by material and mesh
+template <typename Layout>
+class InstancedRenderer {
+public:
+	InstancedRenderer(size_t maxInstancesPerFrame = 1 << 17, unsigned int program = 0)
+		: program(program), maxInstances(maxInstancesPerFrame) {
+		instanceStream.reset(new StreamBuffer(GL_ARRAY_BUFFER, maxInstancesPerFrame * sizeof(InstanceData)));
+	}
+
+	~InstancedRenderer() {
+		clear();
+	}
+
+	InstancedRenderer(const InstancedRenderer&) = delete;
+	InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+	// uploads a mesh and returns its id for submit()
+	int addMesh(const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount) {
+		Mesh mesh;
+		mesh.indexCount = (GLsizei)indexCount;
+		glGenVertexArrays(1, &mesh.VAO);
+		glGenBuffers(1, &mesh.VBO);
+		glGenBuffers(1, &mesh.EBO);
+
+		glBindVertexArray(mesh.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * Layout::stride, vertices, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+		Layout::setup(mesh.VBO, program);
+
+		// instance attributes advance once per instance
+		for (GLuint column = 0; column < 4; column++) {
+			glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+			glVertexAttribDivisor(INSTANCE_MODEL_LOCATION + column, 1);
+		}
+		glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+		glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+		glBindVertexArray(0);
+
+		meshes.push_back(mesh);
+		return (int)meshes.size() - 1;
+	}
+
+	void beginFrame() {
+		submissions.clear();
+		instanceStream->beginFrame();
+	}
+
+	void submit(int mesh, const BatchKey& material, const InstanceData& instance) {
+		submissions.push_back({ material, mesh, instance });
+	}
+
+	// writes the instance streams and draws each group, calling apply whenever
+	// the material changes
+	void render(const std::function<void(const BatchKey&)>& apply = applyBatchKey) {
+		std::stable_sort(submissions.begin(), submissions.end(), [](const Submission& a, const Submission& b) {
+			return a.material < b.material || (a.material == b.material && a.mesh < b.mesh);
+		});
+		stats = InstanceStats();
+		stats.instances = (unsigned int)submissions.size();
+		if (submissions.size() > maxInstances) {
+			std::cout << "ERROR::INSTANCED_RENDERER::TOO_MANY_INSTANCES " << submissions.size()
+				<< " submitted, " << maxInstances << " fit" << std::endl;
+			submissions.resize(maxInstances);
+		}
+		if (submissions.empty()) {
+			return;
+		}
+
+		// one allocation for the frame, groups are consecutive inside it
+		StreamAllocation space = instanceStream->allocate(submissions.size() * sizeof(InstanceData), sizeof(InstanceData));
+		if (!space.valid()) {
+			return;
+		}
+		InstanceData* out = (InstanceData*)space.data;
+		for (const Submission& submission : submissions) {
+			*out++ = submission.instance;
+		}
+		instanceStream->flush();
+
+		const BatchKey* current = nullptr;
+		for (size_t begin = 0; begin < submissions.size();) {
+			size_t end = begin + 1;
+			while (end < submissions.size() && submissions[end].mesh == submissions[begin].mesh
+				&& submissions[end].material == submissions[begin].material) {
+				end++;
+			}
+			stats.groups++;
+
+			if (!current || !(*current == submissions[begin].material)) {
+				apply(submissions[begin].material);
+				current = &submissions[begin].material;
+				stats.stateChanges++;
+			}
+
+			// no base instance in GL 3.3, so the instance attributes are pointed
+			// at the group's slice of the stream
+			const Mesh& mesh = meshes[submissions[begin].mesh];
+			glBindVertexArray(mesh.VAO);
+			pointInstances(space.offset + begin * sizeof(InstanceData));
+			glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, (GLsizei)(end - begin));
+			stats.drawCalls++;
+			begin = end;
+		}
+	}
+
+	// fences this frame's instance data; call after render
+	void endFrame() {
+		instanceStream->endFrame();
+	}
+
+	InstanceStats getStats() const {
+		return stats;
+	}
+
+	// deletes every mesh and the stream; must be called while the GL context is still alive
+	void clear() {
+		for (Mesh& mesh : meshes) {
+			glDeleteVertexArrays(1, &mesh.VAO);
+			glDeleteBuffers(1, &mesh.VBO);
+			glDeleteBuffers(1, &mesh.EBO);
+		}
+		meshes.clear();
+		if (instanceStream) {
+			instanceStream->clear();
+		}
+	}
+
+private:
+	struct Mesh {
+		unsigned int VAO = 0, VBO = 0, EBO = 0;
+		GLsizei indexCount = 0;
+	};
+
+	struct Submission {
+		BatchKey material;
+		int mesh;
+		InstanceData instance;
+	};
+
+	unsigned int program;
+	size_t maxInstances;
+	std::unique_ptr<StreamBuffer> instanceStream;
+	std::vector<Mesh> meshes;
+	std::vector<Submission> submissions;
+	InstanceStats stats;
+
+	void pointInstances(size_t offset) {
+		glBindBuffer(GL_ARRAY_BUFFER, instanceStream->buffer());
+		for (GLuint column = 0; column < 4; column++) {
+			glVertexAttribPointer(INSTANCE_MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+				(void*)(offset + offsetof(InstanceData, transform) + column * 4 * sizeof(float)));
+		}
+		glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			(void*)(offset + offsetof(InstanceData, color)));
+	}
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// read only view of a whole file, mapped instead of read so large files are
+// paged in by the OS as they are touched and never copied into the heap
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string& path) {
+		open(path);
+	}
+
+	~MappedFile() {
+		close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		if (this != &other) {
+			close();
+			bytes = other.bytes;
+			length = other.length;
+			opened = other.opened;
+#ifdef _WIN32
+			file = other.file;
+			mapping = other.mapping;
+			other.file = INVALID_HANDLE_VALUE;
+			other.mapping = nullptr;
+#endif
+			other.bytes = nullptr;
+			other.length = 0;
+			other.opened = false;
+		}
+		return *this;
+	}
+
+	// maps path, replacing any file mapped before; empty files map to nothing but still open
+	bool open(const std::string& path) {
+		close();
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			std::cout << "Failed to open: " << path << std::endl;
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		length = (size_t)fileSize.QuadPart;
+		if (length > 0) {
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			bytes = mapping ? (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		}
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			std::cout << "Failed to open: " << path << std::endl;
+			return false;
+		}
+		struct stat info;
+		fstat(fd, &info);
+		length = (size_t)info.st_size;
+		if (length > 0) {
+			void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			bytes = view != MAP_FAILED ? (const unsigned char*)view : nullptr;
+			if (bytes) {
+				// parsers read front to back
+				madvise(view, length, MADV_SEQUENTIAL);
+			}
+		}
+		::close(fd);
+#endif
+		if (length > 0 && !bytes) {
+			std::cout << "Failed to map: " << path << std::endl;
+			close();
+			return false;
+		}
+		opened = true;
+		return true;
+	}
+
+	void close() {
+#ifdef _WIN32
+		if (bytes) {
+			UnmapViewOfFile(bytes);
+		}
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		if (file != INVALID_HANDLE_VALUE) {
+			CloseHandle(file);
+		}
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (bytes) {
+			munmap((void*)bytes, length);
+		}
+#endif
+		bytes = nullptr;
+		length = 0;
+		opened = false;
+	}
+
+	bool isOpen() const {
+		return opened;
+	}
+
+	const unsigned char* data() const {
+		return bytes;
+	}
+
+	const char* begin() const {
+		return (const char*)bytes;
+	}
+
+	const char* end() const {
+		return (const char*)bytes + length;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+private:
+	const unsigned char* bytes = nullptr;
+	size_t length = 0;
+	bool opened = false;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+};
+
+#endif
@@ -0,0 +1,422 @@
+#ifndef MASKED_OCCLUSION_H
+#define MASKED_OCCLUSION_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frustum_culling.h"
+
+#if defined(__AVX2__)
+#define MASKED_OCCLUSION_AVX2
+#include <immintrin.h>
+#endif
+
+struct MaskedDepthStats {
+	unsigned int triangles = 0;			// rasterized into at least one tile
+	unsigned int trianglesCulled = 0;	// back facing, degenerate, off screen or behind the near clip
+	unsigned int tileUpdates = 0;
+	unsigned int occludees = 0;
+	unsigned int occludeesCulled = 0;
+};
+
+// low resolution software depth buffer for occlusion culling on the CPU,
+// after masked occlusion culling (Hasselgren, Andersson, Akenine-Moller 2016).
+// the screen is split into 32 x 8 pixel tiles and, instead of a depth per
+// pixel, each tile keeps
+//   tileDepth, a depth everything in the tile is at least as near as
+//   layerDepth with a coverage mask, a depth the covered pixels are at least as near as
+// an occluder triangle merges its coverage and its farthest depth over the
+// tile into the layer; once the layer covers the whole tile it becomes the new
+// tileDepth. occludee boxes are then tested against tileDepth alone, which
+// makes the tiles a one level hierarchy over the masks.
+// depth is 1 / w, so it interpolates linearly across the screen, 0 is
+// infinitely far and larger is nearer. a frame goes
+//     buffer.beginFrame(viewProjection);
+//     buffer.renderOccluder(...) for the big, close meshes
+//     buffer.testBox(...) or cullOccluded(...) before drawing anything else
+class MaskedDepthBuffer {
+public:
+	static const int TILE_WIDTH = 32;
+	static const int TILE_HEIGHT = 8;
+
+	// width and height are rounded up to whole tiles
+	MaskedDepthBuffer(int width = 320, int height = 192) {
+		resize(width, height);
+	}
+
+	void resize(int width, int height) {
+		tilesX = std::max(1, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+		tilesY = std::max(1, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+		size_t tiles = (size_t)tilesX * tilesY;
+		tileDepth.assign(tiles, 0.0f);
+		layerDepth.assign(tiles, FLT_MAX);
+		masks.assign(tiles * TILE_HEIGHT, 0u);
+	}
+
+	int getWidth() const {
+		return tilesX * TILE_WIDTH;
+	}
+
+	int getHeight() const {
+		return tilesY * TILE_HEIGHT;
+	}
+
+	// empties the buffer and sets the column major view projection that
+	// occluders and occludees are transformed with
+	void beginFrame(const float* viewProjection) {
+		std::copy(viewProjection, viewProjection + 16, matrix);
+		std::fill(tileDepth.begin(), tileDepth.end(), 0.0f);
+		std::fill(layerDepth.begin(), layerDepth.end(), FLT_MAX);
+		std::fill(masks.begin(), masks.end(), 0u);
+		stats = MaskedDepthStats();
+	}
+
+	// rasterizes an indexed triangle list of world space positions, stride
+	// bytes apart. counter clockwise triangles face the camera; the others
+	// are skipped unless backfaceCull is off
+	void renderOccluder(const float* positions, size_t stride, const unsigned int* indices, size_t indexCount,
+		bool backfaceCull = true) {
+		for (size_t i = 0; i + 2 < indexCount; i += 3) {
+			float clip[3][4];
+			for (int v = 0; v < 3; v++) {
+				const float* p = (const float*)((const char*)positions + indices[i + v] * stride);
+				transform(p, clip[v]);
+			}
+			renderClipTriangle(clip, backfaceCull);
+		}
+	}
+
+	// false when the world space box is hidden behind the occluders rendered
+	// so far, or entirely off screen. boxes crossing the near clip are visible
+	bool testBox(const float* boxMin, const float* boxMax) {
+		stats.occludees++;
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = 0.0f;
+		for (int corner = 0; corner < 8; corner++) {
+			float p[3] = { corner & 1 ? boxMax[0] : boxMin[0], corner & 2 ? boxMax[1] : boxMin[1], corner & 4 ? boxMax[2] : boxMin[2] };
+			float clip[4];
+			transform(p, clip);
+			if (clip[3] <= MIN_W) {
+				return true;
+			}
+			float inverseW = 1.0f / clip[3];
+			float x = (clip[0] * inverseW * 0.5f + 0.5f) * getWidth();
+			float y = (clip[1] * inverseW * 0.5f + 0.5f) * getHeight();
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			// w is linear over the box, so the nearest point is a corner
+			nearest = std::max(nearest, inverseW);
+		}
+		if (maxX < 0.0f || maxY < 0.0f || minX >= getWidth() || minY >= getHeight()) {
+			stats.occludeesCulled++;
+			return false;
+		}
+		// clamped while still float: far off screen the int conversion overflows
+		minX = std::max(minX, 0.0f);
+		minY = std::max(minY, 0.0f);
+		maxX = std::min(maxX, (float)getWidth());
+		maxY = std::min(maxY, (float)getHeight());
+		int tileMinX = (int)minX / TILE_WIDTH, tileMaxX = std::min(tilesX - 1, (int)maxX / TILE_WIDTH);
+		int tileMinY = (int)minY / TILE_HEIGHT, tileMaxY = std::min(tilesY - 1, (int)maxY / TILE_HEIGHT);
+		for (int ty = tileMinY; ty <= tileMaxY; ty++) {
+			const float* row = &tileDepth[(size_t)ty * tilesX];
+			for (int tx = tileMinX; tx <= tileMaxX; tx++) {
+				if (nearest >= row[tx]) {
+					return true;
+				}
+			}
+		}
+		stats.occludeesCulled++;
+		return false;
+	}
+
+	// keeps the first count indices of visible whose volumes in bounds are
+	// not hidden, in order, and returns how many are left; made to run on
+	// the output of cullFrustum. spheres are tested by their bounding box
+	size_t cullOccluded(const CullingBounds& bounds, std::vector<unsigned int>& visible, size_t count) {
+		size_t kept = 0;
+		for (size_t i = 0; i < count; i++) {
+			unsigned int object = visible[i];
+			float extent[3] = { bounds.r[object], bounds.r[object], bounds.r[object] };
+			if (bounds.hasBoxes()) {
+				extent[0] += bounds.ex[object];
+				extent[1] += bounds.ey[object];
+				extent[2] += bounds.ez[object];
+			}
+			float boxMin[3] = { bounds.x[object] - extent[0], bounds.y[object] - extent[1], bounds.z[object] - extent[2] };
+			float boxMax[3] = { bounds.x[object] + extent[0], bounds.y[object] + extent[1], bounds.z[object] + extent[2] };
+			if (testBox(boxMin, boxMax)) {
+				visible[kept++] = object;
+			}
+		}
+		return kept;
+	}
+
+	// per pixel depth the buffer guarantees, row by row from the bottom, for
+	// debugging and visualizing the occluders
+	void resolveDepth(std::vector<float>& out) const {
+		out.resize((size_t)getWidth() * getHeight());
+		for (int ty = 0; ty < tilesY; ty++) {
+			for (int tx = 0; tx < tilesX; tx++) {
+				size_t tile = (size_t)ty * tilesX + tx;
+				for (int r = 0; r < TILE_HEIGHT; r++) {
+					uint32_t mask = masks[tile * TILE_HEIGHT + r];
+					float* pixels = &out[(size_t)(ty * TILE_HEIGHT + r) * getWidth() + tx * TILE_WIDTH];
+					for (int k = 0; k < TILE_WIDTH; k++) {
+						pixels[k] = mask >> k & 1 ? std::max(tileDepth[tile], layerDepth[tile]) : tileDepth[tile];
+					}
+				}
+			}
+		}
+	}
+
+	MaskedDepthStats getStats() const {
+		return stats;
+	}
+
+private:
+	// geometry closer to the camera than this w is clipped away
+	static constexpr float MIN_W = 1e-3f;
+
+	void transform(const float* p, float* clip) const {
+		for (int c = 0; c < 4; c++) {
+			clip[c] = matrix[c] * p[0] + matrix[4 + c] * p[1] + matrix[8 + c] * p[2] + matrix[12 + c];
+		}
+	}
+
+	// clips against w = MIN_W, which leaves up to a quad, and rasterizes the pieces
+	void renderClipTriangle(const float (*clip)[4], bool backfaceCull) {
+		float polygon[4][4];
+		int count = 0;
+		for (int v = 0; v < 3; v++) {
+			const float* a = clip[v];
+			const float* b = clip[(v + 1) % 3];
+			bool insideA = a[3] > MIN_W, insideB = b[3] > MIN_W;
+			if (insideA) {
+				std::copy(a, a + 4, polygon[count++]);
+			}
+			if (insideA != insideB) {
+				float t = (MIN_W - a[3]) / (b[3] - a[3]);
+				for (int c = 0; c < 4; c++) {
+					polygon[count][c] = a[c] + (b[c] - a[c]) * t;
+				}
+				count++;
+			}
+		}
+		if (count < 3) {
+			stats.trianglesCulled++;
+			return;
+		}
+
+		float screen[4][3];
+		for (int v = 0; v < count; v++) {
+			float inverseW = 1.0f / polygon[v][3];
+			screen[v][0] = (polygon[v][0] * inverseW * 0.5f + 0.5f) * getWidth();
+			screen[v][1] = (polygon[v][1] * inverseW * 0.5f + 0.5f) * getHeight();
+			screen[v][2] = inverseW;
+		}
+		rasterize(screen[0], screen[1], screen[2], backfaceCull);
+		if (count == 4) {
+			rasterize(screen[0], screen[2], screen[3], backfaceCull);
+		}
+	}
+
+	// edge i to i + 1 of a counter clockwise triangle, inside where
+	// a * x + b * y + c >= 0 with a = y0 - y1 and b = x1 - x0
+	struct Edge {
+		double x, y;		// start vertex, less the half pixel to the centers in x
+		double b;
+		double inverseA;	// kept finite for flat edges
+		bool rising;		// inside is right of where a row crosses the edge
+	};
+
+	// setup runs in double: clipped vertices close to the camera land far
+	// outside the screen, where float loses the pixels the tiles look at
+	void rasterize(const float* v0, const float* v1, const float* v2, bool backfaceCull) {
+		double area = ((double)v1[0] - v0[0]) * ((double)v2[1] - v0[1]) - ((double)v2[0] - v0[0]) * ((double)v1[1] - v0[1]);
+		if (area < 0.0 && !backfaceCull) {
+			std::swap(v1, v2);
+			area = -area;
+		}
+		if (!(area > 0.0)) {
+			stats.trianglesCulled++;
+			return;
+		}
+
+		float minX = std::min(v0[0], std::min(v1[0], v2[0])), maxX = std::max(v0[0], std::max(v1[0], v2[0]));
+		float minY = std::min(v0[1], std::min(v1[1], v2[1])), maxY = std::max(v0[1], std::max(v1[1], v2[1]));
+		if (maxX < 0.0f || maxY < 0.0f || minX >= getWidth() || minY >= getHeight()) {
+			stats.trianglesCulled++;
+			return;
+		}
+		// clamped while still float: far off screen the int conversion overflows
+		minX = std::max(minX, 0.0f);
+		minY = std::max(minY, 0.0f);
+		maxX = std::min(maxX, (float)getWidth());
+		maxY = std::min(maxY, (float)getHeight());
+		int tileMinX = (int)minX / TILE_WIDTH, tileMaxX = std::min(tilesX - 1, (int)maxX / TILE_WIDTH);
+		int tileMinY = (int)minY / TILE_HEIGHT, tileMaxY = std::min(tilesY - 1, (int)maxY / TILE_HEIGHT);
+
+		// depth plane z = zdx * x + zdy * y + z0; inside the triangle it stays
+		// within the vertex depths
+		double dz1 = (double)v1[2] - v0[2], dz2 = (double)v2[2] - v0[2];
+		double zdx = (dz1 * ((double)v2[1] - v0[1]) - dz2 * ((double)v1[1] - v0[1])) / area;
+		double zdy = (dz2 * ((double)v1[0] - v0[0]) - dz1 * ((double)v2[0] - v0[0])) / area;
+		double z0 = v0[2] - zdx * v0[0] - zdy * v0[1];
+		float vertexFarthest = std::min(v0[2], std::min(v1[2], v2[2]));
+		float vertexNearest = std::max(v0[2], std::max(v1[2], v2[2]));
+
+		Edge edges[3];
+		const float* vertices[3] = { v0, v1, v2 };
+		for (int e = 0; e < 3; e++) {
+			const float* start = vertices[e];
+			const float* end = vertices[(e + 1) % 3];
+			double a = (double)start[1] - end[1];
+			if (std::fabs(a) < 1e-30) {
+				a = a < 0.0 ? -1e-30 : 1e-30;
+			}
+			edges[e].x = start[0] - 0.5;
+			edges[e].y = start[1];
+			edges[e].b = (double)end[0] - start[0];
+			edges[e].inverseA = 1.0 / a;
+			edges[e].rising = a > 0.0;
+		}
+
+		bool drawn = false;
+		for (int ty = tileMinY; ty <= tileMaxY; ty++) {
+			float tileY = (float)(ty * TILE_HEIGHT);
+			// where each row of the band crosses each edge, clamped well past
+			// the screen so it converts to int
+			float crossings[3][TILE_HEIGHT];
+			for (int e = 0; e < 3; e++) {
+				for (int r = 0; r < TILE_HEIGHT; r++) {
+					double x = edges[e].x - edges[e].b * (tileY + r + 0.5 - edges[e].y) * edges[e].inverseA;
+					crossings[e][r] = (float)std::min(std::max(x, -2.0 * TILE_WIDTH), getWidth() + 2.0 * TILE_WIDTH);
+				}
+			}
+			for (int tx = tileMinX; tx <= tileMaxX; tx++) {
+				float tileX = (float)(tx * TILE_WIDTH);
+				size_t tile = (size_t)ty * tilesX + tx;
+
+				// farthest and nearest of the plane over the tile, bounded by the vertices
+				float cornerFarthest = (float)(z0 + zdx * (zdx > 0.0 ? tileX : tileX + TILE_WIDTH)
+					+ zdy * (zdy > 0.0 ? tileY : tileY + TILE_HEIGHT));
+				float cornerNearest = (float)(z0 + zdx * (zdx > 0.0 ? tileX + TILE_WIDTH : tileX)
+					+ zdy * (zdy > 0.0 ? tileY + TILE_HEIGHT : tileY));
+				float triangleDepth = std::max(cornerFarthest, vertexFarthest);
+				if (std::min(cornerNearest, vertexNearest) < tileDepth[tile]) {
+					continue;		// entirely behind what the tile already holds
+				}
+
+#if defined(MASKED_OCCLUSION_AVX2)
+				const __m256 low = _mm256_set1_ps(-1.0f), high = _mm256_set1_ps(TILE_WIDTH + 1.0f);
+				const __m256i zero = _mm256_setzero_si256(), width = _mm256_set1_epi32(TILE_WIDTH);
+				const __m256i ones = _mm256_set1_epi32(-1);
+				__m256 origin = _mm256_set1_ps(tileX);
+				__m256i coverage = ones;
+				for (int e = 0; e < 3; e++) {
+					__m256 relative = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(crossings[e]), origin), low), high);
+					if (edges[e].rising) {
+						// pixels from the first center right of the crossing
+						__m256i first = _mm256_cvtps_epi32(_mm256_ceil_ps(relative));
+						first = _mm256_min_epi32(_mm256_max_epi32(first, zero), width);
+						coverage = _mm256_and_si256(coverage, _mm256_sllv_epi32(ones, first));
+					}
+					else {
+						// pixels up to the last center left of the crossing
+						__m256i count = _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_floor_ps(relative)), _mm256_set1_epi32(1));
+						count = _mm256_min_epi32(_mm256_max_epi32(count, zero), width);
+						coverage = _mm256_andnot_si256(_mm256_sllv_epi32(ones, count), coverage);
+					}
+				}
+				if (_mm256_testz_si256(coverage, coverage)) {
+					continue;
+				}
+				drawn = true;
+				stats.tileUpdates++;
+
+				__m256i* tileMask = (__m256i*)&masks[tile * TILE_HEIGHT];
+				__m256i mask = _mm256_loadu_si256(tileMask);
+				if (mergeLayer(tile, triangleDepth)) {
+					mask = zero;
+				}
+				mask = _mm256_or_si256(mask, coverage);
+				if (_mm256_testc_si256(mask, ones)) {
+					flushLayer(tile);
+					mask = zero;
+				}
+				_mm256_storeu_si256(tileMask, mask);
+#else
+				uint32_t coverage[TILE_HEIGHT];
+				uint32_t any = 0;
+				for (int r = 0; r < TILE_HEIGHT; r++) {
+					uint32_t row = ~0u;
+					for (int e = 0; e < 3; e++) {
+						float relative = std::min(std::max(crossings[e][r] - tileX, -1.0f), TILE_WIDTH + 1.0f);
+						if (edges[e].rising) {
+							int first = std::min(std::max((int)std::ceil(relative), 0), TILE_WIDTH);
+							row &= first >= TILE_WIDTH ? 0u : ~0u << first;
+						}
+						else {
+							int count = std::min(std::max((int)std::floor(relative) + 1, 0), TILE_WIDTH);
+							row &= count >= TILE_WIDTH ? ~0u : (1u << count) - 1u;
+						}
+					}
+					coverage[r] = row;
+					any |= row;
+				}
+				if (!any) {
+					continue;
+				}
+				drawn = true;
+				stats.tileUpdates++;
+
+				uint32_t* mask = &masks[tile * TILE_HEIGHT];
+				bool discard = mergeLayer(tile, triangleDepth);
+				uint32_t full = ~0u;
+				for (int r = 0; r < TILE_HEIGHT; r++) {
+					mask[r] = (discard ? 0u : mask[r]) | coverage[r];
+					full &= mask[r];
+				}
+				if (full == ~0u) {
+					flushLayer(tile);
+					std::fill(mask, mask + TILE_HEIGHT, 0u);
+				}
+#endif
+			}
+		}
+		(drawn ? stats.triangles : stats.trianglesCulled)++;
+	}
+
+	// folds a triangle's farthest depth in the tile into the layer. when the
+	// triangle is much nearer than the layer, and the layer no nearer than
+	// the tile, the layer is dropped and restarted with the triangle, which
+	// returns true so the caller clears the mask
+	bool mergeLayer(size_t tile, float triangleDepth) {
+		bool discard = triangleDepth - layerDepth[tile] > layerDepth[tile] - tileDepth[tile];
+		if (discard) {
+			layerDepth[tile] = FLT_MAX;
+		}
+		layerDepth[tile] = std::min(layerDepth[tile], triangleDepth);
+		return discard;
+	}
+
+	// the layer covers the whole tile and becomes its depth
+	void flushLayer(size_t tile) {
+		tileDepth[tile] = std::max(tileDepth[tile], layerDepth[tile]);
+		layerDepth[tile] = FLT_MAX;
+	}
+
+	int tilesX = 0, tilesY = 0;
+	std::vector<float> tileDepth;
+	std::vector<float> layerDepth;
+	std::vector<uint32_t> masks;	// TILE_HEIGHT rows of 32 pixels per tile, bit k is pixel k from the left
+	float matrix[16] = {};
+	MaskedDepthStats stats;
+};
+
+#endif
@@ -0,0 +1,388 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "vertex_layout.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplify.h"
+#include "mesh_codec.h"
+
+// binary mesh file laid out so a mapped copy can be handed to glBufferData
+// as is: a header, the vertex layout it was written with, a LOD table, then
+// the vertex and index blobs, each starting on a MESH_CACHE_ALIGNMENT boundary.
+// the blobs are either raw or encoded with mesh_codec.h. all values are little endian
+const uint32_t MESH_CACHE_VERSION = 2;
+const size_t MESH_CACHE_ALIGNMENT = 64;
+
+enum MeshCacheCompression : uint32_t {
+	MESH_CACHE_RAW = 0,
+	MESH_CACHE_ENCODED = 1		// encodeVertexBuffer and encodeIndexBuffer
+};
+
+struct MeshCacheHeader {
+	char magic[4];				// "LMSH"
+	uint32_t version;
+	uint32_t vertexStride;
+	uint32_t attributeCount;
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	uint32_t indexType;			// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	uint32_t lodCount;
+	uint32_t compression;		// MeshCacheCompression
+	uint32_t reserved;
+	uint64_t attributeOffset;	// byte offsets from the start of the file
+	uint64_t lodOffset;
+	uint64_t vertexOffset;
+	uint64_t vertexBytes;		// sizes of the blobs as stored
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+	float boundsMin[3];
+	float boundsMax[3];
+	float center[3];			// bounding sphere
+	float radius;
+};
+static_assert(sizeof(MeshCacheHeader) == 136, "MeshCacheHeader must not contain padding");
+
+// one attribute of the layout the vertices were written with
+struct MeshCacheAttribute {
+	char name[24];
+	uint32_t glType;
+	uint32_t components;
+	uint32_t normalized;
+	uint32_t integer;
+	uint32_t offset;
+	uint32_t reserved;
+};
+static_assert(sizeof(MeshCacheAttribute) == 48, "MeshCacheAttribute must not contain padding");
+
+struct MeshCacheLod {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float error;
+	uint32_t reserved;
+};
+
+// descriptor of every attribute of a VertexLayout
+template <typename Layout> struct MeshCacheLayout;
+
+template <typename... Attrs>
+struct MeshCacheLayout<VertexLayout<Attrs...>> {
+	static std::vector<MeshCacheAttribute> describe() {
+		std::vector<MeshCacheAttribute> attributes;
+		size_t index = 0;
+		(attributes.push_back(describe<Attrs>(VertexLayout<Attrs...>::offsets[index++])), ...);
+		return attributes;
+	}
+
+private:
+	template <typename Attr>
+	static MeshCacheAttribute describe(size_t offset) {
+		MeshCacheAttribute attribute = {};
+		std::strncpy(attribute.name, Attr::name, sizeof(attribute.name) - 1);
+		attribute.glType = Attr::glType;
+		attribute.components = Attr::components;
+		attribute.normalized = Attr::normalized;
+		attribute.integer = Attr::integer;
+		attribute.offset = (uint32_t)offset;
+		return attribute;
+	}
+};
+
+// writes vertices in Layout and their indices to path. lods index ranges of
+// indices, coarsest last; without them the whole index list is the only LOD.
+// indices are stored as 16 bit whenever the vertex count allows. encoded files
+// are smaller on disk, about 1.4 to 1.5 times for vertices and 4 times for
+// indices against 32 bit ones, and decoded while uploading
+template <typename Layout>
+bool writeMeshCache(const std::string& path, const void* vertices, size_t vertexCount,
+	const std::vector<unsigned int>& indices, const std::vector<MeshLod>& lods = std::vector<MeshLod>(),
+	bool encode = false) {
+	std::vector<MeshCacheAttribute> attributes = MeshCacheLayout<Layout>::describe();
+	std::vector<MeshCacheLod> lodTable;
+	for (const MeshLod& lod : lods) {
+		lodTable.push_back({ lod.firstIndex, lod.indexCount, lod.error, 0 });
+	}
+	if (lodTable.empty()) {
+		lodTable.push_back({ 0, (uint32_t)indices.size(), 0.0f, 0 });
+	}
+	PackedIndices packed = packIndices(indices.data(), indices.size(), vertexCount);
+	std::vector<unsigned char> encodedVertices, encodedIndices;
+	if (encode) {
+		encodedVertices = encodeVertexBuffer(vertices, vertexCount, Layout::stride);
+		encodedIndices = encodeIndexBuffer(indices.data(), indices.size());
+	}
+	const void* vertexBlob = encode ? encodedVertices.data() : vertices;
+	const void* indexBlob = encode ? encodedIndices.data() : packed.data.data();
+
+	auto align = [](uint64_t offset) {
+		return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+	};
+	MeshCacheHeader header = {};
+	std::memcpy(header.magic, "LMSH", 4);
+	header.version = MESH_CACHE_VERSION;
+	header.vertexStride = (uint32_t)Layout::stride;
+	header.attributeCount = (uint32_t)attributes.size();
+	header.vertexCount = vertexCount;
+	header.indexCount = indices.size();
+	header.indexType = packed.type;
+	header.lodCount = (uint32_t)lodTable.size();
+	header.compression = encode ? MESH_CACHE_ENCODED : MESH_CACHE_RAW;
+	header.attributeOffset = sizeof(MeshCacheHeader);
+	header.lodOffset = header.attributeOffset + attributes.size() * sizeof(MeshCacheAttribute);
+	header.vertexOffset = align(header.lodOffset + lodTable.size() * sizeof(MeshCacheLod));
+	header.vertexBytes = encode ? encodedVertices.size() : (uint64_t)vertexCount * Layout::stride;
+	header.indexOffset = align(header.vertexOffset + header.vertexBytes);
+	header.indexBytes = encode ? encodedIndices.size() : packed.data.size();
+
+	// bounds from the positions, when the layout has them
+	for (int c = 0; c < 3; c++) {
+		header.boundsMin[c] = vertexCount ? FLT_MAX : 0.0f;
+		header.boundsMax[c] = vertexCount ? -FLT_MAX : 0.0f;
+	}
+	constexpr int position = Layout::template indexOf<Position3f>();
+	if constexpr (position >= 0) {
+		const unsigned char* bytes = (const unsigned char*)vertices;
+		auto read = [&](size_t v, float* out) {
+			std::memcpy(out, bytes + v * Layout::stride + Layout::offsets[position], 3 * sizeof(float));
+		};
+		for (size_t v = 0; v < vertexCount; v++) {
+			float p[3];
+			read(v, p);
+			for (int c = 0; c < 3; c++) {
+				header.boundsMin[c] = std::min(header.boundsMin[c], p[c]);
+				header.boundsMax[c] = std::max(header.boundsMax[c], p[c]);
+			}
+		}
+		for (int c = 0; c < 3; c++) {
+			header.center[c] = (header.boundsMin[c] + header.boundsMax[c]) * 0.5f;
+		}
+		for (size_t v = 0; v < vertexCount; v++) {
+			float p[3];
+			read(v, p);
+			float dx = p[0] - header.center[0], dy = p[1] - header.center[1], dz = p[2] - header.center[2];
+			header.radius = std::max(header.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+		}
+	}
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out) {
+		std::cout << "ERROR::MESH_CACHE::FILE_NOT_WRITABLE " << path << std::endl;
+		return false;
+	}
+	const char zeros[MESH_CACHE_ALIGNMENT] = {};
+	auto padTo = [&](uint64_t offset) {
+		out.write(zeros, (std::streamsize)(offset - (uint64_t)out.tellp()));
+	};
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)attributes.data(), attributes.size() * sizeof(MeshCacheAttribute));
+	out.write((const char*)lodTable.data(), lodTable.size() * sizeof(MeshCacheLod));
+	padTo(header.vertexOffset);
+	out.write((const char*)vertexBlob, (std::streamsize)header.vertexBytes);
+	padTo(header.indexOffset);
+	out.write((const char*)indexBlob, (std::streamsize)header.indexBytes);
+	if (!out) {
+		std::cout << "ERROR::MESH_CACHE::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// read only, mapped view of a mesh cache file; the blobs point into the
+// mapping, so nothing is copied until GL copies them into its buffers
+class MeshCache {
+public:
+	MeshCache() = default;
+
+	explicit MeshCache(const std::string& path) {
+		open(path);
+	}
+
+	// maps path and checks the header and every LOD against the file size and
+	// index count, so nothing read through it can point outside the mapping
+	bool open(const std::string& path) {
+		valid = false;
+		if (!file.open(path)) {
+			return false;
+		}
+		if (file.size() < sizeof(MeshCacheHeader)) {
+			std::cout << "ERROR::MESH_CACHE::FILE_TOO_SMALL " << path << std::endl;
+			return false;
+		}
+		std::memcpy(&head, file.data(), sizeof(head));
+		if (std::memcmp(head.magic, "LMSH", 4) != 0 || head.version != MESH_CACHE_VERSION) {
+			std::cout << "ERROR::MESH_CACHE::NOT_A_MESH_CACHE " << path << std::endl;
+			return false;
+		}
+		bool raw = head.compression == MESH_CACHE_RAW;
+		// counts are capped at 32 bits first, so the sizes computed from them cannot wrap
+		bool inside = head.vertexCount <= UINT32_MAX && head.indexCount <= UINT32_MAX
+			&& (head.indexType == GL_UNSIGNED_SHORT || head.indexType == GL_UNSIGNED_INT)
+			&& blobInside(head.attributeOffset, (uint64_t)head.attributeCount * sizeof(MeshCacheAttribute))
+			&& blobInside(head.lodOffset, (uint64_t)head.lodCount * sizeof(MeshCacheLod))
+			&& blobInside(head.vertexOffset, head.vertexBytes)
+			&& blobInside(head.indexOffset, head.indexBytes)
+			&& (raw || head.compression == MESH_CACHE_ENCODED)
+			&& (!raw || head.vertexBytes == decodedVertexBytes())
+			&& (!raw || head.indexBytes == decodedIndexBytes());
+		if (!inside) {
+			std::cout << "ERROR::MESH_CACHE::TRUNCATED " << path << std::endl;
+			return false;
+		}
+		for (int level = 0; level < lodCount(); level++) {
+			MeshLod entry = lod(level);
+			if (entry.firstIndex > head.indexCount || entry.indexCount > head.indexCount - entry.firstIndex) {
+				std::cout << "ERROR::MESH_CACHE::LOD_OUT_OF_RANGE " << path << " level " << level << std::endl;
+				return false;
+			}
+		}
+		valid = true;
+		return true;
+	}
+
+	bool isOpen() const {
+		return valid;
+	}
+
+	// true when the file's vertices were written with Layout, attribute for attribute
+	template <typename Layout>
+	bool matches() const {
+		std::vector<MeshCacheAttribute> expected = MeshCacheLayout<Layout>::describe();
+		if (!valid || head.vertexStride != Layout::stride || head.attributeCount != expected.size()) {
+			return false;
+		}
+		return std::memcmp(attributes(), expected.data(), expected.size() * sizeof(MeshCacheAttribute)) == 0;
+	}
+
+	// fills vbo and ebo straight from the mapping, or decodes into the mapped
+	// buffers when the file is encoded. the element buffer binding is VAO
+	// state, so the VAO that reads them should be bound
+	bool upload(unsigned int vbo, unsigned int ebo, GLenum usage = GL_STATIC_DRAW) const {
+		if (head.compression == MESH_CACHE_RAW) {
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)head.vertexBytes, vertexData(), usage);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)head.indexBytes, indexData(), usage);
+			return true;
+		}
+		bool decoded = uploadDecoded(GL_ARRAY_BUFFER, vbo, decodedVertexBytes(), usage, [this](void* out) {
+			return decodeVertices(out);
+		});
+		decoded = decoded && uploadDecoded(GL_ELEMENT_ARRAY_BUFFER, ebo, decodedIndexBytes(), usage, [this](void* out) {
+			return decodeIndices(out);
+		});
+		if (!decoded) {
+			std::cout << "ERROR::MESH_CACHE::DECODE_FAILED" << std::endl;
+		}
+		return decoded;
+	}
+
+	// writes the vertices, decoded if need be, to out, which holds decodedVertexBytes()
+	bool decodeVertices(void* out) const {
+		if (head.compression == MESH_CACHE_RAW) {
+			std::memcpy(out, vertexData(), (size_t)head.vertexBytes);
+			return true;
+		}
+		return decodeVertexBuffer(out, (size_t)head.vertexCount, head.vertexStride,
+			(const unsigned char*)vertexData(), (size_t)head.vertexBytes);
+	}
+
+	// writes the indices in indexType(), decoded if need be, to out, which holds decodedIndexBytes()
+	bool decodeIndices(void* out) const {
+		if (head.compression == MESH_CACHE_RAW) {
+			std::memcpy(out, indexData(), (size_t)head.indexBytes);
+			return true;
+		}
+		const unsigned char* data = (const unsigned char*)indexData();
+		if (head.indexType == GL_UNSIGNED_SHORT) {
+			return decodeIndexBuffer((uint16_t*)out, (size_t)head.indexCount, data, (size_t)head.indexBytes);
+		}
+		return decodeIndexBuffer((uint32_t*)out, (size_t)head.indexCount, data, (size_t)head.indexBytes);
+	}
+
+	size_t decodedVertexBytes() const {
+		return (size_t)(head.vertexCount * head.vertexStride);
+	}
+
+	size_t decodedIndexBytes() const {
+		return (size_t)head.indexCount * (head.indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+	}
+
+	bool isEncoded() const {
+		return head.compression == MESH_CACHE_ENCODED;
+	}
+
+	const MeshCacheHeader& header() const {
+		return head;
+	}
+
+	const MeshCacheAttribute* attributes() const {
+		return (const MeshCacheAttribute*)(file.data() + head.attributeOffset);
+	}
+
+	const void* vertexData() const {
+		return file.data() + head.vertexOffset;
+	}
+
+	const void* indexData() const {
+		return file.data() + head.indexOffset;
+	}
+
+	GLenum indexType() const {
+		return head.indexType;
+	}
+
+	int lodCount() const {
+		return (int)head.lodCount;
+	}
+
+	MeshLod lod(int level) const {
+		MeshCacheLod entry;
+		std::memcpy(&entry, file.data() + head.lodOffset + level * sizeof(MeshCacheLod), sizeof(entry));
+		MeshLod result;
+		result.firstIndex = entry.firstIndex;
+		result.indexCount = entry.indexCount;
+		result.error = entry.error;
+		return result;
+	}
+
+private:
+	// true when size bytes from offset lie inside the file, written so that
+	// neither side can wrap around
+	bool blobInside(uint64_t offset, uint64_t size) const {
+		return offset <= file.size() && size <= file.size() - offset;
+	}
+
+	// decodes into the buffer's own storage so the data is written once
+	template <typename Decode>
+	static bool uploadDecoded(GLenum target, unsigned int buffer, size_t size, GLenum usage, Decode&& decode) {
+		glBindBuffer(target, buffer);
+		glBufferData(target, (GLsizeiptr)size, NULL, usage);
+		if (size == 0) {
+			return true;
+		}
+		void* mapped = glMapBufferRange(target, 0, (GLsizeiptr)size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!mapped) {
+			return false;
+		}
+		bool decoded = decode(mapped);
+		// contents are undefined when unmapping fails, e.g. after a mode switch
+		return glUnmapBuffer(target) == GL_TRUE && decoded;
+	}
+
+	MappedFile file;
+	MeshCacheHeader head = {};
+	bool valid = false;
+};
+
+#endif
@@ -0,0 +1,338 @@
+#ifndef MESH_CODEC_H
+#define MESH_CODEC_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+// lossless vertex and index buffer compression for assets on disk, decoded
+// straight into GL buffers at load time.
+//
+// vertices are coded in groups of 16. every byte of the vertex is a plane of
+// 16 bytes holding the zigzagged difference to the same byte of the previous
+// vertex; a plane is stored with 0, 2, 4 or 8 bits per byte, picked per plane
+// and group by a 2 bit mode in the group header. data that changes slowly from
+// vertex to vertex, as it does after optimizeVertexFetch, codes to few bits.
+//
+// triangles get a 2 bit code saying which edge of the previous triangle they
+// share, if any, so strip-like runs cost one new vertex per triangle. vertices
+// are varints of their zigzagged distance to the next vertex not used yet,
+// which is 0 for the first use of a vertex in fetch order
+const size_t VERTEX_CODEC_GROUP = 16;
+const size_t VERTEX_CODEC_MAX_STRIDE = 256;
+
+inline unsigned char zigzag8(unsigned char delta) {
+	return (unsigned char)((delta << 1) ^ (unsigned char)((signed char)delta >> 7));
+}
+
+inline unsigned char unzigzag8(unsigned char value) {
+	return (unsigned char)((value >> 1) ^ (unsigned char)-(value & 1));
+}
+
+// worst case size of encodeVertexBuffer's output
+inline size_t vertexBufferBound(size_t count, size_t stride) {
+	size_t groups = (count + VERTEX_CODEC_GROUP - 1) / VERTEX_CODEC_GROUP;
+	return groups * (stride / 4 + stride * VERTEX_CODEC_GROUP);
+}
+
+// stride must be a multiple of 4 no larger than VERTEX_CODEC_MAX_STRIDE,
+// which every VertexLayout satisfies
+inline std::vector<unsigned char> encodeVertexBuffer(const void* vertices, size_t count, size_t stride) {
+	std::vector<unsigned char> out;
+	if (stride % 4 != 0 || stride > VERTEX_CODEC_MAX_STRIDE) {
+		return out;
+	}
+	out.reserve(vertexBufferBound(count, stride));
+	const unsigned char* bytes = (const unsigned char*)vertices;
+	unsigned char last[VERTEX_CODEC_MAX_STRIDE] = {};
+	unsigned char plane[VERTEX_CODEC_GROUP];
+
+	for (size_t first = 0; first < count; first += VERTEX_CODEC_GROUP) {
+		size_t n = std::min(VERTEX_CODEC_GROUP, count - first);
+		size_t header = out.size();
+		out.resize(header + stride / 4, 0);
+		for (size_t k = 0; k < stride; k++) {
+			unsigned char previous = last[k], largest = 0;
+			for (size_t v = 0; v < VERTEX_CODEC_GROUP; v++) {
+				// missing vertices of the last group repeat the last one
+				unsigned char value = v < n ? bytes[(first + v) * stride + k] : previous;
+				plane[v] = zigzag8((unsigned char)(value - previous));
+				largest = std::max(largest, plane[v]);
+				previous = value;
+			}
+			last[k] = previous;
+
+			int mode = largest == 0 ? 0 : largest < 4 ? 1 : largest < 16 ? 2 : 3;
+			out[header + k / 4] |= (unsigned char)(mode << (6 - 2 * (k % 4)));
+			if (mode == 1) {
+				for (size_t v = 0; v < VERTEX_CODEC_GROUP; v += 4) {
+					out.push_back((unsigned char)(plane[v] << 6 | plane[v + 1] << 4 | plane[v + 2] << 2 | plane[v + 3]));
+				}
+			}
+			else if (mode == 2) {
+				for (size_t v = 0; v < VERTEX_CODEC_GROUP; v += 2) {
+					out.push_back((unsigned char)(plane[v] << 4 | plane[v + 1]));
+				}
+			}
+			else if (mode == 3) {
+				out.insert(out.end(), plane, plane + VERTEX_CODEC_GROUP);
+			}
+		}
+	}
+	return out;
+}
+
+#if defined(MESH_CODEC_SSE2)
+// one plane of a group: unpacks the bytes its mode says, undoes the zigzag and
+// adds up the differences, carry holding the previous byte in every lane
+inline __m128i decodeVertexPlane(int mode, const unsigned char*& p, __m128i& carry) {
+	const __m128i one = _mm_set1_epi8(1), low2 = _mm_set1_epi8(3), low4 = _mm_set1_epi8(15);
+	const __m128i low7 = _mm_set1_epi8(127);
+	__m128i values;
+	if (mode == 0) {
+		return carry;
+	}
+	else if (mode == 1) {
+		int packed;
+		std::memcpy(&packed, p, 4);
+		p += 4;
+		__m128i x = _mm_cvtsi32_si128(packed);
+		__m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), low4), _mm_and_si128(x, low4));
+		values = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(nibbles, 2), low2), _mm_and_si128(nibbles, low2));
+	}
+	else if (mode == 2) {
+		__m128i x = _mm_loadl_epi64((const __m128i*)p);
+		p += 8;
+		values = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), low4), _mm_and_si128(x, low4));
+	}
+	else {
+		values = _mm_loadu_si128((const __m128i*)p);
+		p += 16;
+	}
+	__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(values, one));
+	values = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(values, 1), low7), sign);
+
+	// prefix sum over the 16 bytes
+	values = _mm_add_epi8(values, _mm_slli_si128(values, 1));
+	values = _mm_add_epi8(values, _mm_slli_si128(values, 2));
+	values = _mm_add_epi8(values, _mm_slli_si128(values, 4));
+	values = _mm_add_epi8(values, _mm_slli_si128(values, 8));
+	values = _mm_add_epi8(values, carry);
+
+	// broadcast byte 15 for the next group
+	__m128i top = _mm_unpackhi_epi8(values, values);
+	top = _mm_unpackhi_epi16(top, top);
+	carry = _mm_shuffle_epi32(top, 0xFF);
+	return values;
+}
+#endif
+
+// bytes the planes of a group take after its header
+inline ptrdiff_t vertexGroupSize(const unsigned char* header, size_t stride) {
+	static const int modeBytes[4] = { 0, 4, 8, 16 };
+	ptrdiff_t size = 0;
+	for (size_t k = 0; k < stride; k++) {
+		size += modeBytes[(header[k / 4] >> (6 - 2 * (k % 4))) & 3];
+	}
+	return size;
+}
+
+// decodes count vertices of stride bytes into out; false when data is not a
+// complete encoding of them
+inline bool decodeVertexBuffer(void* out, size_t count, size_t stride, const unsigned char* data, size_t size) {
+	if (stride % 4 != 0 || stride > VERTEX_CODEC_MAX_STRIDE) {
+		return false;
+	}
+	unsigned char* bytes = (unsigned char*)out;
+	const unsigned char* p = data;
+	const unsigned char* end = data + size;
+#if defined(MESH_CODEC_SSE2)
+	__m128i carry[VERTEX_CODEC_MAX_STRIDE];
+	for (size_t k = 0; k < stride; k++) {
+		carry[k] = _mm_setzero_si128();
+	}
+#else
+	unsigned char last[VERTEX_CODEC_MAX_STRIDE] = {};
+#endif
+
+	for (size_t first = 0; first < count; first += VERTEX_CODEC_GROUP) {
+		size_t n = std::min(VERTEX_CODEC_GROUP, count - first);
+		const unsigned char* header = p;
+		if ((size_t)(end - p) < stride / 4) {
+			return false;
+		}
+		p += stride / 4;
+		if (end - p < vertexGroupSize(header, stride)) {
+			return false;
+		}
+		unsigned char* group = bytes + first * stride;
+#if defined(MESH_CODEC_SSE2)
+		for (size_t k = 0; k < stride; k += 4) {
+			int modes = header[k / 4];
+			__m128i p0 = decodeVertexPlane((modes >> 6) & 3, p, carry[k]);
+			__m128i p1 = decodeVertexPlane((modes >> 4) & 3, p, carry[k + 1]);
+			__m128i p2 = decodeVertexPlane((modes >> 2) & 3, p, carry[k + 2]);
+			__m128i p3 = decodeVertexPlane(modes & 3, p, carry[k + 3]);
+
+			// transpose four planes into 4 bytes for each of the 16 vertices
+			__m128i t0 = _mm_unpacklo_epi8(p0, p1), t1 = _mm_unpackhi_epi8(p0, p1);
+			__m128i t2 = _mm_unpacklo_epi8(p2, p3), t3 = _mm_unpackhi_epi8(p2, p3);
+			alignas(16) unsigned char transposed[64];
+			_mm_store_si128((__m128i*)transposed, _mm_unpacklo_epi16(t0, t2));
+			_mm_store_si128((__m128i*)(transposed + 16), _mm_unpackhi_epi16(t0, t2));
+			_mm_store_si128((__m128i*)(transposed + 32), _mm_unpacklo_epi16(t1, t3));
+			_mm_store_si128((__m128i*)(transposed + 48), _mm_unpackhi_epi16(t1, t3));
+			for (size_t v = 0; v < n; v++) {
+				std::memcpy(group + v * stride + k, transposed + v * 4, 4);
+			}
+		}
+#else
+		for (size_t k = 0; k < stride; k++) {
+			int mode = (header[k / 4] >> (6 - 2 * (k % 4))) & 3;
+			unsigned char plane[VERTEX_CODEC_GROUP] = {};
+			for (size_t v = 0; v < VERTEX_CODEC_GROUP && mode != 0; v++) {
+				plane[v] = mode == 1 ? (p[v / 4] >> (6 - 2 * (v % 4))) & 3
+					: mode == 2 ? (p[v / 2] >> (v % 2 == 0 ? 4 : 0)) & 15 : p[v];
+			}
+			p += mode == 1 ? 4 : mode == 2 ? 8 : mode == 3 ? 16 : 0;
+			unsigned char value = last[k];
+			for (size_t v = 0; v < VERTEX_CODEC_GROUP; v++) {
+				value = (unsigned char)(value + unzigzag8(plane[v]));
+				if (v < n) {
+					group[v * stride + k] = value;
+				}
+			}
+			last[k] = value;
+		}
+#endif
+	}
+	return p == end;
+}
+
+inline void writeVarint(std::vector<unsigned char>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((unsigned char)value);
+}
+
+inline bool readVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+	if (p < end && *p < 0x80) {
+		value = *p++;
+		return true;
+	}
+	value = 0;
+	for (int shift = 0; p < end && shift < 64; shift += 7) {
+		unsigned char byte = *p++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// indices must form whole triangles; triangles may come back rotated to start
+// on the edge they share with the previous one, their winding is kept
+inline std::vector<unsigned char> encodeIndexBuffer(const unsigned int* indices, size_t count) {
+	size_t triangles = count / 3;
+	std::vector<unsigned char> out((triangles + 3) / 4, 0);
+	out.reserve(out.size() + count);
+	unsigned int previous[3] = { 0, 0, 0 };
+	int64_t next = 0;
+	auto writeVertex = [&](unsigned int v) {
+		int64_t delta = (int64_t)v - next;
+		writeVarint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+		next = std::max(next, (int64_t)v + 1);
+	};
+
+	for (size_t t = 0; t < triangles; t++) {
+		const unsigned int* triangle = indices + t * 3;
+		int code = 0;
+		unsigned int a = triangle[0], b = triangle[1], c = triangle[2];
+		for (int rotation = 0; rotation < 3 && t > 0 && code == 0; rotation++) {
+			unsigned int x = triangle[rotation], y = triangle[(rotation + 1) % 3];
+			for (int edge = 0; edge < 3; edge++) {
+				// the edge runs the other way in a neighbour with the same winding
+				if (x == previous[(edge + 1) % 3] && y == previous[edge]) {
+					code = edge + 1;
+					a = x;
+					b = y;
+					c = triangle[(rotation + 2) % 3];
+					break;
+				}
+			}
+		}
+		out[t / 4] |= (unsigned char)(code << (6 - 2 * (t % 4)));
+		if (code == 0) {
+			writeVertex(a);
+			writeVertex(b);
+		}
+		writeVertex(c);
+		previous[0] = a;
+		previous[1] = b;
+		previous[2] = c;
+	}
+	return out;
+}
+
+// decodes count indices into out, which holds unsigned short or unsigned int;
+// false when data is not a complete encoding or a vertex does not fit T
+template <typename T>
+bool decodeIndexBuffer(T* out, size_t count, const unsigned char* data, size_t size) {
+	size_t triangles = count / 3;
+	size_t codeBytes = (triangles + 3) / 4;
+	if (size < codeBytes) {
+		return false;
+	}
+	const unsigned char* p = data + codeBytes;
+	const unsigned char* end = data + size;
+	int64_t next = 0;
+	const int64_t largest = std::numeric_limits<T>::max();
+	auto readVertex = [&](T& vertex) {
+		uint64_t value;
+		if (!readVarint(p, end, value)) {
+			return false;
+		}
+		int64_t v = next + (int64_t)((value >> 1) ^ (0 - (value & 1)));
+		if (v < 0 || v > largest) {
+			return false;
+		}
+		next = std::max(next, v + 1);
+		vertex = (T)v;
+		return true;
+	};
+
+	T* triangle = out;
+	for (size_t t = 0; t < triangles; t++, triangle += 3) {
+		int code = (data[t / 4] >> (6 - 2 * (t % 4))) & 3;
+		if (code == 0) {
+			if (!readVertex(triangle[0]) || !readVertex(triangle[1])) {
+				return false;
+			}
+		}
+		else {
+			if (t == 0) {
+				return false;
+			}
+			const T* previous = triangle - 3;
+			triangle[0] = previous[code % 3];
+			triangle[1] = previous[code - 1];
+		}
+		if (!readVertex(triangle[2])) {
+			return false;
+		}
+	}
+	return p == end;
+}
+
+#endif
@@ -0,0 +1,1000 @@
+#ifndef MESH_IMPORT_H
+#define MESH_IMPORT_H
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "mapped_file.h"
+#include "vertex_layout.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_IMPORT_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// geometry read from a file, its vertices already interleaved in the layout it
+// was imported with, so they go to glBufferData as they are and Layout::setup
+// reads them. attributes the file lacks are left zero
+struct ImportedMesh {
+	std::vector<unsigned char> vertices;
+	std::vector<unsigned int> indices;
+	size_t vertexCount = 0;
+	size_t stride = 0;
+	float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+	float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+	bool hasNormals = false;
+	bool hasTexCoords = false;
+	bool hasColors = false;
+	size_t sourceBytes = 0;		// size of the file it came from
+};
+
+inline unsigned int lowestSetBit(uint32_t value) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(value);
+#endif
+}
+
+// length of the run of decimal digits at p, found sixteen bytes at a time with SSE2
+inline unsigned int countDigits(const char* p, const char* end) {
+#if defined(MESH_IMPORT_SSE2)
+	if (end - p >= 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)p);
+		__m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+		// a byte is a digit when its unsigned distance from '0' is at most 9
+		__m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(9)), shifted);
+		return lowestSetBit(~(uint32_t)_mm_movemask_epi8(digits));
+	}
+#endif
+	unsigned int count = 0;
+	while (p + count < end && (unsigned char)(p[count] - '0') <= 9) {
+		count++;
+	}
+	return count;
+}
+
+// value of eight digit characters, combined pairwise inside one 64 bit word
+inline uint32_t parseEightDigits(const char* p) {
+	uint64_t value;
+	std::memcpy(&value, p, 8);
+	value -= 0x3030303030303030ull;
+	value = value * 10 + (value >> 8);
+	value = (((value & 0x000000FF000000FFull) * (100 + (1000000ull << 32)))
+		+ (((value >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+	return (uint32_t)value;
+}
+
+// strtof over [p, end), which need not be null terminated
+inline const char* parseFloatSlow(const char* p, const char* end, float& value) {
+	std::string buffer(p, end);
+	char* parsedEnd;
+	value = std::strtof(buffer.c_str(), &parsedEnd);
+	return p + (parsedEnd - buffer.c_str());
+}
+
+// true when a double lies exactly halfway between two normal floats, where
+// rounding it to float can differ from rounding the decimal it came from
+inline bool onFloatMidpoint(double value) {
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x1FFFFFFFull) == 0x10000000ull;
+}
+
+// parses [+-]digits[.digits][(e|E)[+-]digits] at p into value and returns the
+// end of the number, or p when there is none. mantissas up to 2^53 with powers
+// of ten up to 1e22 are exact doubles, so one multiply or divide rounds them
+// correctly, and rounding that to float matches strtof unless it sits exactly
+// on a float midpoint. those, longer or truncated mantissas, larger exponents and
+// subnormal or overflowing results go to strtof, as do inf and nan
+inline const char* parseFloat(const char* p, const char* end, float& value) {
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int significant = 0;
+	bool anyDigits = false;
+	bool truncated = false;		// nonzero digits were left out of the mantissa
+	for (int part = 0; part < 2; part++) {
+		bool fraction = part == 1;
+		if (fraction) {
+			if (p >= end || *p != '.') {
+				break;
+			}
+			p++;
+		}
+		for (unsigned int run = countDigits(p, end); run > 0; run = countDigits(p, end)) {
+			anyDigits = true;
+			const char* runEnd = p + run;
+			while (p < runEnd) {
+				if (runEnd - p >= 8 && significant + 8 <= 19) {
+					mantissa = mantissa * 100000000u + parseEightDigits(p);
+					significant += mantissa != 0 ? 8 : 0;
+					exponent -= fraction ? 8 : 0;
+					p += 8;
+				}
+				else if (significant < 19) {
+					mantissa = mantissa * 10 + (unsigned int)(*p - '0');
+					significant += mantissa != 0 ? 1 : 0;
+					exponent -= fraction ? 1 : 0;
+					p++;
+				}
+				else {
+					// digits past what a uint64 holds only shift the integer part
+					exponent += fraction ? 0 : 1;
+					truncated = truncated || *p != '0';
+					p++;
+				}
+			}
+		}
+	}
+
+	if (!anyDigits) {
+		return parseFloatSlow(start, start + std::min<size_t>(31, end - start), value);
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = *e == '-';
+			e++;
+		}
+		if (e < end && (unsigned char)(*e - '0') <= 9) {
+			int written = 0;
+			while (e < end && (unsigned char)(*e - '0') <= 9) {
+				written = std::min(written * 10 + (*e - '0'), 100000);
+				e++;
+			}
+			exponent += negativeExponent ? -written : written;
+			p = e;
+		}
+	}
+
+	if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+		double result = exponent < 0 ? (double)mantissa / powers[-exponent] : (double)mantissa * powers[exponent];
+		if (mantissa == 0 || (result >= FLT_MIN && result <= FLT_MAX && !onFloatMidpoint(result))) {
+			value = (float)(negative ? -result : result);
+			return p;
+		}
+	}
+	parseFloatSlow(start, p, value);
+	return p;
+}
+
+// parses an optionally signed decimal integer, returning p when there is none
+inline const char* parseInt(const char* p, const char* end, long& value) {
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+	unsigned int run = countDigits(p, end);
+	if (run == 0) {
+		return start;
+	}
+	long result = 0;
+	for (const char* runEnd = p + run; p < runEnd; p++) {
+		result = result * 10 + (*p - '0');
+	}
+	value = negative ? -result : result;
+	return p;
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+		p++;
+	}
+	return p;
+}
+
+// parses up to count floats separated by spaces, returning how many were found
+inline int parseFloats(const char*& p, const char* end, float* values, int count) {
+	int found = 0;
+	for (; found < count; found++) {
+		p = skipSpaces(p, end);
+		const char* next = parseFloat(p, end, values[found]);
+		if (next == p) {
+			break;
+		}
+		p = next;
+	}
+	return found;
+}
+
+// copies up to Attr's components from values into a vertex, if Layout has Attr
+template <typename Layout, typename Attr>
+inline void writeAttribute(unsigned char* vertex, const float* values, int available) {
+	constexpr int index = Layout::template indexOf<Attr>();
+	if constexpr (index >= 0) {
+		static_assert(std::is_same<typename Attr::type, float>::value, "imported attributes are floats");
+		std::memcpy(vertex + Layout::offsets[index], values, sizeof(float) * std::min(available, Attr::components));
+	}
+}
+
+inline void growBounds(ImportedMesh& mesh, const float* position) {
+	for (int c = 0; c < 3; c++) {
+		mesh.boundsMin[c] = std::min(mesh.boundsMin[c], position[c]);
+		mesh.boundsMax[c] = std::max(mesh.boundsMax[c], position[c]);
+	}
+}
+
+inline void resetImportedMesh(ImportedMesh& mesh, size_t stride, size_t sourceBytes) {
+	mesh = ImportedMesh();
+	mesh.stride = stride;
+	mesh.sourceBytes = sourceBytes;
+	for (int c = 0; c < 3; c++) {
+		mesh.boundsMin[c] = FLT_MAX;
+		mesh.boundsMax[c] = -FLT_MAX;
+	}
+}
+
+inline void finishBounds(ImportedMesh& mesh) {
+	if (mesh.vertexCount == 0) {
+		for (int c = 0; c < 3; c++) {
+			mesh.boundsMin[c] = mesh.boundsMax[c] = 0.0f;
+		}
+	}
+}
+
+// position, texture coord and normal index triple of an OBJ face corner mapped
+// to the output vertex it became; open addressing, grown at half load
+class ObjVertexMap {
+public:
+	static const uint32_t NONE = 0xffffffffu;
+
+	ObjVertexMap() : slots(1024) {}
+
+	// output vertex of the triple, or NONE after reserving a slot that assign() fills
+	uint32_t find(uint32_t position, uint32_t texCoord, uint32_t normal) {
+		if ((used + 1) * 2 > slots.size()) {
+			grow(slots.size() * 2);
+		}
+		size_t mask = slots.size() - 1;
+		size_t i = hash(position, texCoord, normal) & mask;
+		while (slots[i].vertex != NONE) {
+			const Slot& slot = slots[i];
+			if (slot.position == position && slot.texCoord == texCoord && slot.normal == normal) {
+				return slot.vertex;
+			}
+			i = (i + 1) & mask;
+		}
+		pending = i;
+		slots[i].position = position;
+		slots[i].texCoord = texCoord;
+		slots[i].normal = normal;
+		return NONE;
+	}
+
+	// sizes the table for count triples without growing
+	void reserve(size_t count) {
+		size_t size = slots.size();
+		while (size < count * 2) {
+			size *= 2;
+		}
+		if (size > slots.size()) {
+			grow(size);
+		}
+	}
+
+	void assign(uint32_t vertex) {
+		slots[pending].vertex = vertex;
+		used++;
+	}
+
+private:
+	struct Slot {
+		uint32_t position = 0, texCoord = 0, normal = 0;
+		uint32_t vertex = NONE;
+	};
+
+	std::vector<Slot> slots;
+	size_t used = 0;
+	size_t pending = 0;
+
+	static size_t hash(uint32_t position, uint32_t texCoord, uint32_t normal) {
+		uint64_t h = position * 0x9E3779B97F4A7C15ull ^ (texCoord + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full
+			^ (uint64_t)normal * 0x165667B19E3779F9ull;
+		return (size_t)(h ^ (h >> 29));
+	}
+
+	void grow(size_t size) {
+		std::vector<Slot> old(size);
+		old.swap(slots);
+		size_t mask = slots.size() - 1;
+		for (const Slot& slot : old) {
+			if (slot.vertex == NONE) {
+				continue;
+			}
+			size_t i = hash(slot.position, slot.texCoord, slot.normal) & mask;
+			while (slots[i].vertex != NONE) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = slot;
+		}
+	}
+};
+
+// parses OBJ text into mesh. v, vt, vn and f lines are read, including
+// vertex colors after v positions and negative indices; polygons are fanned
+// into triangles and identical corners share one output vertex. everything
+// else (groups, materials, smoothing) is skipped
+template <typename Layout>
+bool parseObj(const char* p, const char* end, ImportedMesh& mesh) {
+	resetImportedMesh(mesh, Layout::stride, end - p);
+	std::vector<float> positions, colors, texCoords, normals;
+	ObjVertexMap vertexMap;
+	std::vector<uint32_t> polygon;
+	size_t badLines = 0;
+
+	while (p < end) {
+		p = skipSpaces(p, end);
+		if (p >= end) {
+			break;
+		}
+		const char* lineEnd = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+		if (!lineEnd) {
+			lineEnd = end;
+		}
+		char kind = p < lineEnd ? p[0] : '#';
+		char next = p + 1 < lineEnd ? p[1] : '\n';
+		const char* q = p + 2;
+
+		if (kind == 'v' && (next == ' ' || next == '\t')) {
+			float values[6];
+			q = p + 1;
+			int found = parseFloats(q, lineEnd, values, 6);
+			if (found < 3) {
+				badLines++;
+			}
+			else {
+				positions.insert(positions.end(), values, values + 3);
+				if (found == 6) {
+					colors.resize(positions.size() - 3, 1.0f);
+					colors.insert(colors.end(), values + 3, values + 6);
+				}
+			}
+		}
+		else if (kind == 'v' && next == 't') {
+			float values[2] = { 0.0f, 0.0f };
+			if (parseFloats(q, lineEnd, values, 2) < 1) {
+				badLines++;
+			}
+			texCoords.insert(texCoords.end(), values, values + 2);
+		}
+		else if (kind == 'v' && next == 'n') {
+			float values[3] = { 0.0f, 0.0f, 0.0f };
+			if (parseFloats(q, lineEnd, values, 3) < 3) {
+				badLines++;
+			}
+			normals.insert(normals.end(), values, values + 3);
+		}
+		else if (kind == 'f' && (next == ' ' || next == '\t')) {
+			// most files list their vertices before the faces, so the first face
+			// sizes the output for about one vertex per position
+			if (mesh.indices.empty() && mesh.vertexCount == 0) {
+				vertexMap.reserve(positions.size() / 3);
+				mesh.vertices.reserve(positions.size() / 3 * Layout::stride);
+			}
+			polygon.clear();
+			bool valid = true;
+			q = p + 1;
+			while (valid) {
+				q = skipSpaces(q, lineEnd);
+				long corner[3] = { 0, 0, 0 };
+				const char* afterPosition = parseInt(q, lineEnd, corner[0]);
+				if (afterPosition == q) {
+					break;
+				}
+				q = afterPosition;
+				for (int k = 1; k < 3 && q < lineEnd && *q == '/'; k++) {
+					q++;
+					q = parseInt(q, lineEnd, corner[k]);
+				}
+
+				// 1 based, or counted back from the last element when negative
+				size_t counts[3] = { positions.size() / 3, texCoords.size() / 2, normals.size() / 3 };
+				uint32_t resolved[3];
+				for (int k = 0; k < 3; k++) {
+					long index = corner[k] < 0 ? (long)counts[k] + corner[k] : corner[k] - 1;
+					if (corner[k] == 0 && k > 0) {
+						resolved[k] = ObjVertexMap::NONE;
+					}
+					else if (index < 0 || index >= (long)counts[k]) {
+						valid = false;
+					}
+					else {
+						resolved[k] = (uint32_t)index;
+					}
+				}
+				if (!valid) {
+					break;
+				}
+
+				uint32_t vertex = vertexMap.find(resolved[0], resolved[1], resolved[2]);
+				if (vertex == ObjVertexMap::NONE) {
+					vertex = (uint32_t)mesh.vertexCount++;
+					vertexMap.assign(vertex);
+					mesh.vertices.resize(mesh.vertexCount * Layout::stride);
+					unsigned char* out = &mesh.vertices[vertex * Layout::stride];
+					const float* position = &positions[resolved[0] * 3];
+					writeAttribute<Layout, Position3f>(out, position, 3);
+					growBounds(mesh, position);
+					if (resolved[0] * 3 < colors.size()) {
+						writeAttribute<Layout, Color3f>(out, &colors[resolved[0] * 3], 3);
+					}
+					if (resolved[1] != ObjVertexMap::NONE) {
+						writeAttribute<Layout, TexCoord2f>(out, &texCoords[resolved[1] * 2], 2);
+					}
+					if (resolved[2] != ObjVertexMap::NONE) {
+						writeAttribute<Layout, Normal3f>(out, &normals[resolved[2] * 3], 3);
+					}
+				}
+				polygon.push_back(vertex);
+			}
+
+			if (!valid || polygon.size() < 3) {
+				badLines++;
+			}
+			else {
+				for (size_t k = 2; k < polygon.size(); k++) {
+					mesh.indices.push_back(polygon[0]);
+					mesh.indices.push_back(polygon[k - 1]);
+					mesh.indices.push_back(polygon[k]);
+				}
+			}
+		}
+		p = lineEnd + 1;
+	}
+
+	mesh.hasTexCoords = !texCoords.empty();
+	mesh.hasNormals = !normals.empty();
+	mesh.hasColors = !colors.empty();
+	finishBounds(mesh);
+	if (badLines > 0) {
+		std::cout << "ERROR::MESH_IMPORT::OBJ_MALFORMED_LINES " << badLines << " skipped" << std::endl;
+	}
+	return !mesh.indices.empty();
+}
+
+template <typename Layout>
+bool importObj(const std::string& path, ImportedMesh& mesh) {
+	MappedFile file(path);
+	if (!file.isOpen()) {
+		return false;
+	}
+	return parseObj<Layout>(file.begin(), file.end(), mesh);
+}
+
+// parsed JSON document, enough of it for glTF
+struct JsonValue {
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+	Type type = NUL;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::pair<std::string, JsonValue>> members;
+
+	const JsonValue* find(const char* key) const {
+		for (const auto& member : members) {
+			if (member.first == key) {
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+
+	double numberOr(const char* key, double fallback) const {
+		const JsonValue* value = find(key);
+		return value && value->type == NUMBER ? value->number : fallback;
+	}
+
+	int intOr(const char* key, int fallback) const {
+		return (int)numberOr(key, fallback);
+	}
+};
+
+class JsonParser {
+public:
+	JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+	bool parse(JsonValue& value) {
+		return parseValue(value, 0) && (skip(), p == end);
+	}
+
+private:
+	const char* p;
+	const char* end;
+
+	void skip() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+			p++;
+		}
+	}
+
+	bool literal(const char* word) {
+		size_t length = std::strlen(word);
+		if ((size_t)(end - p) < length || std::memcmp(p, word, length) != 0) {
+			return false;
+		}
+		p += length;
+		return true;
+	}
+
+	bool parseValue(JsonValue& value, int depth) {
+		skip();
+		if (p >= end || depth > 64) {
+			return false;
+		}
+		switch (*p) {
+		case '{': {
+			value.type = JsonValue::OBJECT;
+			p++;
+			skip();
+			if (p < end && *p == '}') {
+				p++;
+				return true;
+			}
+			while (true) {
+				skip();
+				std::string key;
+				if (!parseString(key)) {
+					return false;
+				}
+				skip();
+				if (p >= end || *p++ != ':') {
+					return false;
+				}
+				value.members.emplace_back(std::move(key), JsonValue());
+				if (!parseValue(value.members.back().second, depth + 1)) {
+					return false;
+				}
+				skip();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				return p < end && *p++ == '}';
+			}
+		}
+		case '[': {
+			value.type = JsonValue::ARRAY;
+			p++;
+			skip();
+			if (p < end && *p == ']') {
+				p++;
+				return true;
+			}
+			while (true) {
+				value.items.emplace_back();
+				if (!parseValue(value.items.back(), depth + 1)) {
+					return false;
+				}
+				skip();
+				if (p < end && *p == ',') {
+					p++;
+					continue;
+				}
+				return p < end && *p++ == ']';
+			}
+		}
+		case '"':
+			value.type = JsonValue::STRING;
+			return parseString(value.string);
+		case 't':
+			value.type = JsonValue::BOOLEAN;
+			value.boolean = true;
+			return literal("true");
+		case 'f':
+			value.type = JsonValue::BOOLEAN;
+			return literal("false");
+		case 'n':
+			return literal("null");
+		default: {
+			// offsets can exceed float precision, so numbers go through strtod
+			char buffer[64];
+			size_t length = 0;
+			while (p + length < end && length < sizeof(buffer) - 1 && std::strchr("+-0123456789.eE", p[length])) {
+				length++;
+			}
+			std::memcpy(buffer, p, length);
+			buffer[length] = '\0';
+			char* parsedEnd;
+			value.type = JsonValue::NUMBER;
+			value.number = std::strtod(buffer, &parsedEnd);
+			if (parsedEnd == buffer) {
+				return false;
+			}
+			p += parsedEnd - buffer;
+			return true;
+		}
+		}
+	}
+
+	bool parseString(std::string& out) {
+		if (p >= end || *p != '"') {
+			return false;
+		}
+		p++;
+		while (p < end && *p != '"') {
+			if (*p != '\\') {
+				out += *p++;
+				continue;
+			}
+			if (++p >= end) {
+				return false;
+			}
+			char escaped = *p++;
+			switch (escaped) {
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u': {
+				if (end - p < 4) {
+					return false;
+				}
+				unsigned int code = (unsigned int)std::strtoul(std::string(p, 4).c_str(), nullptr, 16);
+				p += 4;
+				// basic plane only, written as UTF-8
+				if (code < 0x80) {
+					out += (char)code;
+				}
+				else if (code < 0x800) {
+					out += (char)(0xC0 | (code >> 6));
+					out += (char)(0x80 | (code & 0x3F));
+				}
+				else {
+					out += (char)(0xE0 | (code >> 12));
+					out += (char)(0x80 | ((code >> 6) & 0x3F));
+					out += (char)(0x80 | (code & 0x3F));
+				}
+				break;
+			}
+			default: out += escaped; break;
+			}
+		}
+		return p < end && *p++ == '"';
+	}
+};
+
+inline bool parseJson(const char* begin, const char* end, JsonValue& root) {
+	return JsonParser(begin, end).parse(root);
+}
+
+// a buffer of a glTF file: a view into the GLB chunk or a mapped .bin, or
+// bytes decoded from a data URI
+struct GltfBuffer {
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+	MappedFile file;
+	std::vector<unsigned char> decoded;
+};
+
+inline bool decodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& out) {
+	auto sextet = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+' || c == '-') return 62;
+		if (c == '/' || c == '_') return 63;
+		return -1;
+	};
+	uint32_t bits = 0;
+	int count = 0;
+	for (size_t i = start; i < text.size() && text[i] != '='; i++) {
+		int value = sextet(text[i]);
+		if (value < 0) {
+			return false;
+		}
+		bits = (bits << 6) | (uint32_t)value;
+		count += 6;
+		if (count >= 8) {
+			count -= 8;
+			out.push_back((unsigned char)(bits >> count));
+		}
+	}
+	return true;
+}
+
+// strided view of an accessor's elements inside its buffer
+struct GltfAccessor {
+	const unsigned char* data = nullptr;
+	size_t count = 0;
+	size_t stride = 0;
+	int componentType = 0;
+	int components = 0;
+	bool normalized = false;
+};
+
+inline int gltfComponentSize(int componentType) {
+	switch (componentType) {
+	case 5120: case 5121:	return 1;	// BYTE, UNSIGNED_BYTE
+	case 5122: case 5123:	return 2;	// SHORT, UNSIGNED_SHORT
+	case 5125: case 5126:	return 4;	// UNSIGNED_INT, FLOAT
+	default:				return 0;
+	}
+}
+
+inline int gltfComponents(const std::string& type) {
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+	return 0;
+}
+
+inline bool resolveGltfAccessor(const JsonValue& gltf, const std::vector<GltfBuffer>& buffers, int index, GltfAccessor& view) {
+	const JsonValue* accessors = gltf.find("accessors");
+	const JsonValue* bufferViews = gltf.find("bufferViews");
+	if (!accessors || index < 0 || index >= (int)accessors->items.size() || !bufferViews) {
+		return false;
+	}
+	const JsonValue& accessor = accessors->items[index];
+	int bufferViewIndex = accessor.intOr("bufferView", -1);
+	const JsonValue* type = accessor.find("type");
+	if (bufferViewIndex < 0 || bufferViewIndex >= (int)bufferViews->items.size() || accessor.find("sparse") || !type) {
+		std::cout << "ERROR::MESH_IMPORT::GLTF_ACCESSOR_UNSUPPORTED " << index << std::endl;
+		return false;
+	}
+	const JsonValue& bufferView = bufferViews->items[bufferViewIndex];
+	int bufferIndex = bufferView.intOr("buffer", -1);
+	if (bufferIndex < 0 || bufferIndex >= (int)buffers.size()) {
+		return false;
+	}
+
+	view.componentType = accessor.intOr("componentType", 0);
+	view.components = gltfComponents(type->string);
+	view.count = (size_t)accessor.numberOr("count", 0);
+	const JsonValue* normalized = accessor.find("normalized");
+	view.normalized = normalized && normalized->boolean;
+	size_t elementSize = (size_t)gltfComponentSize(view.componentType) * view.components;
+	view.stride = (size_t)bufferView.numberOr("byteStride", 0);
+	if (view.stride == 0) {
+		view.stride = elementSize;
+	}
+	size_t offset = (size_t)bufferView.numberOr("byteOffset", 0) + (size_t)accessor.numberOr("byteOffset", 0);
+	size_t viewEnd = (size_t)bufferView.numberOr("byteOffset", 0) + (size_t)bufferView.numberOr("byteLength", 0);
+	const GltfBuffer& buffer = buffers[bufferIndex];
+	if (elementSize == 0 || (view.count > 0 && offset + (view.count - 1) * view.stride + elementSize > std::min(viewEnd, buffer.size))) {
+		std::cout << "ERROR::MESH_IMPORT::GLTF_ACCESSOR_OUT_OF_RANGE " << index << std::endl;
+		return false;
+	}
+	view.data = buffer.data + offset;
+	return true;
+}
+
+// component of an accessor element as a float, normalized integers mapped to [0, 1] / [-1, 1]
+inline float readGltfComponent(const unsigned char* p, int componentType, bool normalized) {
+	switch (componentType) {
+	case 5126: { float v; std::memcpy(&v, p, 4); return v; }
+	case 5120: { int8_t v; std::memcpy(&v, p, 1); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+	case 5121: { uint8_t v = *p; return normalized ? v / 255.0f : v; }
+	case 5122: { int16_t v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+	case 5123: { uint16_t v; std::memcpy(&v, p, 2); return normalized ? v / 65535.0f : v; }
+	case 5125: { uint32_t v; std::memcpy(&v, p, 4); return (float)v; }
+	default: return 0.0f;
+	}
+}
+
+template <typename Layout, typename Attr>
+inline void readGltfAttribute(const GltfAccessor& view, ImportedMesh& mesh, size_t firstVertex) {
+	if (Layout::template indexOf<Attr>() < 0) {
+		return;
+	}
+	int componentSize = gltfComponentSize(view.componentType);
+	int components = std::min(view.components, 4);
+	for (size_t i = 0; i < view.count; i++) {
+		const unsigned char* element = view.data + i * view.stride;
+		float values[4];
+		if (view.componentType == 5126) {
+			std::memcpy(values, element, components * sizeof(float));
+		}
+		else {
+			for (int c = 0; c < components; c++) {
+				values[c] = readGltfComponent(element + c * componentSize, view.componentType, view.normalized);
+			}
+		}
+		writeAttribute<Layout, Attr>(&mesh.vertices[(firstVertex + i) * Layout::stride], values, components);
+	}
+}
+
+// reads every triangle primitive of every mesh of a parsed glTF document into
+// one mesh, in mesh space; node transforms, skins and morph targets are ignored
+template <typename Layout>
+bool readGltf(const JsonValue& gltf, const std::vector<GltfBuffer>& buffers, ImportedMesh& mesh) {
+	const JsonValue* meshes = gltf.find("meshes");
+	if (!meshes) {
+		std::cout << "ERROR::MESH_IMPORT::GLTF_NO_MESHES" << std::endl;
+		return false;
+	}
+	for (const JsonValue& source : meshes->items) {
+		const JsonValue* primitives = source.find("primitives");
+		if (!primitives) {
+			continue;
+		}
+		for (const JsonValue& primitive : primitives->items) {
+			const JsonValue* attributes = primitive.find("attributes");
+			if (primitive.intOr("mode", 4) != 4 || !attributes || !attributes->find("POSITION")) {
+				std::cout << "WARNING::MESH_IMPORT::GLTF_PRIMITIVE_SKIPPED not an indexed triangle list with positions" << std::endl;
+				continue;
+			}
+
+			GltfAccessor positions;
+			if (!resolveGltfAccessor(gltf, buffers, attributes->intOr("POSITION", -1), positions) || positions.components != 3) {
+				return false;
+			}
+			size_t firstVertex = mesh.vertexCount;
+			mesh.vertexCount += positions.count;
+			mesh.vertices.resize(mesh.vertexCount * Layout::stride);
+			readGltfAttribute<Layout, Position3f>(positions, mesh, firstVertex);
+			for (size_t i = 0; i < positions.count; i++) {
+				float position[3];
+				for (int c = 0; c < 3; c++) {
+					position[c] = readGltfComponent(positions.data + i * positions.stride + c * gltfComponentSize(positions.componentType),
+						positions.componentType, positions.normalized);
+				}
+				growBounds(mesh, position);
+			}
+
+			GltfAccessor view;
+			if (attributes->find("NORMAL") && resolveGltfAccessor(gltf, buffers, attributes->intOr("NORMAL", -1), view) && view.count == positions.count) {
+				readGltfAttribute<Layout, Normal3f>(view, mesh, firstVertex);
+				mesh.hasNormals = true;
+			}
+			if (attributes->find("TEXCOORD_0") && resolveGltfAccessor(gltf, buffers, attributes->intOr("TEXCOORD_0", -1), view) && view.count == positions.count) {
+				readGltfAttribute<Layout, TexCoord2f>(view, mesh, firstVertex);
+				mesh.hasTexCoords = true;
+			}
+			if (attributes->find("COLOR_0") && resolveGltfAccessor(gltf, buffers, attributes->intOr("COLOR_0", -1), view) && view.count == positions.count) {
+				readGltfAttribute<Layout, Color3f>(view, mesh, firstVertex);
+				mesh.hasColors = true;
+			}
+
+			// primitives without indices draw their vertices in order
+			if (primitive.find("indices")) {
+				GltfAccessor indices;
+				if (!resolveGltfAccessor(gltf, buffers, primitive.intOr("indices", -1), indices) || indices.components != 1) {
+					return false;
+				}
+				int indexSize = gltfComponentSize(indices.componentType);
+				size_t first = mesh.indices.size();
+				mesh.indices.resize(first + indices.count);
+				for (size_t i = 0; i < indices.count; i++) {
+					const unsigned char* element = indices.data + i * indices.stride;
+					uint32_t index = indexSize == 1 ? *element : indexSize == 2 ? (uint32_t)(element[0] | element[1] << 8)
+						: (uint32_t)(element[0] | element[1] << 8 | element[2] << 16 | (uint32_t)element[3] << 24);
+					if (index >= positions.count) {
+						std::cout << "ERROR::MESH_IMPORT::GLTF_INDEX_OUT_OF_RANGE " << index << std::endl;
+						return false;
+					}
+					mesh.indices[first + i] = (uint32_t)firstVertex + index;
+				}
+			}
+			else {
+				for (size_t i = 0; i < positions.count; i++) {
+					mesh.indices.push_back((uint32_t)(firstVertex + i));
+				}
+			}
+		}
+	}
+	finishBounds(mesh);
+	return !mesh.indices.empty();
+}
+
+// imports a .gltf with external or embedded buffers, or a binary .glb
+template <typename Layout>
+bool importGltf(const std::string& path, ImportedMesh& mesh) {
+	MappedFile file(path);
+	if (!file.isOpen()) {
+		return false;
+	}
+	resetImportedMesh(mesh, Layout::stride, file.size());
+
+	const char* jsonBegin = file.begin();
+	const char* jsonEnd = file.end();
+	const unsigned char* binChunk = nullptr;
+	size_t binSize = 0;
+
+	// GLB: 12 byte header, then a JSON chunk and an optional BIN chunk
+	if (file.size() >= 20 && std::memcmp(file.data(), "glTF", 4) == 0) {
+		auto word = [&](size_t offset) {
+			uint32_t value;
+			std::memcpy(&value, file.data() + offset, 4);
+			return value;
+		};
+		uint32_t jsonLength = word(12);
+		if (word(16) != 0x4E4F534A || 20 + (size_t)jsonLength > file.size()) {
+			std::cout << "ERROR::MESH_IMPORT::GLB_MALFORMED " << path << std::endl;
+			return false;
+		}
+		jsonBegin = file.begin() + 20;
+		jsonEnd = jsonBegin + jsonLength;
+		size_t binHeader = 20 + ((jsonLength + 3) & ~3u);
+		if (binHeader + 8 <= file.size() && word(binHeader + 4) == 0x004E4942) {
+			binSize = std::min<size_t>(word(binHeader), file.size() - binHeader - 8);
+			binChunk = file.data() + binHeader + 8;
+		}
+	}
+
+	JsonValue gltf;
+	if (!parseJson(jsonBegin, jsonEnd, gltf)) {
+		std::cout << "ERROR::MESH_IMPORT::GLTF_JSON_MALFORMED " << path << std::endl;
+		return false;
+	}
+
+	std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+	const JsonValue* bufferList = gltf.find("buffers");
+	std::vector<GltfBuffer> buffers(bufferList ? bufferList->items.size() : 0);
+	for (size_t b = 0; b < buffers.size(); b++) {
+		const JsonValue* uri = bufferList->items[b].find("uri");
+		GltfBuffer& buffer = buffers[b];
+		if (!uri) {
+			// the GLB's own chunk
+			buffer.data = binChunk;
+			buffer.size = binChunk ? binSize : 0;
+		}
+		else if (uri->string.compare(0, 5, "data:") == 0) {
+			size_t comma = uri->string.find(',');
+			if (comma == std::string::npos || !decodeBase64(uri->string, comma + 1, buffer.decoded)) {
+				std::cout << "ERROR::MESH_IMPORT::GLTF_DATA_URI_MALFORMED " << b << std::endl;
+				return false;
+			}
+			buffer.data = buffer.decoded.data();
+			buffer.size = buffer.decoded.size();
+		}
+		else {
+			if (!buffer.file.open(directory + uri->string)) {
+				return false;
+			}
+			buffer.data = buffer.file.data();
+			buffer.size = buffer.file.size();
+			mesh.sourceBytes += buffer.size;
+		}
+	}
+	return readGltf<Layout>(gltf, buffers, mesh);
+}
+
+// picks the importer from the file extension
+template <typename Layout>
+bool importMesh(const std::string& path, ImportedMesh& mesh) {
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	if (extension == "obj") {
+		return importObj<Layout>(path, mesh);
+	}
+	if (extension == "gltf" || extension == "glb") {
+		return importGltf<Layout>(path, mesh);
+	}
+	std::cout << "ERROR::MESH_IMPORT::UNKNOWN_FORMAT " << path << std::endl;
+	return false;
+}
+
+#endif
@@ -0,0 +1,362 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// vertex cache efficiency of an index buffer, simulated with a FIFO cache
+struct VertexCacheStats {
+	float acmr = 0.0f;		// average cache misses per triangle, 0.5 is ideal for regular grids, 3 is worst
+	float atvr = 0.0f;		// average transformed vertices per vertex, 1 is ideal
+	size_t misses = 0;
+};
+
+struct MeshOptimizationReport {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+};
+
+// index data in the smallest type glDrawElements accepts for the vertex count
+struct PackedIndices {
+	GLenum type = GL_UNSIGNED_INT;
+	size_t count = 0;
+	std::vector<unsigned char> data;
+};
+
+inline VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, int cacheSize = 16) {
+	VertexCacheStats stats;
+	std::vector<size_t> insertedAt(vertexCount, 0);	// miss counter value when each vertex entered the cache
+	for (unsigned int index : indices) {
+		// a vertex is cached while fewer than cacheSize misses happened since it was inserted
+		if (insertedAt[index] == 0 || stats.misses + 1 - insertedAt[index] > (size_t)cacheSize) {
+			stats.misses++;
+			insertedAt[index] = stats.misses;
+		}
+	}
+
+	size_t triangles = indices.size() / 3;
+	stats.acmr = triangles ? (float)stats.misses / triangles : 0.0f;
+	stats.atvr = vertexCount ? (float)stats.misses / vertexCount : 0.0f;
+	return stats;
+}
+
+// picks GL_UNSIGNED_SHORT whenever every index fits in 16 bits
+inline PackedIndices packIndices(const unsigned int* indices, size_t count, size_t vertexCount) {
+	PackedIndices packed;
+	packed.count = count;
+	if (vertexCount <= 65536) {
+		packed.type = GL_UNSIGNED_SHORT;
+		packed.data.resize(count * sizeof(uint16_t));
+		uint16_t* out = (uint16_t*)packed.data.data();
+		for (size_t i = 0; i < count; i++) {
+			out[i] = (uint16_t)indices[i];
+		}
+	}
+	else {
+		packed.type = GL_UNSIGNED_INT;
+		packed.data.resize(count * sizeof(uint32_t));
+		std::memcpy(packed.data.data(), indices, packed.data.size());
+	}
+	return packed;
+}
+
+// merges bitwise identical vertices and remaps the indices; vertices must not
+// contain uninitialized padding
+template <typename Vertex>
+size_t weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+	size_t tableSize = 1;
+	while (tableSize < vertices.size() * 2) {
+		tableSize *= 2;
+	}
+	std::vector<unsigned int> table(tableSize, ~0u);
+	std::vector<unsigned int> remap(vertices.size());
+	std::vector<Vertex> unique;
+	unique.reserve(vertices.size());
+
+	for (size_t v = 0; v < vertices.size(); v++) {
+		// FNV-1a over the vertex bytes
+		const unsigned char* bytes = (const unsigned char*)&vertices[v];
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t b = 0; b < sizeof(Vertex); b++) {
+			hash = (hash ^ bytes[b]) * 1099511628211ull;
+		}
+
+		size_t slot = hash & (tableSize - 1);
+		while (table[slot] != ~0u && std::memcmp(&unique[table[slot]], &vertices[v], sizeof(Vertex)) != 0) {
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == ~0u) {
+			table[slot] = (unsigned int)unique.size();
+			unique.push_back(vertices[v]);
+		}
+		remap[v] = table[slot];
+	}
+
+	for (unsigned int& index : indices) {
+		index = remap[index];
+	}
+	vertices.swap(unique);
+	return vertices.size();
+}
+
+// reorders triangles for the post transform vertex cache using Tom Forsyth's
+// linear-speed vertex cache optimisation
+inline std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount) {
+	const int CACHE_SIZE = 32;
+	size_t triangleCount = indices.size() / 3;
+
+	// triangles using each vertex
+	std::vector<unsigned int> activeCount(vertexCount, 0);
+	for (unsigned int index : indices) {
+		activeCount[index]++;
+	}
+	std::vector<unsigned int> firstTriangle(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) {
+		firstTriangle[v + 1] = firstTriangle[v] + activeCount[v];
+	}
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> filled(vertexCount, 0);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			adjacency[firstTriangle[v] + filled[v]++] = (unsigned int)t;
+		}
+	}
+
+	auto vertexScore = [&](int cachePosition, unsigned int remaining) {
+		if (remaining == 0) {
+			return -1.0f;
+		}
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			// the last triangle's vertices get a fixed score so it is not simply repeated
+			score = cachePosition < 3 ? 0.75f
+				: std::pow(1.0f - (float)(cachePosition - 3) / (CACHE_SIZE - 3), 1.5f);
+		}
+		// favour vertices with few triangles left so they are finished off
+		return score + 2.0f / std::sqrt((float)remaining);
+	};
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> score(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		score[v] = vertexScore(-1, activeCount[v]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> cache, nextCache;
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	size_t cursor = 0;
+	long long best = triangleCount ? 0 : -1;
+
+	while (best >= 0) {
+		emitted[best] = true;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[best * 3 + k];
+			result.push_back(v);
+
+			// drop the triangle from the vertex's active list
+			unsigned int* begin = &adjacency[firstTriangle[v]];
+			unsigned int* end = begin + activeCount[v];
+			*std::find(begin, end, (unsigned int)best) = *(end - 1);
+			activeCount[v]--;
+		}
+
+		// move the triangle's vertices to the front of the cache
+		nextCache.assign(indices.begin() + best * 3, indices.begin() + best * 3 + 3);
+		for (unsigned int v : cache) {
+			if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2]) {
+				nextCache.push_back(v);
+			}
+		}
+		for (size_t i = CACHE_SIZE; i < nextCache.size(); i++) {
+			cachePosition[nextCache[i]] = -1;
+			score[nextCache[i]] = vertexScore(-1, activeCount[nextCache[i]]);
+		}
+		if (nextCache.size() > (size_t)CACHE_SIZE) {
+			nextCache.resize(CACHE_SIZE);
+		}
+		cache.swap(nextCache);
+
+		// rescore cached vertices and pick the best triangle touching them
+		for (size_t i = 0; i < cache.size(); i++) {
+			cachePosition[cache[i]] = (int)i;
+			score[cache[i]] = vertexScore((int)i, activeCount[cache[i]]);
+		}
+		best = -1;
+		float bestScore = -1.0f;
+		for (unsigned int v : cache) {
+			for (unsigned int a = 0; a < activeCount[v]; a++) {
+				unsigned int t = adjacency[firstTriangle[v] + a];
+				triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		// nothing adjacent left, continue with the next unemitted triangle
+		if (best < 0) {
+			while (cursor < triangleCount && emitted[cursor]) {
+				cursor++;
+			}
+			best = cursor < triangleCount ? (long long)cursor : -1;
+		}
+	}
+	return result;
+}
+
+// reorders clusters of a cache optimized index buffer so outward facing
+// clusters are drawn first and occlude the rest, keeping the cache efficiency
+// within threshold of the input (meshoptimizer style overdraw optimization)
+inline std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int>& indices, const float* positions,
+	size_t positionStride, size_t vertexCount, float threshold = 1.05f) {
+	const int CACHE_SIZE = 16;
+	size_t triangleCount = indices.size() / 3;
+	size_t stride = positionStride / sizeof(float);
+
+	// clusters are simulated with a cold cache, since after sorting any cluster
+	// may follow any other. a new one starts as soon as the current cluster is
+	// within threshold of the input's efficiency, and wherever the cache restarts anyway
+	VertexCacheStats whole = analyzeVertexCache(indices, vertexCount, CACHE_SIZE);
+	std::vector<size_t> clusterStart;
+	std::vector<size_t> insertedAt(vertexCount, 0);
+	size_t misses = 0, clusterBase = 0, clusterTriangles = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		int triangleMisses = 0;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			if (insertedAt[v] <= clusterBase || misses + 1 - insertedAt[v] > (size_t)CACHE_SIZE) {
+				misses++;
+				insertedAt[v] = misses;
+				triangleMisses++;
+			}
+		}
+
+		if (t == 0 || triangleMisses == 3) {
+			clusterStart.push_back(t);
+			clusterTriangles = 0;
+			clusterBase = misses - triangleMisses;
+		}
+		clusterTriangles++;
+
+		// cold starts cost a full cache of misses, so require a few triangles per vertex slot
+		if (clusterTriangles >= (size_t)CACHE_SIZE && (float)(misses - clusterBase) / clusterTriangles <= whole.acmr * threshold
+			&& t + 1 < triangleCount) {
+			clusterStart.push_back(t + 1);
+			clusterTriangles = 0;
+			clusterBase = misses;
+		}
+	}
+	// a restart right after a soft split would leave an empty cluster
+	clusterStart.erase(std::unique(clusterStart.begin(), clusterStart.end()), clusterStart.end());
+	clusterStart.push_back(triangleCount);
+
+	// area weighted centroid of the whole mesh
+	double meshCentroid[3] = { 0, 0, 0 }, meshArea = 0.0;
+	std::vector<double> triangleArea(triangleCount);
+	std::vector<float> triangleNormal(triangleCount * 3), triangleCentroid(triangleCount * 3);
+	for (size_t t = 0; t < triangleCount; t++) {
+		const float* a = positions + indices[t * 3] * stride;
+		const float* b = positions + indices[t * 3 + 1] * stride;
+		const float* c = positions + indices[t * 3 + 2] * stride;
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+		triangleArea[t] = area;
+		meshArea += area;
+		for (int k = 0; k < 3; k++) {
+			triangleNormal[t * 3 + k] = n[k];	// length is twice the area, so sums are area weighted
+			triangleCentroid[t * 3 + k] = (a[k] + b[k] + c[k]) / 3.0f;
+			meshCentroid[k] += triangleCentroid[t * 3 + k] * area;
+		}
+	}
+	for (int k = 0; k < 3; k++) {
+		meshCentroid[k] = meshArea > 0.0 ? meshCentroid[k] / meshArea : 0.0;
+	}
+
+	// sort clusters by how much they face away from the mesh center
+	size_t clusterCount = clusterStart.size() - 1;
+	std::vector<float> sortKey(clusterCount);
+	std::vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) {
+		double centroid[3] = { 0, 0, 0 }, normal[3] = { 0, 0, 0 }, area = 0.0;
+		for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+			for (int k = 0; k < 3; k++) {
+				centroid[k] += triangleCentroid[t * 3 + k] * triangleArea[t];
+				normal[k] += triangleNormal[t * 3 + k];
+			}
+			area += triangleArea[t];
+		}
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		double key = 0.0;
+		for (int k = 0; k < 3; k++) {
+			double offset = (area > 0.0 ? centroid[k] / area : 0.0) - meshCentroid[k];
+			key += offset * (length > 0.0 ? normal[k] / length : 0.0);
+		}
+		sortKey[c] = (float)key;
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (size_t c : order) {
+		result.insert(result.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+	}
+	return result;
+}
+
+// reorders vertices by first use so vertex fetch reads memory sequentially;
+// vertices no index refers to are dropped
+template <typename Vertex>
+size_t optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+	std::vector<unsigned int> remap(vertices.size(), ~0u);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+	for (unsigned int& index : indices) {
+		if (remap[index] == ~0u) {
+			remap[index] = (unsigned int)ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(ordered);
+	return vertices.size();
+}
+
+// welds, reorders for the vertex cache, then for overdraw, then for vertex fetch.
+// positions are read as three floats positionOffset bytes into each vertex
+template <typename Vertex>
+MeshOptimizationReport optimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+	size_t positionOffset = 0, float overdrawThreshold = 1.05f) {
+	MeshOptimizationReport report;
+	report.verticesBefore = vertices.size();
+	report.before = analyzeVertexCache(indices, vertices.size());
+
+	weldVertices(vertices, indices);
+	indices = optimizeVertexCache(indices, vertices.size());
+	const float* positions = (const float*)((const unsigned char*)vertices.data() + positionOffset);
+	indices = optimizeOverdraw(indices, positions, sizeof(Vertex), vertices.size(), overdrawThreshold);
+	optimizeVertexFetch(vertices, indices);
+
+	report.verticesAfter = vertices.size();
+	report.after = analyzeVertexCache(indices, vertices.size());
+	return report;
+}
+
+#endif
@@ -0,0 +1,455 @@
+#ifndef MESH_POOL_H
+#define MESH_POOL_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// two level segregated fit allocator over an abstract range of units. free
+// blocks are binned by the power of two of their size and 16 linear steps
+// within it, so allocate and free are constant time and fragmentation stays low
+class TlsfAllocator {
+public:
+	static const uint32_t INVALID = ~0u;
+
+	explicit TlsfAllocator(uint32_t capacity) : totalSize(capacity), freeSize(capacity) {
+		for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+			for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+				heads[fl][sl] = INVALID;
+			}
+			slBitmap[fl] = 0;
+		}
+		if (capacity > 0) {
+			uint32_t block = newBlock(0, capacity);
+			insertFree(block);
+		}
+	}
+
+	// returns a block id whose offset() holds size units, or INVALID
+	uint32_t allocate(uint32_t size) {
+		if (size == 0) {
+			size = 1;
+		}
+		uint32_t fl, sl;
+		mappingSearch(size, fl, sl);
+		uint32_t block = findFree(fl, sl);
+		if (block == INVALID) {
+			// rounding up skips the bin size itself falls in, whose blocks can
+			// still be large enough, e.g. one spanning the whole arena
+			block = findFitInBin(size);
+			if (block == INVALID) {
+				return INVALID;
+			}
+		}
+		removeFree(block);
+
+		// return the tail to the free lists
+		if (blocks[block].size > size) {
+			uint32_t rest = newBlock(blocks[block].offset + size, blocks[block].size - size);
+			blocks[rest].prevPhysical = block;
+			blocks[rest].nextPhysical = blocks[block].nextPhysical;
+			if (blocks[block].nextPhysical != INVALID) {
+				blocks[blocks[block].nextPhysical].prevPhysical = rest;
+			}
+			blocks[block].nextPhysical = rest;
+			blocks[block].size = size;
+			insertFree(rest);
+		}
+		freeSize -= size;
+		return block;
+	}
+
+	// frees a block and merges it with free neighbours
+	void free(uint32_t block) {
+		if (block == INVALID || blocks[block].isFree) {
+			return;
+		}
+		freeSize += blocks[block].size;
+
+		uint32_t next = blocks[block].nextPhysical;
+		if (next != INVALID && blocks[next].isFree) {
+			removeFree(next);
+			absorbNext(block);
+		}
+		uint32_t prev = blocks[block].prevPhysical;
+		if (prev != INVALID && blocks[prev].isFree) {
+			removeFree(prev);
+			absorbNext(prev);
+			block = prev;
+		}
+		insertFree(block);
+	}
+
+	uint32_t offset(uint32_t block) const {
+		return blocks[block].offset;
+	}
+
+	uint32_t size(uint32_t block) const {
+		return blocks[block].size;
+	}
+
+	uint32_t capacity() const {
+		return totalSize;
+	}
+
+	uint32_t freeSpace() const {
+		return freeSize;
+	}
+
+private:
+	static const uint32_t SL_LOG = 4;
+	static const uint32_t SL_COUNT = 1 << SL_LOG;
+	static const uint32_t FL_COUNT = 32;
+
+	struct Block {
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		uint32_t prevPhysical = INVALID, nextPhysical = INVALID;
+		uint32_t prevFree = INVALID, nextFree = INVALID;
+		bool isFree = false;
+	};
+
+	std::vector<Block> blocks;
+	std::vector<uint32_t> recycled;		// ids of blocks merged away
+	uint32_t flBitmap = 0;
+	uint32_t slBitmap[FL_COUNT];
+	uint32_t heads[FL_COUNT][SL_COUNT];
+	uint32_t totalSize;
+	uint32_t freeSize;
+
+	static uint32_t highestBit(uint32_t value) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		return index;
+#else
+		return 31 - __builtin_clz(value);
+#endif
+	}
+
+	static uint32_t lowestBit(uint32_t value) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+#else
+		return __builtin_ctz(value);
+#endif
+	}
+
+	// sizes below SL_COUNT share the first level, above it each power of two
+	// range is split into SL_COUNT equal bins
+	static void mapping(uint32_t size, uint32_t& fl, uint32_t& sl) {
+		if (size < SL_COUNT) {
+			fl = 0;
+			sl = size;
+		}
+		else {
+			uint32_t top = highestBit(size);
+			sl = (size >> (top - SL_LOG)) ^ SL_COUNT;
+			fl = top - SL_LOG + 1;
+		}
+	}
+
+	// rounds up to the next bin so any block found there is large enough
+	static void mappingSearch(uint32_t size, uint32_t& fl, uint32_t& sl) {
+		if (size >= SL_COUNT) {
+			uint32_t round = (1u << (highestBit(size) - SL_LOG)) - 1;
+			size = size > ~0u - round ? ~0u : size + round;
+		}
+		mapping(size, fl, sl);
+	}
+
+	uint32_t findFree(uint32_t& fl, uint32_t& sl) const {
+		uint32_t slMap = slBitmap[fl] & (~0u << sl);
+		if (slMap == 0) {
+			uint32_t flMap = fl + 1 < FL_COUNT ? flBitmap & (~0u << (fl + 1)) : 0;
+			if (flMap == 0) {
+				return INVALID;
+			}
+			fl = lowestBit(flMap);
+			slMap = slBitmap[fl];
+		}
+		sl = lowestBit(slMap);
+		return heads[fl][sl];
+	}
+
+	// first block at least size large in the bin size maps to
+	uint32_t findFitInBin(uint32_t size) const {
+		uint32_t fl, sl;
+		mapping(size, fl, sl);
+		for (uint32_t block = heads[fl][sl]; block != INVALID; block = blocks[block].nextFree) {
+			if (blocks[block].size >= size) {
+				return block;
+			}
+		}
+		return INVALID;
+	}
+
+	uint32_t newBlock(uint32_t offset, uint32_t size) {
+		uint32_t id;
+		if (!recycled.empty()) {
+			id = recycled.back();
+			recycled.pop_back();
+			blocks[id] = Block();
+		}
+		else {
+			id = (uint32_t)blocks.size();
+			blocks.emplace_back();
+		}
+		blocks[id].offset = offset;
+		blocks[id].size = size;
+		return id;
+	}
+
+	void insertFree(uint32_t block) {
+		uint32_t fl, sl;
+		mapping(blocks[block].size, fl, sl);
+		blocks[block].isFree = true;
+		blocks[block].prevFree = INVALID;
+		blocks[block].nextFree = heads[fl][sl];
+		if (heads[fl][sl] != INVALID) {
+			blocks[heads[fl][sl]].prevFree = block;
+		}
+		heads[fl][sl] = block;
+		flBitmap |= 1u << fl;
+		slBitmap[fl] |= 1u << sl;
+	}
+
+	void removeFree(uint32_t block) {
+		uint32_t fl, sl;
+		mapping(blocks[block].size, fl, sl);
+		Block& b = blocks[block];
+		if (b.prevFree != INVALID) {
+			blocks[b.prevFree].nextFree = b.nextFree;
+		}
+		else {
+			heads[fl][sl] = b.nextFree;
+		}
+		if (b.nextFree != INVALID) {
+			blocks[b.nextFree].prevFree = b.prevFree;
+		}
+		if (heads[fl][sl] == INVALID) {
+			slBitmap[fl] &= ~(1u << sl);
+			if (slBitmap[fl] == 0) {
+				flBitmap &= ~(1u << fl);
+			}
+		}
+		b.isFree = false;
+		b.prevFree = b.nextFree = INVALID;
+	}
+
+	// merges the physically next block into block
+	void absorbNext(uint32_t block) {
+		uint32_t next = blocks[block].nextPhysical;
+		blocks[block].size += blocks[next].size;
+		blocks[block].nextPhysical = blocks[next].nextPhysical;
+		if (blocks[next].nextPhysical != INVALID) {
+			blocks[blocks[next].nextPhysical].prevPhysical = block;
+		}
+		recycled.push_back(next);
+	}
+};
+
+// where a mesh lives inside a MeshPool
+struct MeshAllocation {
+	int page = -1;
+	uint32_t vertexBlock = TlsfAllocator::INVALID;
+	uint32_t indexBlock = TlsfAllocator::INVALID;
+	GLint baseVertex = 0;
+	uint32_t firstIndex = 0;
+	GLsizei indexCount = 0;
+
+	bool valid() const {
+		return page >= 0;
+	}
+};
+
+struct MeshPoolStats {
+	unsigned int pages = 0;
+	unsigned int meshes = 0;
+	size_t vertexBytesUsed = 0;
+	size_t indexBytesUsed = 0;
+	size_t bytesReserved = 0;
+	unsigned int bindsThisFrame = 0;	// glBindVertexArray calls issued
+	unsigned int drawsThisFrame = 0;
+};
+
+// packs many meshes of one vertex Layout into a few large vertex and index
+// buffers. each page is a VBO, an EBO and the single VAO reading them; meshes
+// keep their own 0 based indices and are drawn with glDrawElementsBaseVertex,
+// so drawing any number of meshes of a page takes one VAO bind
+template <typename Layout>
+class MeshPool {
+public:
+	MeshPool(uint32_t verticesPerPage = 1 << 20, uint32_t indicesPerPage = 3 << 20, unsigned int program = 0)
+		: verticesPerPage(verticesPerPage), indicesPerPage(indicesPerPage), program(program) {}
+
+	~MeshPool() {
+		clear();
+	}
+
+	MeshPool(const MeshPool&) = delete;
+	MeshPool& operator=(const MeshPool&) = delete;
+
+	// copies a mesh into the first page with room for it, opening at most one
+	// new page when none has; vertices are laid out as Layout describes.
+	// returns an invalid allocation when even an empty page cannot hold it
+	MeshAllocation add(const void* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount) {
+		MeshAllocation mesh;
+		if (vertexCount > verticesPerPage || indexCount > indicesPerPage) {
+			std::cout << "ERROR::MESH_POOL::MESH_TOO_LARGE " << vertexCount << " vertices, "
+				<< indexCount << " indices" << std::endl;
+			return mesh;
+		}
+
+		for (size_t p = 0; p < pages.size() && !mesh.valid(); p++) {
+			place((int)p, vertexCount, indexCount, mesh);
+		}
+		if (!mesh.valid()) {
+			addPage();
+			if (!place((int)pages.size() - 1, vertexCount, indexCount, mesh)) {
+				std::cout << "ERROR::MESH_POOL::ALLOCATION_FAILED " << vertexCount << " vertices, "
+					<< indexCount << " indices do not fit an empty page" << std::endl;
+				return mesh;
+			}
+		}
+
+		// the element buffer is VAO state, so it is written through the page's VAO
+		Page& page = pages[mesh.page];
+		bind(mesh.page);
+		glBindBuffer(GL_ARRAY_BUFFER, page.VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)mesh.baseVertex * Layout::stride, (GLsizeiptr)vertexCount * Layout::stride, vertices);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)mesh.firstIndex * sizeof(unsigned int), (GLsizeiptr)indexCount * sizeof(unsigned int), indices);
+
+		stats.meshes++;
+		stats.vertexBytesUsed += (size_t)vertexCount * Layout::stride;
+		stats.indexBytesUsed += (size_t)indexCount * sizeof(unsigned int);
+		return mesh;
+	}
+
+	// releases a mesh's space for reuse
+	void remove(MeshAllocation& mesh) {
+		if (!mesh.valid()) {
+			return;
+		}
+		Page& page = pages[mesh.page];
+		stats.vertexBytesUsed -= (size_t)page.vertices.size(mesh.vertexBlock) * Layout::stride;
+		stats.indexBytesUsed -= (size_t)page.indices.size(mesh.indexBlock) * sizeof(unsigned int);
+		stats.meshes--;
+		page.vertices.free(mesh.vertexBlock);
+		page.indices.free(mesh.indexBlock);
+		mesh = MeshAllocation();
+	}
+
+	// binds a page's VAO unless it is already bound
+	void bind(int page) {
+		if (page != boundPage) {
+			glBindVertexArray(pages[page].VAO);
+			boundPage = page;
+			stats.bindsThisFrame++;
+		}
+	}
+
+	void draw(const MeshAllocation& mesh, GLenum mode = GL_TRIANGLES) {
+		if (!mesh.valid()) {
+			return;
+		}
+		bind(mesh.page);
+		glDrawElementsBaseVertex(mode, mesh.indexCount, GL_UNSIGNED_INT,
+			(void*)((size_t)mesh.firstIndex * sizeof(unsigned int)), mesh.baseVertex);
+		stats.drawsThisFrame++;
+	}
+
+	// resets the per frame counters and forgets the bound VAO, since other code
+	// may have bound its own in between frames
+	void beginFrame() {
+		stats.bindsThisFrame = 0;
+		stats.drawsThisFrame = 0;
+		boundPage = -1;
+	}
+
+	int pageCount() const {
+		return (int)pages.size();
+	}
+
+	MeshPoolStats getStats() const {
+		MeshPoolStats result = stats;
+		result.pages = (unsigned int)pages.size();
+		result.bytesReserved = pages.size() * ((size_t)verticesPerPage * Layout::stride + (size_t)indicesPerPage * sizeof(unsigned int));
+		return result;
+	}
+
+	// deletes every page; must be called while the GL context is still alive
+	void clear() {
+		for (Page& page : pages) {
+			glDeleteVertexArrays(1, &page.VAO);
+			glDeleteBuffers(1, &page.VBO);
+			glDeleteBuffers(1, &page.EBO);
+		}
+		pages.clear();
+		boundPage = -1;
+		stats = MeshPoolStats();
+	}
+
+private:
+	struct Page {
+		unsigned int VAO = 0, VBO = 0, EBO = 0;
+		TlsfAllocator vertices;
+		TlsfAllocator indices;
+
+		Page(uint32_t vertexCount, uint32_t indexCount) : vertices(vertexCount), indices(indexCount) {}
+	};
+
+	uint32_t verticesPerPage;
+	uint32_t indicesPerPage;
+	unsigned int program;
+	std::vector<Page> pages;
+	int boundPage = -1;
+	MeshPoolStats stats;
+
+	// takes space for a mesh in page, filling in mesh on success
+	bool place(int p, uint32_t vertexCount, uint32_t indexCount, MeshAllocation& mesh) {
+		Page& page = pages[p];
+		uint32_t vertexBlock = page.vertices.allocate(vertexCount);
+		if (vertexBlock == TlsfAllocator::INVALID) {
+			return false;
+		}
+		uint32_t indexBlock = page.indices.allocate(indexCount);
+		if (indexBlock == TlsfAllocator::INVALID) {
+			page.vertices.free(vertexBlock);
+			return false;
+		}
+
+		mesh.page = p;
+		mesh.vertexBlock = vertexBlock;
+		mesh.indexBlock = indexBlock;
+		mesh.baseVertex = (GLint)page.vertices.offset(vertexBlock);
+		mesh.firstIndex = page.indices.offset(indexBlock);
+		mesh.indexCount = (GLsizei)indexCount;
+		return true;
+	}
+
+	void addPage() {
+		pages.emplace_back(verticesPerPage, indicesPerPage);
+		Page& page = pages.back();
+		glGenVertexArrays(1, &page.VAO);
+		glGenBuffers(1, &page.VBO);
+		glGenBuffers(1, &page.EBO);
+
+		glBindVertexArray(page.VAO);
+		boundPage = (int)pages.size() - 1;
+		glBindBuffer(GL_ARRAY_BUFFER, page.VBO);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)verticesPerPage * Layout::stride, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indicesPerPage * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+		Layout::setup(page.VBO, program);
+	}
+};
+
+#endif
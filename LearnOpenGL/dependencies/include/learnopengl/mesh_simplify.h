@@ -0,0 +1,347 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "mesh_optimizer.h"
+
+struct SimplifyOptions {
+	const float* attributes = nullptr;	// optional per vertex floats compared on collapse, e.g. normals or uvs
+	int attributeCount = 0;				// floats compared per vertex
+	size_t attributeStride = 0;			// bytes from one vertex's attributes to the next, 0 when tightly packed
+	float attributeWeight = 1.0f;		// squared attribute distance to squared world units
+	bool lockBorder = true;				// keep open edges and attribute seams in place
+	float maxError = FLT_MAX;			// world units, collapses above it are not done
+};
+
+// one level of detail inside a LodChain's index buffer
+struct MeshLod {
+	unsigned int firstIndex = 0;
+	unsigned int indexCount = 0;
+	float error = 0.0f;		// world units the surface may be off by, relative to LOD 0
+
+	// byte offset for glDrawElements in a buffer of the given index type
+	void* offset(GLenum indexType) const {
+		return (void*)(size_t)(firstIndex * (indexType == GL_UNSIGNED_SHORT ? 2 : 4));
+	}
+};
+
+// every LOD of a mesh, sharing one vertex buffer and one index buffer; LOD 0
+// is the full resolution mesh and each next one is coarser
+struct LodChain {
+	std::vector<unsigned int> indices;
+	std::vector<MeshLod> lods;
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+};
+
+// symmetric 4x4 plane quadric, sum of squared distances to planes weighted by area
+struct Quadric {
+	double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+	double a11 = 0, a12 = 0, a13 = 0;
+	double a22 = 0, a23 = 0;
+	double a33 = 0;
+	double weight = 0;
+
+	static Quadric fromPlane(double a, double b, double c, double d, double w) {
+		Quadric q;
+		q.a00 = w * a * a; q.a01 = w * a * b; q.a02 = w * a * c; q.a03 = w * a * d;
+		q.a11 = w * b * b; q.a12 = w * b * c; q.a13 = w * b * d;
+		q.a22 = w * c * c; q.a23 = w * c * d;
+		q.a33 = w * d * d;
+		q.weight = w;
+		return q;
+	}
+
+	void add(const Quadric& q) {
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+		weight += q.weight;
+	}
+
+	// weighted sum of squared distances from p to the planes
+	double evaluate(const float* p) const {
+		double x = p[0], y = p[1], z = p[2];
+		double result = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+			+ a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+			+ a22 * z * z + 2 * a23 * z
+			+ a33;
+		return result > 0.0 ? result : 0.0;
+	}
+};
+
+// collapses edges onto existing vertices until at most targetIndexCount indices
+// remain or no collapse stays under options.maxError. vertices are never moved,
+// so the result indexes the same vertex buffer. positions are three floats,
+// positionStride bytes apart; error receives the largest error in world units
+inline std::vector<unsigned int> simplifyMesh(const std::vector<unsigned int>& indices, const float* positions,
+	size_t positionStride, size_t vertexCount, size_t targetIndexCount, const SimplifyOptions& options = SimplifyOptions(),
+	float* error = nullptr) {
+	size_t stride = positionStride / sizeof(float);
+	std::vector<unsigned int> result(indices);
+	double maxCost = 0.0;
+	double maxAllowed = (double)options.maxError * options.maxError;
+	size_t attributeStride = options.attributeStride != 0 ? options.attributeStride / sizeof(float) : (size_t)options.attributeCount;
+
+	auto position = [&](unsigned int v) { return positions + v * stride; };
+	auto normal = [&](const float* a, const float* b, const float* c, double* n) {
+		double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	};
+
+	// vertices sharing a position with another vertex sit on an attribute seam
+	std::vector<bool> locked(vertexCount, false);
+	if (options.lockBorder) {
+		std::unordered_map<uint64_t, unsigned int> firstAtPosition;
+		for (size_t v = 0; v < vertexCount; v++) {
+			uint32_t bits[3];
+			std::memcpy(bits, position((unsigned int)v), sizeof(bits));
+			uint64_t key = ((uint64_t)bits[0] * 73856093u) ^ ((uint64_t)bits[1] * 19349663u << 21) ^ ((uint64_t)bits[2] * 83492791u << 42);
+			auto inserted = firstAtPosition.emplace(key, (unsigned int)v);
+			if (!inserted.second && std::memcmp(position(inserted.first->second), position((unsigned int)v), sizeof(bits)) == 0) {
+				locked[v] = true;
+				locked[inserted.first->second] = true;
+			}
+		}
+
+		// edges used by a single triangle are on the border
+		std::unordered_map<uint64_t, int> edgeUses;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = result[i + k], b = result[i + (k + 1) % 3];
+				edgeUses[(uint64_t)std::min(a, b) << 32 | std::max(a, b)]++;
+			}
+		}
+		for (const auto& edge : edgeUses) {
+			if (edge.second == 1) {
+				locked[edge.first >> 32] = true;
+				locked[edge.first & 0xffffffffu] = true;
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		const float* a = position(result[i]);
+		double n[3];
+		normal(a, position(result[i + 1]), position(result[i + 2]), n);
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length <= 0.0) {
+			continue;
+		}
+		double area = length * 0.5;
+		for (int k = 0; k < 3; k++) {
+			n[k] /= length;
+		}
+		Quadric plane = Quadric::fromPlane(n[0], n[1], n[2], -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]), area);
+		for (int k = 0; k < 3; k++) {
+			quadrics[result[i + k]].add(plane);
+		}
+	}
+
+	struct Collapse {
+		unsigned int from, to;
+		double cost;
+	};
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> remap(vertexCount), firstTriangle(vertexCount + 1), adjacency, filled(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	// each pass picks the cheapest collapses that do not touch the same triangles
+	while (result.size() > targetIndexCount) {
+		collapses.clear();
+		// interior edges appear once in each direction across their two triangles
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int from = result[i + k], to = result[i + (k + 1) % 3];
+				if (locked[from]) {
+					continue;
+				}
+				Quadric q = quadrics[from];
+				q.add(quadrics[to]);
+				double cost = q.weight > 0.0 ? q.evaluate(position(to)) / q.weight : 0.0;
+				for (int c = 0; c < options.attributeCount; c++) {
+					double delta = options.attributes[from * attributeStride + c] - options.attributes[to * attributeStride + c];
+					cost += options.attributeWeight * delta * delta;
+				}
+				collapses.push_back({ from, to, cost });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.cost < b.cost || (a.cost == b.cost && (a.from < b.from || (a.from == b.from && a.to < b.to)));
+		});
+
+		// triangles around each vertex
+		std::fill(firstTriangle.begin(), firstTriangle.end(), 0);
+		for (unsigned int v : result) {
+			firstTriangle[v + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++) {
+			firstTriangle[v + 1] += firstTriangle[v];
+		}
+		adjacency.resize(result.size());
+		std::fill(filled.begin(), filled.end(), 0);
+		for (size_t i = 0; i < result.size(); i++) {
+			adjacency[firstTriangle[result[i]] + filled[result[i]]++] = (unsigned int)(i / 3);
+		}
+
+		for (size_t v = 0; v < vertexCount; v++) {
+			remap[v] = (unsigned int)v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		// a collapse removes about two triangles
+		size_t trianglesLeft = result.size() / 3;
+		size_t targetTriangles = targetIndexCount / 3;
+		size_t applied = 0;
+		for (const Collapse& collapse : collapses) {
+			if (trianglesLeft <= targetTriangles || collapse.cost > maxAllowed) {
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to]) {
+				continue;
+			}
+
+			// reject collapses that flip a remaining triangle
+			bool flips = false;
+			int removed = 0;
+			for (unsigned int a = firstTriangle[collapse.from]; a < firstTriangle[collapse.from + 1] && !flips; a++) {
+				const unsigned int* triangle = &result[adjacency[a] * 3];
+				if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+					removed++;
+					continue;
+				}
+				const float* before[3], * after[3];
+				for (int k = 0; k < 3; k++) {
+					before[k] = position(triangle[k]);
+					after[k] = position(triangle[k] == collapse.from ? collapse.to : triangle[k]);
+				}
+				double n0[3], n1[3];
+				normal(before[0], before[1], before[2], n0);
+				normal(after[0], after[1], after[2], n1);
+				flips = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= 0.0;
+			}
+			if (flips) {
+				continue;
+			}
+
+			// neighbours keep their triangles unchanged for the rest of the pass
+			for (unsigned int a = firstTriangle[collapse.from]; a < firstTriangle[collapse.from + 1]; a++) {
+				for (int k = 0; k < 3; k++) {
+					touched[result[adjacency[a] * 3 + k]] = true;
+				}
+			}
+			touched[collapse.to] = true;
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to].add(quadrics[collapse.from]);
+			maxCost = std::max(maxCost, collapse.cost);
+			trianglesLeft -= std::min(trianglesLeft, (size_t)removed);
+			applied++;
+		}
+		if (applied == 0) {
+			break;
+		}
+
+		// drop triangles that became degenerate
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if (a != b && b != c && a != c) {
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+		}
+		result.resize(write);
+	}
+
+	if (error) {
+		*error = (float)std::sqrt(maxCost);
+	}
+	return result;
+}
+
+// simplifies each LOD from the previous one until maxLevels are built, the
+// triangle count drops below minTriangles or the simplifier stops making
+// progress; every level is reordered for the vertex cache
+inline LodChain buildLodChain(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+	size_t vertexCount, const SimplifyOptions& options = SimplifyOptions(), int maxLevels = 6, float ratio = 0.5f,
+	size_t minTriangles = 64) {
+	LodChain chain;
+	size_t stride = positionStride / sizeof(float);
+
+	// bounding sphere around the box center, used by the LOD selector
+	float minPos[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, maxPos[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (unsigned int v : indices) {
+		for (int c = 0; c < 3; c++) {
+			minPos[c] = std::min(minPos[c], positions[v * stride + c]);
+			maxPos[c] = std::max(maxPos[c], positions[v * stride + c]);
+		}
+	}
+	for (int c = 0; c < 3 && !indices.empty(); c++) {
+		chain.center[c] = (minPos[c] + maxPos[c]) * 0.5f;
+	}
+	for (unsigned int v : indices) {
+		float dx = positions[v * stride] - chain.center[0];
+		float dy = positions[v * stride + 1] - chain.center[1];
+		float dz = positions[v * stride + 2] - chain.center[2];
+		chain.radius = std::max(chain.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+	}
+
+	std::vector<unsigned int> level = optimizeVertexCache(indices, vertexCount);
+	float error = 0.0f;
+	for (int l = 0; l < maxLevels; l++) {
+		MeshLod lod;
+		lod.firstIndex = (unsigned int)chain.indices.size();
+		lod.indexCount = (unsigned int)level.size();
+		lod.error = error;
+		chain.lods.push_back(lod);
+		chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+
+		size_t target = (size_t)(level.size() / 3 * ratio) * 3;
+		if (target / 3 < minTriangles) {
+			break;
+		}
+		float levelError = 0.0f;
+		std::vector<unsigned int> next = simplifyMesh(level, positions, positionStride, vertexCount, target, options, &levelError);
+		if (next.empty() || next.size() > level.size() * 9 / 10) {
+			break;
+		}
+		// errors of consecutive levels add up at worst
+		error += levelError;
+		level = optimizeVertexCache(next, vertexCount);
+	}
+	return chain;
+}
+
+// size in pixels of a world space error seen from distance with a vertical field of view
+inline float projectedError(float error, float distance, float fovY, int screenHeight) {
+	return error / (std::max(distance, 1e-4f) * std::tan(fovY * 0.5f)) * screenHeight * 0.5f;
+}
+
+// coarsest LOD whose error stays under maxPixelError on screen. distance is
+// measured to the chain's center, its nearest point is radius closer
+inline int selectLod(const LodChain& chain, float distance, float fovY, int screenHeight, float maxPixelError = 1.0f) {
+	float nearest = distance - chain.radius;
+	for (int l = (int)chain.lods.size() - 1; l > 0; l--) {
+		if (nearest > 0.0f && projectedError(chain.lods[l].error, nearest, fovY, screenHeight) <= maxPixelError) {
+			return l;
+		}
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frustum.h"
+
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+// small cluster of a mesh's triangles, culled as a whole. its triangles index
+// its own vertex list, which holds indices into the mesh's vertex buffer
+struct Meshlet {
+	unsigned int vertexOffset = 0;		// first entry in MeshletMesh::vertices
+	unsigned int triangleOffset = 0;	// first entry in MeshletMesh::triangles
+	unsigned int vertexCount = 0;
+	unsigned int triangleCount = 0;
+
+	// bounding sphere
+	float center[3] = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+
+	// every triangle faces away from a camera inside the cone with this apex and
+	// axis whose half angle has cosine cutoff; a cutoff of 1 never culls
+	float coneApex[3] = { 0.0f, 0.0f, 0.0f };
+	float coneAxis[3] = { 0.0f, 0.0f, 1.0f };
+	float coneCutoff = 1.0f;
+};
+
+struct MeshletMesh {
+	std::vector<Meshlet> meshlets;
+	std::vector<unsigned int> vertices;		// mesh vertex of each meshlet vertex
+	std::vector<unsigned char> triangles;	// three meshlet vertices per triangle
+	size_t indexCount = 0;					// of the source mesh, the most cullMeshlets can emit
+};
+
+struct MeshletCullStats {
+	unsigned int meshlets = 0;
+	unsigned int frustumCulled = 0;
+	unsigned int backfaceCulled = 0;
+	size_t triangles = 0;			// in the whole mesh
+	size_t trianglesEmitted = 0;
+};
+
+// bounding sphere and normal cone of a finished meshlet, after meshoptimizer's
+// cluster bounds: the axis is the mean of the triangle normals, and the apex
+// sits behind every triangle's plane along it
+inline void computeMeshletBounds(Meshlet& meshlet, const MeshletMesh& mesh, const float* positions, size_t stride) {
+	auto position = [&](unsigned int local) {
+		return positions + mesh.vertices[meshlet.vertexOffset + local] * stride;
+	};
+
+	float minPos[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, maxPos[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (unsigned int v = 0; v < meshlet.vertexCount; v++) {
+		for (int c = 0; c < 3; c++) {
+			minPos[c] = std::min(minPos[c], position(v)[c]);
+			maxPos[c] = std::max(maxPos[c], position(v)[c]);
+		}
+	}
+	for (int c = 0; c < 3; c++) {
+		meshlet.center[c] = (minPos[c] + maxPos[c]) * 0.5f;
+	}
+	meshlet.radius = 0.0f;
+	for (unsigned int v = 0; v < meshlet.vertexCount; v++) {
+		float dx = position(v)[0] - meshlet.center[0], dy = position(v)[1] - meshlet.center[1], dz = position(v)[2] - meshlet.center[2];
+		meshlet.radius = std::max(meshlet.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+	}
+
+	// unit triangle normals, degenerate triangles left out
+	std::vector<float> normals;
+	std::vector<const float*> corners;
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+	for (unsigned int t = 0; t < meshlet.triangleCount; t++) {
+		const unsigned char* triangle = &mesh.triangles[meshlet.triangleOffset + t * 3];
+		const float* p0 = position(triangle[0]);
+		const float* p1 = position(triangle[1]);
+		const float* p2 = position(triangle[2]);
+		float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0f) {
+			continue;
+		}
+		for (int c = 0; c < 3; c++) {
+			normals.push_back(n[c] / length);
+			axis[c] += n[c] / length;
+		}
+		corners.push_back(p0);
+	}
+
+	meshlet.coneCutoff = 1.0f;
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (corners.empty() || axisLength == 0.0f) {
+		return;
+	}
+	for (int c = 0; c < 3; c++) {
+		meshlet.coneAxis[c] = axis[c] / axisLength;
+	}
+
+	float minDot = 1.0f;
+	for (size_t t = 0; t < corners.size(); t++) {
+		const float* n = &normals[t * 3];
+		minDot = std::min(minDot, n[0] * meshlet.coneAxis[0] + n[1] * meshlet.coneAxis[1] + n[2] * meshlet.coneAxis[2]);
+	}
+	// normals spread over (nearly) a half space can't be culled as one
+	if (minDot <= 0.1f) {
+		return;
+	}
+
+	// furthest point behind the center along the axis that lies behind every plane
+	float maxT = 0.0f;
+	for (size_t t = 0; t < corners.size(); t++) {
+		const float* n = &normals[t * 3];
+		float toCenter = (meshlet.center[0] - corners[t][0]) * n[0] + (meshlet.center[1] - corners[t][1]) * n[1]
+			+ (meshlet.center[2] - corners[t][2]) * n[2];
+		float alongAxis = n[0] * meshlet.coneAxis[0] + n[1] * meshlet.coneAxis[1] + n[2] * meshlet.coneAxis[2];
+		maxT = std::max(maxT, toCenter / alongAxis);
+	}
+	for (int c = 0; c < 3; c++) {
+		meshlet.coneApex[c] = meshlet.center[c] - meshlet.coneAxis[c] * maxT;
+	}
+	// sin of the spread: the view direction must be within 90 degrees minus the spread of the axis
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+// splits an indexed triangle list into meshlets of at most maxVertices
+// vertices and maxTriangles triangles. each meshlet grows from a seed triangle
+// by adding the neighbouring triangle that brings the fewest new vertices,
+// ties going to the one facing closest to the meshlet's mean normal, so
+// meshlets come out compact and their normal cones narrow
+inline MeshletMesh buildMeshlets(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+	size_t vertexCount, size_t maxVertices = MESHLET_MAX_VERTICES, size_t maxTriangles = MESHLET_MAX_TRIANGLES) {
+	MeshletMesh mesh;
+	mesh.indexCount = indices.size();
+	size_t stride = positionStride / sizeof(float);
+	size_t triangleCount = indices.size() / 3;
+	// local indices are bytes
+	maxVertices = std::min<size_t>(std::max<size_t>(maxVertices, 3), 255);
+	maxTriangles = std::max<size_t>(maxTriangles, 1);
+
+	// triangles around each vertex
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (unsigned int v : indices) {
+		adjacencyOffset[v + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++) {
+		adjacencyOffset[v + 1] += adjacencyOffset[v];
+	}
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++) {
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+
+	std::vector<float> normals(triangleCount * 3, 0.0f);
+	for (size_t t = 0; t < triangleCount; t++) {
+		const float* p0 = positions + indices[t * 3] * stride;
+		const float* p1 = positions + indices[t * 3 + 1] * stride;
+		const float* p2 = positions + indices[t * 3 + 2] * stride;
+		float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		for (int c = 0; c < 3 && length > 0.0f; c++) {
+			normals[t * 3 + c] = n[c] / length;
+		}
+	}
+
+	std::vector<bool> used(triangleCount, false);
+	std::vector<int> localIndex(vertexCount, -1);	// meshlet vertex of each mesh vertex, for the open meshlet
+	std::vector<unsigned int> candidates;
+	size_t seed = 0;
+
+	Meshlet meshlet;
+	float normalSum[3] = { 0.0f, 0.0f, 0.0f };
+
+	auto finish = [&]() {
+		if (meshlet.triangleCount == 0) {
+			return;
+		}
+		computeMeshletBounds(meshlet, mesh, positions, stride);
+		mesh.meshlets.push_back(meshlet);
+		for (unsigned int v = 0; v < meshlet.vertexCount; v++) {
+			localIndex[mesh.vertices[meshlet.vertexOffset + v]] = -1;
+		}
+		meshlet = Meshlet();
+		meshlet.vertexOffset = (unsigned int)mesh.vertices.size();
+		meshlet.triangleOffset = (unsigned int)mesh.triangles.size();
+		normalSum[0] = normalSum[1] = normalSum[2] = 0.0f;
+		candidates.clear();
+	};
+
+	auto newVertices = [&](unsigned int triangle) {
+		int count = 0;
+		for (int k = 0; k < 3; k++) {
+			count += localIndex[indices[triangle * 3 + k]] < 0;
+		}
+		return count;
+	};
+
+	auto addTriangle = [&](unsigned int triangle) {
+		used[triangle] = true;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[triangle * 3 + k];
+			if (localIndex[v] < 0) {
+				localIndex[v] = (int)meshlet.vertexCount++;
+				mesh.vertices.push_back(v);
+				for (unsigned int a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; a++) {
+					if (!used[adjacency[a]]) {
+						candidates.push_back(adjacency[a]);
+					}
+				}
+			}
+			mesh.triangles.push_back((unsigned char)localIndex[v]);
+		}
+		for (int c = 0; c < 3; c++) {
+			normalSum[c] += normals[triangle * 3 + c];
+		}
+		meshlet.triangleCount++;
+	};
+
+	for (size_t placed = 0; placed < triangleCount; placed++) {
+		// best neighbour of the open meshlet; dead candidates are dropped on the way
+		int best = -1, bestNew = 4;
+		float bestDot = -FLT_MAX;
+		size_t kept = 0;
+		for (size_t c = 0; c < candidates.size(); c++) {
+			unsigned int triangle = candidates[c];
+			if (used[triangle]) {
+				continue;
+			}
+			candidates[kept++] = triangle;
+			int added = newVertices(triangle);
+			const float* n = &normals[triangle * 3];
+			float facing = n[0] * normalSum[0] + n[1] * normalSum[1] + n[2] * normalSum[2];
+			if (added < bestNew || (added == bestNew && facing > bestDot)) {
+				best = (int)triangle;
+				bestNew = added;
+				bestDot = facing;
+			}
+		}
+		candidates.resize(kept);
+
+		// no neighbour left, so the meshlet restarts from the next unused triangle
+		if (best < 0) {
+			while (used[seed]) {
+				seed++;
+			}
+			best = (int)seed;
+			bestNew = newVertices(seed);
+		}
+
+		// a full meshlet is closed and the chosen neighbour seeds the next one, which
+		// keeps consecutive meshlets next to each other
+		if (meshlet.vertexCount + bestNew > maxVertices || meshlet.triangleCount + 1 > maxTriangles) {
+			finish();
+		}
+		addTriangle((unsigned int)best);
+	}
+	finish();
+	return mesh;
+}
+
+// the cone test of a meshlet; cameraPosition is in the same space as the mesh
+inline bool meshletBackfacing(const Meshlet& meshlet, const float* cameraPosition) {
+	float view[3] = { meshlet.coneApex[0] - cameraPosition[0], meshlet.coneApex[1] - cameraPosition[1], meshlet.coneApex[2] - cameraPosition[2] };
+	float length = std::sqrt(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+	float facing = view[0] * meshlet.coneAxis[0] + view[1] * meshlet.coneAxis[1] + view[2] * meshlet.coneAxis[2];
+	return facing > meshlet.coneCutoff * length;
+}
+
+// writes the mesh indices of the meshlets that survive frustum and cone culling
+// to out and returns how many there are. frustum and cameraPosition are in the
+// mesh's object space, e.g. extractFrustum of the model view projection
+inline size_t cullMeshlets(const MeshletMesh& mesh, const Frustum& frustum, const float* cameraPosition,
+	std::vector<unsigned int>& out, MeshletCullStats* stats = nullptr) {
+	MeshletCullStats result;
+	result.meshlets = (unsigned int)mesh.meshlets.size();
+	result.triangles = mesh.indexCount / 3;
+	if (out.size() < mesh.indexCount) {
+		out.resize(mesh.indexCount);
+	}
+
+	size_t written = 0;
+	for (const Meshlet& meshlet : mesh.meshlets) {
+		if (!sphereInFrustum(frustum, meshlet.center, meshlet.radius)) {
+			result.frustumCulled++;
+			continue;
+		}
+		if (meshletBackfacing(meshlet, cameraPosition)) {
+			result.backfaceCulled++;
+			continue;
+		}
+		const unsigned int* vertices = &mesh.vertices[meshlet.vertexOffset];
+		const unsigned char* triangles = &mesh.triangles[meshlet.triangleOffset];
+		for (unsigned int i = 0; i < meshlet.triangleCount * 3; i++) {
+			out[written++] = vertices[triangles[i]];
+		}
+	}
+	result.trianglesEmitted = written / 3;
+	if (stats) {
+		*stats = result;
+	}
+	return written;
+}
+
+#endif
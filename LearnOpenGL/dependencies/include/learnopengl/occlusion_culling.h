@@ -0,0 +1,255 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+struct OcclusionStats {
+	unsigned int objects = 0;		// passed to the culler this frame
+	unsigned int drawn = 0;			// visible last time they were tested, drawn normally
+	unsigned int occluded = 0;		// hidden last time they were tested, drawn under conditional render
+	unsigned int skipped = 0;		// hidden long enough that they were not submitted at all
+	unsigned int queries = 0;		// issued this frame
+	unsigned int results = 0;		// came back this frame
+	unsigned int becameVisible = 0;
+	unsigned int becameOccluded = 0;
+};
+
+// hardware occlusion culling with temporal coherence. each object keeps the
+// result of its last occlusion query and is treated accordingly this frame:
+//   visible objects are drawn as usual and, every few frames, the draw itself
+//   is wrapped in a query to find out whether they are still visible
+//   occluded objects get their bounding box drawn with a query, colour and
+//   depth writes off, after the visible objects have filled the depth buffer;
+//   the object is then drawn under glBeginConditionalRender on that query, so
+//   the GPU drops it while it stays hidden and nothing pops in the frame it
+//   reappears, all without the CPU waiting for the result
+//   objects hidden for skipAfterFrames frames in a row are not submitted at
+//   all, only their box is queried. that saves their draw calls, at the cost
+//   of showing up a frame or two late when they come back into view
+// results are collected in beginFrame once the GPU has them. a frame goes
+//     culler.beginFrame(cameraPosition);
+//     for each object: if (culler.isVisible(i)) culler.drawVisible(i, draw);
+//     culler.queryOccluded();		// the box program's camera uniforms set
+//     for each object: if (!culler.isVisible(i)) culler.drawOccluded(i, draw);
+//     culler.endFrame();
+class OcclusionCuller {
+public:
+	// boxProgram maps the unit cube attribute at location 0 into the box given
+	// by its boxMin and boxMax vec3 uniforms; the caller keeps its camera
+	// uniforms current. visible objects are queried every visibleQueryInterval
+	// frames; a skipAfterFrames of 0 always draws occluded objects conditionally
+	OcclusionCuller(unsigned int boxProgram, unsigned int visibleQueryInterval = 8, unsigned int skipAfterFrames = 4)
+		: program(boxProgram), interval(std::max(1u, visibleQueryInterval)), skipAfter(skipAfterFrames) {
+		boxMinLocation = glGetUniformLocation(program, "boxMin");
+		boxMaxLocation = glGetUniformLocation(program, "boxMax");
+
+		// unit cube, outward winding
+		const float corners[] = {
+			0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0,
+			0, 0, 1,  1, 0, 1,  1, 1, 1,  0, 1, 1
+		};
+		const unsigned char faces[] = {
+			0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+			3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5
+		};
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glBindVertexArray(0);
+	}
+
+	~OcclusionCuller() {
+		clear();
+	}
+
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	// adds an object with its world space box and returns its index. new
+	// objects count as visible until a query says otherwise
+	unsigned int addObject(const float* boxMin, const float* boxMax) {
+		Object object;
+		glGenQueries(1, &object.query);
+		objects.push_back(object);
+		unsigned int index = (unsigned int)objects.size() - 1;
+		setBounds(index, boxMin, boxMax);
+		return index;
+	}
+
+	void setBounds(unsigned int index, const float* boxMin, const float* boxMax) {
+		std::copy(boxMin, boxMin + 3, objects[index].boxMin);
+		std::copy(boxMax, boxMax + 3, objects[index].boxMax);
+	}
+
+	// collects the results the GPU has finished, without waiting for the rest.
+	// objects whose box contains the camera are always visible: their box
+	// would be clipped by the near plane and read as occluded
+	void beginFrame(const float* cameraPosition, float nearPlane = 0.1f) {
+		stats = OcclusionStats();
+		for (size_t i = 0; i < objects.size(); i++) {
+			Object& object = objects[i];
+			if (object.pending) {
+				GLuint available = 0;
+				glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (available) {
+					GLuint samples = 0;
+					glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &samples);
+					object.pending = false;
+					stats.results++;
+					bool visible = samples != 0;
+					if (visible != object.visible) {
+						(visible ? stats.becameVisible : stats.becameOccluded)++;
+					}
+					object.visible = visible;
+				}
+			}
+			bool inside = true;
+			for (int c = 0; c < 3; c++) {
+				inside = inside && cameraPosition[c] >= object.boxMin[c] - nearPlane && cameraPosition[c] <= object.boxMax[c] + nearPlane;
+			}
+			if (inside) {
+				object.visible = true;
+			}
+			if (object.visible) {
+				object.hiddenFrames = 0;
+			}
+		}
+	}
+
+	// last known visibility of the object
+	bool isVisible(unsigned int index) const {
+		return objects[index].visible;
+	}
+
+	// draws a visible object, querying the draw itself now and then; spreading
+	// the queries over frames by index keeps their number even
+	template <typename Draw>
+	void drawVisible(unsigned int index, Draw&& draw) {
+		Object& object = objects[index];
+		stats.objects++;
+		stats.drawn++;
+		bool query = !object.pending && (frame + index) % interval == 0;
+		if (query) {
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query);
+		}
+		draw();
+		if (query) {
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+			object.pending = true;
+			stats.queries++;
+		}
+	}
+
+	// draws the boxes of every occluded object without a query in flight,
+	// each inside a new query. call after the visible objects are drawn so
+	// they occlude the boxes; leaves the box program and cube bound
+	void queryOccluded() {
+		bool any = false;
+		for (size_t i = 0; i < objects.size(); i++) {
+			Object& object = objects[i];
+			if (object.visible || object.pending) {
+				continue;
+			}
+			if (!any) {
+				any = true;
+				glUseProgram(program);
+				glBindVertexArray(VAO);
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				glDepthMask(GL_FALSE);
+			}
+			glUniform3fv(boxMinLocation, 1, object.boxMin);
+			glUniform3fv(boxMaxLocation, 1, object.boxMax);
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query);
+			glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, (void*)0);
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+			object.pending = true;
+			stats.queries++;
+		}
+		if (any) {
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glDepthMask(GL_TRUE);
+		}
+	}
+
+	// draws an occluded object under conditional render on its latest box
+	// query; GL_QUERY_NO_WAIT draws it anyway if the GPU has not got there yet.
+	// objects hidden for skipAfterFrames frames are left out; returns whether
+	// draw was called
+	template <typename Draw>
+	bool drawOccluded(unsigned int index, Draw&& draw) {
+		stats.objects++;
+		if (skipAfter > 0 && objects[index].hiddenFrames >= skipAfter) {
+			stats.skipped++;
+			return false;
+		}
+		stats.occluded++;
+		glBeginConditionalRender(objects[index].query, GL_QUERY_NO_WAIT);
+		draw();
+		glEndConditionalRender();
+		return true;
+	}
+
+	// counts the frames each object has stayed hidden and moves the visible
+	// query schedule on by a frame
+	void endFrame() {
+		for (Object& object : objects) {
+			if (!object.visible && object.hiddenFrames < skipAfter) {
+				object.hiddenFrames++;
+			}
+		}
+		frame++;
+	}
+
+	OcclusionStats getStats() const {
+		return stats;
+	}
+
+	size_t size() const {
+		return objects.size();
+	}
+
+	// deletes the queries and the box mesh; must be called while the GL context is still alive
+	void clear() {
+		for (Object& object : objects) {
+			glDeleteQueries(1, &object.query);
+		}
+		objects.clear();
+		if (VAO) {
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			glDeleteBuffers(1, &EBO);
+			VAO = VBO = EBO = 0;
+		}
+	}
+
+private:
+	struct Object {
+		float boxMin[3];
+		float boxMax[3];
+		unsigned int query = 0;
+		bool visible = true;
+		bool pending = false;	// a query is in flight
+		unsigned int hiddenFrames = 0;	// frames ended while occluded, up to skipAfter
+	};
+
+	std::vector<Object> objects;
+	unsigned int program;
+	unsigned int interval;
+	unsigned int skipAfter;
+	unsigned int frame = 0;
+	GLint boxMinLocation = -1, boxMaxLocation = -1;
+	unsigned int VAO = 0, VBO = 0, EBO = 0;
+	OcclusionStats stats;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef SAMPLER_CACHE_H
+#define SAMPLER_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "gl_extensions.h"
+
+// how a texture is sampled; textures themselves carry no wrap or filter state
+struct SamplerState {
+	GLenum wrapS		= GL_REPEAT;
+	GLenum wrapT		= GL_REPEAT;
+	GLenum wrapR		= GL_REPEAT;
+	GLenum minFilter	= GL_LINEAR_MIPMAP_LINEAR;
+	GLenum magFilter	= GL_LINEAR;
+	int maxAnisotropy	= 1;		// 1 disables anisotropic filtering
+	bool depthCompare	= false;	// GL_COMPARE_REF_TO_TEXTURE with GL_LEQUAL for shadow maps
+
+	// packs the state into 32 bits so it can be hashed and compared cheaply
+	uint32_t key() const {
+		return wrapIndex(wrapS)
+			| wrapIndex(wrapT) << 2
+			| wrapIndex(wrapR) << 4
+			| filterIndex(minFilter) << 6
+			| filterIndex(magFilter) << 9
+			| (uint32_t)(maxAnisotropy & 0x1f) << 12
+			| (uint32_t)depthCompare << 17;
+	}
+
+private:
+	static uint32_t wrapIndex(GLenum wrap) {
+		switch (wrap) {
+		case GL_MIRRORED_REPEAT:	return 1;
+		case GL_CLAMP_TO_EDGE:		return 2;
+		case GL_CLAMP_TO_BORDER:	return 3;
+		default:					return 0;
+		}
+	}
+
+	static uint32_t filterIndex(GLenum filter) {
+		switch (filter) {
+		case GL_NEAREST:				return 0;
+		case GL_LINEAR:					return 1;
+		case GL_NEAREST_MIPMAP_NEAREST:	return 2;
+		case GL_LINEAR_MIPMAP_NEAREST:	return 3;
+		case GL_NEAREST_MIPMAP_LINEAR:	return 4;
+		default:						return 5;	// GL_LINEAR_MIPMAP_LINEAR
+		}
+	}
+};
+
+struct SamplerStats {
+	unsigned int samplerCount	= 0;	// distinct sampler objects created
+	unsigned int bindsThisFrame	= 0;	// glBindSampler calls issued
+	unsigned int skippedThisFrame = 0;	// binds skipped because the unit already had the sampler
+	unsigned long long totalBinds = 0;
+};
+
+// shares one sampler object (core in GL 3.3) between every texture sampled the
+// same way, so switching sampling state is a single glBindSampler per unit
+class SamplerCache {
+public:
+	SamplerCache() {
+		GLint units = 16;
+		glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &units);
+		boundSamplers.assign(units, 0);
+
+		if (hasGLExtension("GL_ARB_texture_filter_anisotropic") || hasGLExtension("GL_EXT_texture_filter_anisotropic")) {
+			float maxSupported = 1.0f;
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxSupported);
+			maxAnisotropy = (int)maxSupported;
+		}
+	}
+
+	~SamplerCache() {
+		clear();
+	}
+
+	SamplerCache(const SamplerCache&) = delete;
+	SamplerCache& operator=(const SamplerCache&) = delete;
+
+	// returns the sampler object for a state, creating it on first use
+	unsigned int get(const SamplerState& state) {
+		SamplerState clamped = state;
+		clamped.maxAnisotropy = state.maxAnisotropy < maxAnisotropy ? state.maxAnisotropy : maxAnisotropy;
+		clamped.maxAnisotropy = clamped.maxAnisotropy > 1 ? clamped.maxAnisotropy : 1;
+
+		uint32_t key = clamped.key();
+		auto found = samplers.find(key);
+		if (found != samplers.end()) {
+			return found->second;
+		}
+
+		unsigned int sampler;
+		glGenSamplers(1, &sampler);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, clamped.wrapS);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, clamped.wrapT);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, clamped.wrapR);
+		glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, clamped.minFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, clamped.magFilter);
+		if (clamped.maxAnisotropy > 1) {
+			glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, (float)clamped.maxAnisotropy);
+		}
+		if (clamped.depthCompare) {
+			glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+			glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		}
+
+		samplers[key] = sampler;
+		stats.samplerCount++;
+		return sampler;
+	}
+
+	// binds the sampler for a state to a texture unit, skipping redundant binds
+	void bind(unsigned int unit, const SamplerState& state) {
+		unsigned int sampler = get(state);
+		if (unit < boundSamplers.size() && boundSamplers[unit] == sampler) {
+			stats.skippedThisFrame++;
+			return;
+		}
+
+		glBindSampler(unit, sampler);
+		if (unit < boundSamplers.size()) {
+			boundSamplers[unit] = sampler;
+		}
+		stats.bindsThisFrame++;
+		stats.totalBinds++;
+	}
+
+	// resets the per frame counters
+	void beginFrame() {
+		stats.bindsThisFrame = 0;
+		stats.skippedThisFrame = 0;
+	}
+
+	// forgets which samplers are bound, e.g. after code outside the cache called glBindSampler
+	void invalidate() {
+		for (unsigned int& sampler : boundSamplers) {
+			sampler = 0;
+		}
+	}
+
+	// deletes every sampler; must be called while the GL context is still alive
+	void clear() {
+		for (auto& entry : samplers) {
+			glDeleteSamplers(1, &entry.second);
+		}
+		samplers.clear();
+		invalidate();
+		stats.samplerCount = 0;
+	}
+
+	int getMaxAnisotropy() const {
+		return maxAnisotropy;
+	}
+
+	const SamplerStats& getStats() const {
+		return stats;
+	}
+
+private:
+	std::unordered_map<uint32_t, unsigned int> samplers;
+	std::vector<unsigned int> boundSamplers;	// sampler bound to each texture unit
+	int maxAnisotropy = 1;
+	SamplerStats stats;
+};
+
+#endif
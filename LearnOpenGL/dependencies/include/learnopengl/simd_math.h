@@ -0,0 +1,446 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#define SIMD_MATH_AVX
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_MATH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SIMD_MATH_NEON
+#include <arm_neon.h>
+#endif
+
+// small vector math for the CPU side of rendering. the value types and
+// their operators are constexpr scalar code, usable in constant
+// expressions and simple enough for the compiler to vectorize; matrix
+// products and batch transforms, where the work is, go through SSE2, AVX
+// or NEON when the target has them, with constexpr scalar versions
+// (scalarMultiply, scalarTransform, scalarTransformPoints) kept alongside.
+// matrices are column major float[16], which glUniformMatrix4fv takes with
+// transpose GL_FALSE
+
+struct Vec3 {
+	float x, y, z;
+
+	constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+	constexpr explicit Vec3(float s) : x(s), y(s), z(s) {}
+
+	constexpr float operator[](int i) const {
+		return i == 0 ? x : i == 1 ? y : z;
+	}
+};
+
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b) {
+	return Vec3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b) {
+	return Vec3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+constexpr Vec3 operator-(const Vec3& a) {
+	return Vec3(-a.x, -a.y, -a.z);
+}
+
+constexpr Vec3 operator*(const Vec3& a, const Vec3& b) {
+	return Vec3(a.x * b.x, a.y * b.y, a.z * b.z);
+}
+
+constexpr Vec3 operator*(const Vec3& a, float s) {
+	return Vec3(a.x * s, a.y * s, a.z * s);
+}
+
+constexpr Vec3 operator*(float s, const Vec3& a) {
+	return a * s;
+}
+
+constexpr Vec3 operator/(const Vec3& a, float s) {
+	return Vec3(a.x / s, a.y / s, a.z / s);
+}
+
+constexpr float dot(const Vec3& a, const Vec3& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+constexpr Vec3 cross(const Vec3& a, const Vec3& b) {
+	return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float length(const Vec3& a) {
+	return std::sqrt(dot(a, a));
+}
+
+inline Vec3 normalize(const Vec3& a) {
+	return a * (1.0f / length(a));
+}
+
+struct alignas(16) Vec4 {
+	float x, y, z, w;
+
+	constexpr Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	constexpr Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	constexpr Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+	constexpr Vec3 xyz() const {
+		return Vec3(x, y, z);
+	}
+};
+
+constexpr Vec4 operator+(const Vec4& a, const Vec4& b) {
+	return Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+}
+
+constexpr Vec4 operator-(const Vec4& a, const Vec4& b) {
+	return Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+}
+
+constexpr Vec4 operator*(const Vec4& a, float s) {
+	return Vec4(a.x * s, a.y * s, a.z * s, a.w * s);
+}
+
+constexpr float dot(const Vec4& a, const Vec4& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+// rotation as a unit quaternion, vector part first
+struct alignas(16) Quat {
+	float x, y, z, w;
+
+	constexpr Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+	constexpr Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	// angle in radians around a unit axis
+	static Quat fromAxisAngle(const Vec3& axis, float angle) {
+		float s = std::sin(angle * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f));
+	}
+};
+
+// a * b rotates by b, then by a
+constexpr Quat operator*(const Quat& a, const Quat& b) {
+	return Quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+constexpr Quat conjugate(const Quat& q) {
+	return Quat(-q.x, -q.y, -q.z, q.w);
+}
+
+constexpr float dot(const Quat& a, const Quat& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline Quat normalize(const Quat& q) {
+	float s = 1.0f / std::sqrt(dot(q, q));
+	return Quat(q.x * s, q.y * s, q.z * s, q.w * s);
+}
+
+constexpr Vec3 rotate(const Quat& q, const Vec3& v) {
+	// v + 2 q.xyz x (q.xyz x v + w v)
+	return v + 2.0f * cross(Vec3(q.x, q.y, q.z), cross(Vec3(q.x, q.y, q.z), v) + q.w * v);
+}
+
+// spherical interpolation along the shorter arc, falling back to a
+// normalized lerp when the rotations are nearly the same
+inline Quat slerp(const Quat& a, const Quat& b, float t) {
+	float cosine = dot(a, b);
+	float sign = cosine < 0.0f ? -1.0f : 1.0f;
+	cosine *= sign;
+	float wa = 1.0f - t, wb = t * sign;
+	if (cosine < 0.9995f) {
+		float angle = std::acos(cosine);
+		float inverseSine = 1.0f / std::sin(angle);
+		wa = std::sin(wa * angle) * inverseSine;
+		wb = std::sin(t * angle) * inverseSine * sign;
+	}
+	return normalize(Quat(a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb));
+}
+
+struct alignas(16) Mat4 {
+	float m[16];	// column major, m[column * 4 + row]
+
+	// identity
+	constexpr Mat4() : m{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } {}
+	constexpr Mat4(float m0, float m1, float m2, float m3, float m4, float m5, float m6, float m7,
+		float m8, float m9, float m10, float m11, float m12, float m13, float m14, float m15)
+		: m{ m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 } {}
+
+	constexpr float operator()(int row, int column) const {
+		return m[column * 4 + row];
+	}
+
+	constexpr Vec4 column(int c) const {
+		return Vec4(m[c * 4], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3]);
+	}
+
+	// for glUniformMatrix4fv(location, 1, GL_FALSE, matrix.data())
+	const float* data() const {
+		return m;
+	}
+
+	static constexpr Mat4 translation(const Vec3& t) {
+		return Mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, t.x, t.y, t.z, 1);
+	}
+
+	static constexpr Mat4 scale(const Vec3& s) {
+		return Mat4(s.x, 0, 0, 0, 0, s.y, 0, 0, 0, 0, s.z, 0, 0, 0, 0, 1);
+	}
+
+	static constexpr Mat4 rotation(const Quat& q) {
+		return fromTrs(Vec3(), q, Vec3(1.0f));
+	}
+
+	// translation * rotation * scale
+	static constexpr Mat4 fromTrs(const Vec3& t, const Quat& q, const Vec3& s) {
+		return Mat4((1.0f - 2.0f * (q.y * q.y + q.z * q.z)) * s.x, 2.0f * (q.x * q.y + q.w * q.z) * s.x, 2.0f * (q.x * q.z - q.w * q.y) * s.x, 0.0f,
+			2.0f * (q.x * q.y - q.w * q.z) * s.y, (1.0f - 2.0f * (q.x * q.x + q.z * q.z)) * s.y, 2.0f * (q.y * q.z + q.w * q.x) * s.y, 0.0f,
+			2.0f * (q.x * q.z + q.w * q.y) * s.z, 2.0f * (q.y * q.z - q.w * q.x) * s.z, (1.0f - 2.0f * (q.x * q.x + q.y * q.y)) * s.z, 0.0f,
+			t.x, t.y, t.z, 1.0f);
+	}
+
+	// OpenGL perspective, depth -1 to 1 between the planes
+	static Mat4 perspective(float fovY, float aspect, float nearPlane, float farPlane) {
+		float f = 1.0f / std::tan(fovY * 0.5f);
+		return Mat4(f / aspect, 0, 0, 0, 0, f, 0, 0, 0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
+			0, 0, 2.0f * farPlane * nearPlane / (nearPlane - farPlane), 0);
+	}
+
+	static constexpr Mat4 orthographic(float left, float right, float bottom, float top, float nearPlane, float farPlane) {
+		return Mat4(2.0f / (right - left), 0, 0, 0, 0, 2.0f / (top - bottom), 0, 0, 0, 0, -2.0f / (farPlane - nearPlane), 0,
+			-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farPlane + nearPlane) / (farPlane - nearPlane), 1);
+	}
+
+	// view matrix of a camera at eye looking at target, right handed
+	static Mat4 lookAt(const Vec3& eye, const Vec3& target, const Vec3& up) {
+		Vec3 forward = normalize(target - eye);
+		Vec3 right = normalize(cross(forward, up));
+		Vec3 trueUp = cross(right, forward);
+		return Mat4(right.x, trueUp.x, -forward.x, 0, right.y, trueUp.y, -forward.y, 0, right.z, trueUp.z, -forward.z, 0,
+			-dot(right, eye), -dot(trueUp, eye), dot(forward, eye), 1);
+	}
+};
+
+static_assert(sizeof(Mat4) == 16 * sizeof(float), "Mat4 must upload as a plain float[16]");
+
+constexpr Mat4 transpose(const Mat4& a) {
+	return Mat4(a.m[0], a.m[4], a.m[8], a.m[12], a.m[1], a.m[5], a.m[9], a.m[13],
+		a.m[2], a.m[6], a.m[10], a.m[14], a.m[3], a.m[7], a.m[11], a.m[15]);
+}
+
+constexpr Mat4 scalarMultiply(const Mat4& a, const Mat4& b) {
+	Mat4 result;
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			result.m[c * 4 + r] = a.m[r] * b.m[c * 4] + a.m[4 + r] * b.m[c * 4 + 1] + a.m[8 + r] * b.m[c * 4 + 2] + a.m[12 + r] * b.m[c * 4 + 3];
+		}
+	}
+	return result;
+}
+
+constexpr Vec4 scalarTransform(const Mat4& a, const Vec4& v) {
+	return Vec4(a.m[0] * v.x + a.m[4] * v.y + a.m[8] * v.z + a.m[12] * v.w,
+		a.m[1] * v.x + a.m[5] * v.y + a.m[9] * v.z + a.m[13] * v.w,
+		a.m[2] * v.x + a.m[6] * v.y + a.m[10] * v.z + a.m[14] * v.w,
+		a.m[3] * v.x + a.m[7] * v.y + a.m[11] * v.z + a.m[15] * v.w);
+}
+
+// each result column is the columns of a weighted by a column of b
+inline Mat4 operator*(const Mat4& a, const Mat4& b) {
+#if defined(SIMD_MATH_SSE2)
+	Mat4 result;
+	__m128 a0 = _mm_load_ps(a.m), a1 = _mm_load_ps(a.m + 4), a2 = _mm_load_ps(a.m + 8), a3 = _mm_load_ps(a.m + 12);
+	for (int c = 0; c < 4; c++) {
+		const float* column = b.m + c * 4;
+		__m128 sum = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(column[0])), _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+		sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(column[2])), _mm_mul_ps(a3, _mm_set1_ps(column[3]))));
+		_mm_store_ps(result.m + c * 4, sum);
+	}
+	return result;
+#elif defined(SIMD_MATH_NEON)
+	Mat4 result;
+	float32x4_t a0 = vld1q_f32(a.m), a1 = vld1q_f32(a.m + 4), a2 = vld1q_f32(a.m + 8), a3 = vld1q_f32(a.m + 12);
+	for (int c = 0; c < 4; c++) {
+		const float* column = b.m + c * 4;
+		float32x4_t sum = vmulq_n_f32(a0, column[0]);
+		sum = vmlaq_n_f32(sum, a1, column[1]);
+		sum = vmlaq_n_f32(sum, a2, column[2]);
+		sum = vmlaq_n_f32(sum, a3, column[3]);
+		vst1q_f32(result.m + c * 4, sum);
+	}
+	return result;
+#else
+	return scalarMultiply(a, b);
+#endif
+}
+
+inline Vec4 operator*(const Mat4& a, const Vec4& v) {
+#if defined(SIMD_MATH_SSE2)
+	Vec4 result;
+	__m128 sum = _mm_add_ps(_mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.x)), _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.y)));
+	sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.z)), _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.w))));
+	_mm_store_ps(&result.x, sum);
+	return result;
+#elif defined(SIMD_MATH_NEON)
+	Vec4 result;
+	float32x4_t sum = vmulq_n_f32(vld1q_f32(a.m), v.x);
+	sum = vmlaq_n_f32(sum, vld1q_f32(a.m + 4), v.y);
+	sum = vmlaq_n_f32(sum, vld1q_f32(a.m + 8), v.z);
+	sum = vmlaq_n_f32(sum, vld1q_f32(a.m + 12), v.w);
+	vst1q_f32(&result.x, sum);
+	return result;
+#else
+	return scalarTransform(a, v);
+#endif
+}
+
+// point with w = 1, without the divide
+constexpr Vec3 transformPoint(const Mat4& a, const Vec3& p) {
+	return Vec3(a.m[0] * p.x + a.m[4] * p.y + a.m[8] * p.z + a.m[12],
+		a.m[1] * p.x + a.m[5] * p.y + a.m[9] * p.z + a.m[13],
+		a.m[2] * p.x + a.m[6] * p.y + a.m[10] * p.z + a.m[14]);
+}
+
+constexpr Vec3 transformDirection(const Mat4& a, const Vec3& d) {
+	return Vec3(a.m[0] * d.x + a.m[4] * d.y + a.m[8] * d.z,
+		a.m[1] * d.x + a.m[5] * d.y + a.m[9] * d.z,
+		a.m[2] * d.x + a.m[6] * d.y + a.m[10] * d.z);
+}
+
+// general inverse by cofactors; a singular matrix comes back unchanged and
+// ok, when given, is set to false
+inline Mat4 inverse(const Mat4& a, bool* ok = nullptr) {
+	const float* m = a.m;
+	Mat4 inv;
+	float* r = inv.m;
+	r[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	r[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	r[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	r[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	r[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	r[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	r[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	r[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	r[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	r[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	r[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	r[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	r[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	r[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	r[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	r[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+	float determinant = m[0] * r[0] + m[1] * r[4] + m[2] * r[8] + m[3] * r[12];
+	if (ok) {
+		*ok = determinant != 0.0f;
+	}
+	if (determinant == 0.0f) {
+		return a;
+	}
+	float scale = 1.0f / determinant;
+	for (float& value : inv.m) {
+		value *= scale;
+	}
+	return inv;
+}
+
+// inverse of rotation, scale and translation only: transposed 3x3 over the
+// squared column lengths, then the translation taken back
+inline Mat4 inverseAffine(const Mat4& a) {
+	Vec3 columns[3] = { a.column(0).xyz(), a.column(1).xyz(), a.column(2).xyz() };
+	for (Vec3& column : columns) {
+		column = column / dot(column, column);
+	}
+	Vec3 t = a.column(3).xyz();
+	return Mat4(columns[0].x, columns[1].x, columns[2].x, 0, columns[0].y, columns[1].y, columns[2].y, 0,
+		columns[0].z, columns[1].z, columns[2].z, 0, -dot(columns[0], t), -dot(columns[1], t), -dot(columns[2], t), 1);
+}
+
+// eight points as structure of arrays, the batch width of transformPoints
+struct alignas(32) Vec3x8 {
+	float x[8];
+	float y[8];
+	float z[8];
+};
+
+constexpr Vec3x8 scalarTransformPoints(const Mat4& a, const Vec3x8& p) {
+	Vec3x8 result = {};
+	for (int i = 0; i < 8; i++) {
+		Vec3 out = transformPoint(a, Vec3(p.x[i], p.y[i], p.z[i]));
+		result.x[i] = out.x;
+		result.y[i] = out.y;
+		result.z[i] = out.z;
+	}
+	return result;
+}
+
+// transforms count points held as separate x, y and z arrays, which may be
+// the output arrays; 8 at a time with AVX, 4 with SSE2 or NEON
+inline void transformPoints(const Mat4& a, const float* x, const float* y, const float* z,
+	float* outX, float* outY, float* outZ, size_t count) {
+	size_t i = 0;
+#if defined(SIMD_MATH_AVX)
+	__m256 m[12];
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 3; r++) {
+			m[c * 3 + r] = _mm256_set1_ps(a.m[c * 4 + r]);
+		}
+	}
+	for (; i + 8 <= count; i += 8) {
+		__m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+		__m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], px), _mm256_mul_ps(m[3], py)), _mm256_add_ps(_mm256_mul_ps(m[6], pz), m[9]));
+		__m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[1], px), _mm256_mul_ps(m[4], py)), _mm256_add_ps(_mm256_mul_ps(m[7], pz), m[10]));
+		__m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[2], px), _mm256_mul_ps(m[5], py)), _mm256_add_ps(_mm256_mul_ps(m[8], pz), m[11]));
+		_mm256_storeu_ps(outX + i, rx);
+		_mm256_storeu_ps(outY + i, ry);
+		_mm256_storeu_ps(outZ + i, rz);
+	}
+#elif defined(SIMD_MATH_SSE2)
+	__m128 m[12];
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 3; r++) {
+			m[c * 3 + r] = _mm_set1_ps(a.m[c * 4 + r]);
+		}
+	}
+	for (; i + 4 <= count; i += 4) {
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], px), _mm_mul_ps(m[3], py)), _mm_add_ps(_mm_mul_ps(m[6], pz), m[9]));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1], px), _mm_mul_ps(m[4], py)), _mm_add_ps(_mm_mul_ps(m[7], pz), m[10]));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2], px), _mm_mul_ps(m[5], py)), _mm_add_ps(_mm_mul_ps(m[8], pz), m[11]));
+		_mm_storeu_ps(outX + i, rx);
+		_mm_storeu_ps(outY + i, ry);
+		_mm_storeu_ps(outZ + i, rz);
+	}
+#elif defined(SIMD_MATH_NEON)
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t px = vld1q_f32(x + i), py = vld1q_f32(y + i), pz = vld1q_f32(z + i);
+		float32x4_t rx = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(a.m[12]), px, a.m[0]), py, a.m[4]), pz, a.m[8]);
+		float32x4_t ry = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(a.m[13]), px, a.m[1]), py, a.m[5]), pz, a.m[9]);
+		float32x4_t rz = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(a.m[14]), px, a.m[2]), py, a.m[6]), pz, a.m[10]);
+		vst1q_f32(outX + i, rx);
+		vst1q_f32(outY + i, ry);
+		vst1q_f32(outZ + i, rz);
+	}
+#endif
+	for (; i < count; i++) {
+		Vec3 out = transformPoint(a, Vec3(x[i], y[i], z[i]));
+		outX[i] = out.x;
+		outY[i] = out.y;
+		outZ[i] = out.z;
+	}
+}
+
+inline Vec3x8 transformPoints(const Mat4& a, const Vec3x8& p) {
+	Vec3x8 result;
+	transformPoints(a, p.x, p.y, p.z, result.x, result.y, result.z, 8);
+	return result;
+}
+
+#endif
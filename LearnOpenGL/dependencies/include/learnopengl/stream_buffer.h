@@ -0,0 +1,195 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "gl_extensions.h"
+
+// space handed out for this frame; offset is in bytes from the start of the buffer
+struct StreamAllocation {
+	void* data = nullptr;
+	size_t offset = 0;
+	size_t size = 0;
+
+	bool valid() const {
+		return data != nullptr;
+	}
+};
+
+struct StreamBufferStats {
+	bool persistent = false;			// ARB_buffer_storage mapping instead of per frame maps
+	size_t frameBytes = 0;				// bytes allocated in the current frame
+	size_t peakFrameBytes = 0;
+	unsigned int stalls = 0;			// frames that waited on the GPU for their region
+	unsigned int failedAllocations = 0;
+};
+
+// ring of frameCount regions in one buffer for data written by the CPU every
+// frame. each region is reused only once the fence of the frame that last wrote
+// it has signaled, so writes never wait on draws still in flight. with
+// ARB_buffer_storage the buffer stays mapped for its whole life, otherwise each
+// region is mapped with GL_MAP_UNSYNCHRONIZED_BIT, which is safe for the same reason
+class StreamBuffer {
+public:
+	// allowPersistent false keeps to per frame unsynchronized maps even when
+	// ARB_buffer_storage is there
+	StreamBuffer(GLenum target, size_t frameSize, int frameCount = 3, bool allowPersistent = true)
+		: target(target), frameSize(frameSize), fences(frameCount, nullptr) {
+		glGenBuffers(1, &ID);
+		glBindBuffer(target, ID);
+		size_t totalSize = frameSize * frameCount;
+
+		if (allowPersistent && glext.bufferStorage) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glext.BufferStorage(target, totalSize, nullptr, flags);
+			persistentData = (unsigned char*)glMapBufferRange(target, 0, totalSize, flags);
+		}
+		if (!persistentData) {
+			glBufferData(target, totalSize, nullptr, GL_STREAM_DRAW);
+		}
+		stats.persistent = persistentData != nullptr;
+	}
+
+	~StreamBuffer() {
+		clear();
+	}
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// moves to the next region, waiting for the GPU if it still reads it
+	void beginFrame() {
+		GLsync& fence = fences[frame];
+		if (fence) {
+			GLenum result = glClientWaitSync(fence, 0, 0);
+			if (result == GL_TIMEOUT_EXPIRED) {
+				stats.stalls++;
+				do {
+					result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+				} while (result == GL_TIMEOUT_EXPIRED);
+			}
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+		head = frame * frameSize;
+		flushed = head;
+		stats.frameBytes = 0;
+	}
+
+	// bytes allocate can still hand out this frame at a multiple of alignment
+	size_t available(size_t alignment = 16) const {
+		size_t regionEnd = (frame + 1) * frameSize;
+		size_t offset = (head + alignment - 1) / alignment * alignment;
+		return offset < regionEnd ? regionEnd - offset : 0;
+	}
+
+	// bump allocates size bytes at a multiple of alignment, which need not be a
+	// power of two so vertex data can be aligned to its stride; returns an
+	// invalid allocation when the frame's region is full
+	StreamAllocation allocate(size_t size, size_t alignment = 16) {
+		StreamAllocation allocation;
+		size_t regionEnd = (frame + 1) * frameSize;
+		size_t offset = (head + alignment - 1) / alignment * alignment;
+		if (offset + size > regionEnd) {
+			if (stats.failedAllocations++ == 0) {
+				std::cout << "ERROR::STREAM_BUFFER::OUT_OF_SPACE " << size << " bytes requested, "
+					<< regionEnd - head << " left this frame" << std::endl;
+			}
+			return allocation;
+		}
+
+		if (persistentData) {
+			allocation.data = persistentData + offset;
+		}
+		else {
+			// map the rest of the region once; flush() unmaps it before drawing
+			if (!mappedData) {
+				glBindBuffer(target, ID);
+				GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+				mappedData = (unsigned char*)glMapBufferRange(target, flushed, regionEnd - flushed, access);
+				if (!mappedData) {
+					std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+					return allocation;
+				}
+			}
+			allocation.data = mappedData + (offset - flushed);
+		}
+
+		allocation.offset = offset;
+		allocation.size = size;
+		head = offset + size;
+		stats.frameBytes = head - frame * frameSize;
+		stats.peakFrameBytes = stats.frameBytes > stats.peakFrameBytes ? stats.frameBytes : stats.peakFrameBytes;
+		return allocation;
+	}
+
+	// makes everything allocated so far visible to draws; needed between
+	// writing and drawing unless the buffer is persistently mapped
+	void flush() {
+		if (!mappedData) {
+			return;
+		}
+		glBindBuffer(target, ID);
+		glFlushMappedBufferRange(target, 0, head - flushed);
+		glUnmapBuffer(target);
+		mappedData = nullptr;
+		flushed = head;
+	}
+
+	// fences the frame's region once its draws have been issued
+	void endFrame() {
+		flush();
+		fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		frame = (frame + 1) % fences.size();
+	}
+
+	// deletes the buffer and fences; must be called while the GL context is still alive
+	void clear() {
+		if (ID == 0) {
+			return;
+		}
+		for (GLsync& fence : fences) {
+			if (fence) {
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+		}
+		if (persistentData || mappedData) {
+			glBindBuffer(target, ID);
+			glUnmapBuffer(target);
+			persistentData = nullptr;
+			mappedData = nullptr;
+		}
+		glDeleteBuffers(1, &ID);
+		ID = 0;
+	}
+
+	unsigned int buffer() const {
+		return ID;
+	}
+
+	bool isPersistent() const {
+		return stats.persistent;
+	}
+
+	StreamBufferStats getStats() const {
+		return stats;
+	}
+
+private:
+	unsigned int ID = 0;
+	GLenum target;
+	size_t frameSize;
+	std::vector<GLsync> fences;
+	size_t frame = 0;
+	size_t head = 0;			// next free byte of the current region
+	size_t flushed = 0;			// start of the current mapping
+	unsigned char* persistentData = nullptr;
+	unsigned char* mappedData = nullptr;
+	StreamBufferStats stats;
+};
+
+#endif
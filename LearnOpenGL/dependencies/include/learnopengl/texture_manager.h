@@ -0,0 +1,354 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+#include "../stb_image/stb_image.h"
+#include "hdr_image.h"
+
+// counters exposed for dashboards
+struct TextureStats {
+	size_t budgetBytes		= 0;
+	size_t residentBytes	= 0;
+	size_t peakBytes		= 0;
+	unsigned int textureCount	= 0;
+	unsigned int residentCount	= 0;
+	unsigned int evictions		= 0;	// whole textures released from video memory
+	unsigned int mipDrops		= 0;	// top mip levels released from video memory
+	unsigned int reloads		= 0;	// textures re-streamed from disk on demand
+};
+
+// owns every texture loaded from disk and keeps their combined video memory
+// below a budget by dropping the top mips, then the whole texture, of the
+// least recently used textures. evicted textures are reloaded when bound again
+class TextureManager {
+public:
+	// textures are never shrunk below this size when dropping mips
+	static const int MIN_RESIDENT_SIZE = 64;
+
+	TextureManager(size_t budgetBytes) {
+		stats.budgetBytes = budgetBytes;
+	}
+
+	~TextureManager() {
+		clear();
+	}
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	// loads an image from disk and returns a handle to it, or -1 on failure
+	int load(const std::string& path, bool flipVertically = false) {
+		Entry entry;
+		entry.path = path;
+		entry.flip = flipVertically;
+		return add(entry);
+	}
+
+	// loads an image as linear floats stored in one of the HDR formats
+	int loadHdr(const std::string& path, HdrFormat format, bool flipVertically = false) {
+		Entry entry;
+		entry.path = path;
+		entry.flip = flipVertically;
+		entry.hdr = true;
+		entry.hdrFormat = format;
+		return add(entry);
+	}
+
+	// binds a texture to a texture unit, streaming it back in if it was evicted
+	// or lost mips, and returns its GL name (0 if it could not be loaded)
+	unsigned int bind(int handle, unsigned int unit = 0) {
+		if (handle < 0 || handle >= (int)entries.size()) {
+			return 0;
+		}
+
+		Entry& entry = entries[handle];
+		if (entry.ID == 0 || entry.droppedLevels > 0) {
+			release(entry);
+			if (upload(entry)) {
+				stats.reloads++;
+			}
+		}
+		touch(handle);
+		enforceBudget();
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, entry.ID);
+		return entry.ID;
+	}
+
+	// marks the start of a frame; textures used in the current frame are never evicted
+	void beginFrame() {
+		frame++;
+	}
+
+	void setBudget(size_t budgetBytes) {
+		stats.budgetBytes = budgetBytes;
+		enforceBudget();
+	}
+
+	// deletes every texture; must be called while the GL context is still alive
+	void clear() {
+		for (Entry& entry : entries) {
+			release(entry);
+		}
+		entries.clear();
+		lru.clear();
+		stats.textureCount = 0;
+	}
+
+	const TextureStats& getStats() const {
+		return stats;
+	}
+
+	// size in video memory of a texture and its full mip chain
+	static size_t textureBytes(int width, int height, GLenum internalFormat, int levels) {
+		size_t bytes = 0;
+		for (int level = 0; level < levels; level++) {
+			bytes += (size_t)width * height * bytesPerPixel(internalFormat);
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+		return bytes;
+	}
+
+	// drivers pad three component formats to four components, so every RGB
+	// format is counted at its RGBA size. RGB9_E5 and R11F_G11F_B10F are
+	// packed into 32 bits and need no padding
+	static size_t bytesPerPixel(GLenum internalFormat) {
+		switch (internalFormat) {
+		case GL_R8:			return 1;
+		case GL_RG8:		return 2;
+		case GL_R16F:		return 2;
+		case GL_RGB8:		return 4;
+		case GL_RGBA8:		return 4;
+		case GL_SRGB8:		return 4;
+		case GL_SRGB8_ALPHA8:	return 4;
+		case GL_RGB9_E5:	return 4;
+		case GL_R11F_G11F_B10F:	return 4;
+		case GL_RGB16F:		return 8;
+		case GL_RGBA16F:	return 8;
+		case GL_RGB32F:		return 16;
+		case GL_RGBA32F:	return 16;
+		default:			return 4;
+		}
+	}
+
+	static int mipLevels(int width, int height) {
+		int levels = 1;
+		while (width > 1 || height > 1) {
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+			levels++;
+		}
+		return levels;
+	}
+
+private:
+	struct Entry {
+		std::string path;
+		bool flip = false;
+		bool hdr = false;
+		HdrFormat hdrFormat = HdrFormat::RGBA16F;
+		unsigned int ID = 0;
+		int width = 0, height = 0;		// size of the full resolution image
+		int levels = 0;					// mip levels currently resident
+		int droppedLevels = 0;			// top mip levels released by the budget
+		GLenum internalFormat = GL_RGBA8;
+		GLenum format = GL_RGBA;
+		GLenum type = GL_UNSIGNED_BYTE;
+		size_t bytes = 0;
+		unsigned long long lastUsedFrame = 0;
+		std::list<int>::iterator lru;
+	};
+
+	std::vector<Entry> entries;
+	std::list<int> lru;				// most recently used at the front
+	unsigned long long frame = 1;
+	TextureStats stats;
+
+	int add(Entry& entry) {
+		entry.lru = lru.end();
+		if (!upload(entry)) {
+			return -1;
+		}
+
+		int handle = (int)entries.size();
+		entries.push_back(entry);
+		stats.textureCount++;
+		touch(handle);
+		enforceBudget();
+		return handle;
+	}
+
+	// decodes the image and uploads it with a full mip chain
+	bool upload(Entry& entry) {
+		if (entry.hdr) {
+			return uploadHdr(entry);
+		}
+
+		int nChannels;
+		stbi_set_flip_vertically_on_load(entry.flip);
+		unsigned char* data = stbi_load(entry.path.c_str(), &entry.width, &entry.height, &nChannels, 0);
+		if (!data) {
+			std::cout << "Failed to load: " << entry.path << std::endl;
+			return false;
+		}
+
+		switch (nChannels) {
+		case 1:	 entry.internalFormat = GL_R8;	  entry.format = GL_RED;  break;
+		case 2:	 entry.internalFormat = GL_RG8;	  entry.format = GL_RG;	  break;
+		case 3:	 entry.internalFormat = GL_RGB8;  entry.format = GL_RGB;  break;
+		default: entry.internalFormat = GL_RGBA8; entry.format = GL_RGBA; break;
+		}
+		entry.type = GL_UNSIGNED_BYTE;
+
+		// wrapping and filtering come from the sampler bound alongside the texture
+		glGenTextures(1, &entry.ID);
+		glBindTexture(GL_TEXTURE_2D, entry.ID);
+
+		// rows of RGB images are not necessarily 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, entry.internalFormat, entry.width, entry.height, 0, entry.format, GL_UNSIGNED_BYTE, data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		stbi_image_free(data);
+
+		onUploaded(entry);
+		return true;
+	}
+
+	bool uploadHdr(Entry& entry) {
+		HdrImage image = loadHdrImage(entry.path, entry.flip);
+		if (!image.valid()) {
+			return false;
+		}
+
+		entry.width = image.width;
+		entry.height = image.height;
+		entry.internalFormat = hdrInternalFormat(entry.hdrFormat);
+		entry.format = entry.hdrFormat == HdrFormat::RGB9_E5 ? GL_RGB : GL_RGBA;
+		entry.type = entry.hdrFormat == HdrFormat::RGBA16F ? GL_HALF_FLOAT
+			: entry.hdrFormat == HdrFormat::RGB9_E5 ? GL_UNSIGNED_INT_5_9_9_9_REV : GL_FLOAT;
+		entry.ID = createHdrTexture(image, entry.hdrFormat);
+
+		onUploaded(entry);
+		return true;
+	}
+
+	void onUploaded(Entry& entry) {
+		entry.levels = mipLevels(entry.width, entry.height);
+		entry.droppedLevels = 0;
+		entry.bytes = textureBytes(entry.width, entry.height, entry.internalFormat, entry.levels);
+		account(entry.bytes, true);
+		stats.residentCount++;
+	}
+
+	// recreates the texture without its top mip level, keeping the smaller levels
+	// that are already in video memory
+	bool dropTopMip(Entry& entry) {
+		int width = entry.width >> (entry.droppedLevels + 1);
+		int height = entry.height >> (entry.droppedLevels + 1);
+		if (entry.levels <= 1 || width < MIN_RESIDENT_SIZE || height < MIN_RESIDENT_SIZE) {
+			return false;
+		}
+
+		unsigned int smaller;
+		glGenTextures(1, &smaller);
+		glBindTexture(GL_TEXTURE_2D, smaller);
+
+		// copy levels 1..n of the old texture into levels 0..n-1 of the new one
+		std::vector<unsigned char> pixels;
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int level = 1; level < entry.levels; level++) {
+			int w = width >> (level - 1), h = height >> (level - 1);
+			w = w > 0 ? w : 1;
+			h = h > 0 ? h : 1;
+			pixels.resize((size_t)w * h * 16);	// enough for four floats per pixel
+
+			glBindTexture(GL_TEXTURE_2D, entry.ID);
+			glGetTexImage(GL_TEXTURE_2D, level, entry.format, entry.type, pixels.data());
+			glBindTexture(GL_TEXTURE_2D, smaller);
+			glTexImage2D(GL_TEXTURE_2D, level - 1, entry.internalFormat, w, h, 0, entry.format, entry.type, pixels.data());
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		glDeleteTextures(1, &entry.ID);
+		entry.ID = smaller;
+		entry.levels--;
+		entry.droppedLevels++;
+
+		size_t bytes = textureBytes(width, height, entry.internalFormat, entry.levels);
+		account(entry.bytes - bytes, false);
+		entry.bytes = bytes;
+		stats.mipDrops++;
+		return true;
+	}
+
+	void release(Entry& entry) {
+		if (entry.ID == 0) {
+			return;
+		}
+		glDeleteTextures(1, &entry.ID);
+		entry.ID = 0;
+		account(entry.bytes, false);
+		entry.bytes = 0;
+		stats.residentCount--;
+	}
+
+	void account(size_t bytes, bool allocated) {
+		if (allocated) {
+			stats.residentBytes += bytes;
+			stats.peakBytes = stats.residentBytes > stats.peakBytes ? stats.residentBytes : stats.peakBytes;
+		}
+		else {
+			stats.residentBytes -= bytes;
+		}
+	}
+
+	void touch(int handle) {
+		Entry& entry = entries[handle];
+		if (entry.lru != lru.end()) {
+			lru.erase(entry.lru);
+		}
+		lru.push_front(handle);
+		entry.lru = lru.begin();
+		entry.lastUsedFrame = frame;
+	}
+
+	// shrinks, then evicts, least recently used textures until under budget
+	void enforceBudget() {
+		GLint boundTexture;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+
+		auto it = lru.end();
+		while (stats.residentBytes > stats.budgetBytes && it != lru.begin()) {
+			--it;
+			Entry& entry = entries[*it];
+			if (entry.lastUsedFrame == frame) {
+				break;	// everything from here on is in use this frame
+			}
+			if (entry.ID == 0) {
+				continue;
+			}
+
+			while (stats.residentBytes > stats.budgetBytes && dropTopMip(entry)) {}
+			if (stats.residentBytes > stats.budgetBytes) {
+				release(entry);
+				stats.evictions++;
+			}
+		}
+
+		if (glIsTexture(boundTexture)) {
+			glBindTexture(GL_TEXTURE_2D, boundTexture);
+		}
+	}
+};
+
+#endif
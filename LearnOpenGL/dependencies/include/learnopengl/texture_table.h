@@ -0,0 +1,200 @@
+#ifndef TEXTURE_TABLE_H
+#define TEXTURE_TABLE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../stb_image/stb_image.h"
+#include "gl_extensions.h"
+#include "texture_manager.h"
+
+// where a texture lives in the table; index() packs it into the 32 bit value
+// shaders receive per vertex or per draw
+struct TextureRef {
+	int pool = -1;
+	int layer = -1;
+
+	bool valid() const {
+		return pool >= 0;
+	}
+
+	uint32_t index() const {
+		return (uint32_t)pool << 16 | (uint32_t)layer;
+	}
+};
+
+// groups textures of equal size and internal format into GL_TEXTURE_2D_ARRAY
+// pools, so objects using different textures of a pool are drawn with one
+// bind and one draw call by selecting the layer in the shader. with
+// ARB_bindless_texture every pool also gets a handle, letting one draw reach
+// textures in any pool
+class TextureTable {
+public:
+	// length of the sampler array bindless shaders declare for the handle block
+	static const int MAX_BINDLESS_POOLS = 16;
+
+	// layers allocated per pool, clamped to GL_MAX_ARRAY_TEXTURE_LAYERS
+	TextureTable(int layersPerPool = 64) {
+		GLint maxLayers = 256;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+		poolLayers = layersPerPool < maxLayers ? layersPerPool : maxLayers;
+	}
+
+	~TextureTable() {
+		clear();
+	}
+
+	TextureTable(const TextureTable&) = delete;
+	TextureTable& operator=(const TextureTable&) = delete;
+
+	// loads an image from disk into the pool matching its size and internalFormat,
+	// which must be an 8 bit normalized or sRGB format
+	TextureRef load(const std::string& path, bool flipVertically = false, GLenum internalFormat = GL_RGBA8) {
+		int width, height, nChannels;
+		stbi_set_flip_vertically_on_load(flipVertically);
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &nChannels, 4);
+		if (!data) {
+			std::cout << "Failed to load: " << path << std::endl;
+			return TextureRef();
+		}
+
+		TextureRef ref = add(data, width, height, internalFormat);
+		stbi_image_free(data);
+		return ref;
+	}
+
+	// copies tightly packed pixels of the given format and type into the pool
+	// matching their size and internalFormat
+	TextureRef add(const void* pixels, int width, int height, GLenum internalFormat = GL_RGBA8,
+		GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE) {
+		int poolIndex = findPool(width, height, internalFormat, format, type);
+		Pool& pool = pools[poolIndex];
+
+		TextureRef ref;
+		ref.pool = poolIndex;
+		ref.layer = pool.used++;
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, pool.ID);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, ref.layer, width, height, 1, format, type, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		pool.mipsDirty = true;
+		return ref;
+	}
+
+	// binds a pool to a texture unit, regenerating its mips if layers were added
+	void bind(int pool, unsigned int unit = 0) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, pools[pool].ID);
+		if (pools[pool].mipsDirty) {
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			pools[pool].mipsDirty = false;
+		}
+	}
+
+	// creates and makes resident a bindless handle per pool; returns false when
+	// ARB_bindless_texture is unavailable or there are more pools than the
+	// handle block holds. pools with a handle are immutable, so textures added
+	// afterwards go to new pools
+	bool makeResident() {
+		if (!glext.bindlessTexture) {
+			return false;
+		}
+		if (pools.size() > MAX_BINDLESS_POOLS) {
+			std::cout << "ERROR::TEXTURE_TABLE::TOO_MANY_POOLS_FOR_BINDLESS: " << pools.size()
+				<< " pools, the handle block holds " << MAX_BINDLESS_POOLS << std::endl;
+			return false;
+		}
+
+		for (size_t i = 0; i < pools.size(); i++) {
+			Pool& pool = pools[i];
+			if (pool.handle != 0) {
+				continue;
+			}
+			bind((int)i);
+			pool.handle = glext.GetTextureHandleARB(pool.ID);
+			glext.MakeTextureHandleResidentARB(pool.handle);
+		}
+		return true;
+	}
+
+	// handles laid out as the std140 array of MAX_BINDLESS_POOLS samplers the
+	// shader declares, one 16 byte slot per pool and unused slots zeroed, ready
+	// to be copied into a uniform buffer
+	std::vector<GLuint64> handleBlock() const {
+		std::vector<GLuint64> block(MAX_BINDLESS_POOLS * 2, 0);
+		for (size_t i = 0; i < pools.size() && i < MAX_BINDLESS_POOLS; i++) {
+			block[i * 2] = pools[i].handle;
+		}
+		return block;
+	}
+
+	int poolCount() const {
+		return (int)pools.size();
+	}
+
+	// video memory of every pool including mips
+	size_t residentBytes() const {
+		size_t bytes = 0;
+		for (const Pool& pool : pools) {
+			bytes += TextureManager::textureBytes(pool.width, pool.height, pool.internalFormat, pool.levels) * poolLayers;
+		}
+		return bytes;
+	}
+
+	// deletes every pool; must be called while the GL context is still alive
+	void clear() {
+		for (Pool& pool : pools) {
+			if (pool.handle != 0) {
+				glext.MakeTextureHandleNonResidentARB(pool.handle);
+			}
+			glDeleteTextures(1, &pool.ID);
+		}
+		pools.clear();
+	}
+
+private:
+	struct Pool {
+		unsigned int ID = 0;
+		int width = 0, height = 0;
+		GLenum internalFormat = GL_RGBA8;
+		int levels = 0;
+		int used = 0;
+		bool mipsDirty = false;
+		GLuint64 handle = 0;
+	};
+
+	std::vector<Pool> pools;
+	int poolLayers;
+
+	int findPool(int width, int height, GLenum internalFormat, GLenum format, GLenum type) {
+		for (size_t i = 0; i < pools.size(); i++) {
+			const Pool& pool = pools[i];
+			if (pool.width == width && pool.height == height && pool.internalFormat == internalFormat
+				&& pool.used < poolLayers && pool.handle == 0) {
+				return (int)i;
+			}
+		}
+
+		// allocate every layer and mip level up front so layers can be added with glTexSubImage3D
+		Pool pool;
+		pool.width = width;
+		pool.height = height;
+		pool.internalFormat = internalFormat;
+		pool.levels = TextureManager::mipLevels(width, height);
+		glGenTextures(1, &pool.ID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, pool.ID);
+		for (int level = 0, w = width, h = height; level < pool.levels; level++) {
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, w, h, poolLayers, 0, format, type, NULL);
+			w = w > 1 ? w / 2 : 1;
+			h = h > 1 ? h / 2 : 1;
+		}
+
+		pools.push_back(pool);
+		return (int)pools.size() - 1;
+	}
+};
+
+#endif
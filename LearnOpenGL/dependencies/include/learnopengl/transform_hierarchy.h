@@ -0,0 +1,309 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_HIERARCHY_SSE2
+#include <emmintrin.h>
+#endif
+
+// local translation, rotation (unit quaternion) and scale of many nodes as
+// structure of arrays, with a column major world matrix per node that
+// glUniformMatrix4fv takes as is. a node's parent is always added before
+// it, so walking the nodes in index order visits parents first.
+// setters mark a node dirty and file it under its depth; update recomputes the
+// world matrices of dirty nodes and everything below them, level by level so
+// the nodes of a level can be split across threads. only those nodes are
+// visited, so a frame where little moved costs little however big the scene
+class TransformHierarchy {
+public:
+	static const unsigned int NO_PARENT = 0xffffffffu;
+
+	// adds a node with identity transform under parent, which must exist
+	unsigned int addNode(unsigned int parent = NO_PARENT) {
+		unsigned int node = (unsigned int)parents.size();
+		parents.push_back(parent);
+		depths.push_back(parent == NO_PARENT ? 0u : depths[parent] + 1);
+		for (std::vector<float>* component : { &tx, &ty, &tz, &rx, &ry, &rz }) {
+			component->push_back(0.0f);
+		}
+		for (std::vector<float>* component : { &rw, &sx, &sy, &sz }) {
+			component->push_back(1.0f);
+		}
+		world.resize(world.size() + 16, 0.0f);
+		dirty.push_back(0);
+		flagDirty(node);
+		childrenValid = false;
+		return node;
+	}
+
+	void reserve(size_t count) {
+		for (std::vector<float>* component : { &tx, &ty, &tz, &rx, &ry, &rz, &rw, &sx, &sy, &sz }) {
+			component->reserve(count);
+		}
+		parents.reserve(count);
+		depths.reserve(count);
+		world.reserve(count * 16);
+		dirty.reserve(count);
+	}
+
+	void clear() {
+		for (std::vector<float>* component : { &tx, &ty, &tz, &rx, &ry, &rz, &rw, &sx, &sy, &sz, &world }) {
+			component->clear();
+		}
+		parents.clear();
+		depths.clear();
+		dirty.clear();
+		children.clear();
+		childStarts.clear();
+		dirtyLevels.clear();
+		anyDirty = false;
+		childrenValid = false;
+	}
+
+	void setTranslation(unsigned int node, float x, float y, float z) {
+		tx[node] = x;
+		ty[node] = y;
+		tz[node] = z;
+		flagDirty(node);
+	}
+
+	void setRotation(unsigned int node, float x, float y, float z, float w) {
+		rx[node] = x;
+		ry[node] = y;
+		rz[node] = z;
+		rw[node] = w;
+		flagDirty(node);
+	}
+
+	void setScale(unsigned int node, float x, float y, float z) {
+		sx[node] = x;
+		sy[node] = y;
+		sz[node] = z;
+		flagDirty(node);
+	}
+
+	// for code that writes the component arrays directly
+	void markDirty(unsigned int node) {
+		flagDirty(node);
+	}
+
+	unsigned int getParent(unsigned int node) const {
+		return parents[node];
+	}
+
+	// column major, valid after update
+	const float* getWorldMatrix(unsigned int node) const {
+		return &world[(size_t)node * 16];
+	}
+
+	// every world matrix in node order, ready to upload in one go
+	const std::vector<float>& worldMatrices() const {
+		return world;
+	}
+
+	size_t size() const {
+		return parents.size();
+	}
+
+	// recomputes the world matrices of dirty nodes and their descendants and
+	// returns how many there were. a level whose nodes number at least
+	// MIN_NODES_PER_THREAD per thread is split across threads
+	size_t update(unsigned int threads = 0) {
+		const size_t MIN_NODES_PER_THREAD = 16384;
+		if (!anyDirty) {
+			return 0;
+		}
+		if (!childrenValid) {
+			buildChildren();
+		}
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threadFound.resize(threads);
+
+		// pending holds the nodes of one level: the children of the nodes
+		// updated on the level above, then the level's own dirty nodes
+		size_t updated = 0;
+		pending.clear();
+		for (size_t level = 0; level < dirtyLevels.size() || !pending.empty(); level++) {
+			if (level < dirtyLevels.size()) {
+				if (pending.empty()) {
+					std::swap(pending, dirtyLevels[level]);
+				}
+				else {
+					pending.insert(pending.end(), dirtyLevels[level].begin(), dirtyLevels[level].end());
+				}
+				dirtyLevels[level].clear();
+			}
+			size_t count = pending.size();
+			updated += count;
+			found.clear();
+			unsigned int levelThreads = (unsigned int)std::min<size_t>(threads, std::max<size_t>(1, count / MIN_NODES_PER_THREAD));
+			if (levelThreads <= 1) {
+				updateNodes(pending.data(), count, found);
+				std::swap(pending, found);
+				continue;
+			}
+
+			// the calling thread takes the last chunk itself
+			size_t chunk = (count + levelThreads - 1) / levelThreads;
+			auto updateChunk = [&](unsigned int t) {
+				size_t chunkBegin = std::min(count, t * chunk);
+				size_t chunkEnd = t + 1 == levelThreads ? count : std::min(count, chunkBegin + chunk);
+				threadFound[t].clear();
+				updateNodes(pending.data() + chunkBegin, chunkEnd - chunkBegin, threadFound[t]);
+			};
+			std::vector<std::thread> workers;
+			for (unsigned int t = 0; t + 1 < levelThreads; t++) {
+				workers.emplace_back(updateChunk, t);
+			}
+			updateChunk(levelThreads - 1);
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+			for (unsigned int t = 0; t < levelThreads; t++) {
+				found.insert(found.end(), threadFound[t].begin(), threadFound[t].end());
+			}
+			std::swap(pending, found);
+		}
+		anyDirty = false;
+		return updated;
+	}
+
+	// local transforms, one entry per node
+	std::vector<float> tx, ty, tz;			// translation
+	std::vector<float> rx, ry, rz, rw;		// rotation
+	std::vector<float> sx, sy, sz;			// scale
+
+private:
+	// files a node under its depth the first time it is flagged; the flag
+	// stays set until update has recomputed the node
+	void flagDirty(unsigned int node) {
+		if (dirty[node]) {
+			return;
+		}
+		dirty[node] = 1;
+		unsigned int depth = depths[node];
+		if (depth >= dirtyLevels.size()) {
+			dirtyLevels.resize(depth + 1);
+		}
+		dirtyLevels[depth].push_back(node);
+		anyDirty = true;
+	}
+
+	// groups the nodes by parent with a counting sort, keeping index order
+	// among siblings
+	void buildChildren() {
+		childStarts.assign(parents.size() + 1, 0);
+		for (unsigned int parent : parents) {
+			if (parent != NO_PARENT) {
+				childStarts[parent + 1]++;
+			}
+		}
+		for (size_t node = 1; node < childStarts.size(); node++) {
+			childStarts[node] += childStarts[node - 1];
+		}
+		children.resize(childStarts.back());
+		std::vector<size_t> next(childStarts.begin(), childStarts.end() - 1);
+		for (unsigned int node = 0; node < parents.size(); node++) {
+			if (parents[node] != NO_PARENT) {
+				children[next[parents[node]]++] = node;
+			}
+		}
+		childrenValid = true;
+	}
+
+	// recomputes count nodes of one level, clears their flags and appends
+	// their children to next. a child that is flagged already is in its own
+	// level's dirty list; the others are flagged here, and as each node has one
+	// parent no two threads ever touch the same flag
+	void updateNodes(const unsigned int* nodes, size_t count, std::vector<unsigned int>& next) {
+		for (size_t i = 0; i < count; i++) {
+			unsigned int node = nodes[i];
+			unsigned int parent = parents[node];
+			float local[16];
+			localMatrix(node, local);
+			float* out = &world[(size_t)node * 16];
+			if (parent == NO_PARENT) {
+				std::copy(local, local + 16, out);
+			}
+			else {
+				multiplyAffine(&world[(size_t)parent * 16], local, out);
+			}
+			dirty[node] = 0;
+			for (size_t c = childStarts[node]; c < childStarts[node + 1]; c++) {
+				unsigned int child = children[c];
+				if (!dirty[child]) {
+					dirty[child] = 1;
+					next.push_back(child);
+				}
+			}
+		}
+	}
+
+	// translation * rotation * scale
+	void localMatrix(unsigned int node, float* m) const {
+		float x = rx[node], y = ry[node], z = rz[node], w = rw[node];
+		float xx = x * x, yy = y * y, zz = z * z;
+		float xy = x * y, xz = x * z, yz = y * z;
+		float wx = w * x, wy = w * y, wz = w * z;
+		m[0] = (1.0f - 2.0f * (yy + zz)) * sx[node];
+		m[1] = 2.0f * (xy + wz) * sx[node];
+		m[2] = 2.0f * (xz - wy) * sx[node];
+		m[3] = 0.0f;
+		m[4] = 2.0f * (xy - wz) * sy[node];
+		m[5] = (1.0f - 2.0f * (xx + zz)) * sy[node];
+		m[6] = 2.0f * (yz + wx) * sy[node];
+		m[7] = 0.0f;
+		m[8] = 2.0f * (xz + wy) * sz[node];
+		m[9] = 2.0f * (yz - wx) * sz[node];
+		m[10] = (1.0f - 2.0f * (xx + yy)) * sz[node];
+		m[11] = 0.0f;
+		m[12] = tx[node];
+		m[13] = ty[node];
+		m[14] = tz[node];
+		m[15] = 1.0f;
+	}
+
+	// a * b for column major matrices whose last rows are (0, 0, 0, 1)
+	static void multiplyAffine(const float* a, const float* b, float* out) {
+#if defined(TRANSFORM_HIERARCHY_SSE2)
+		__m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+		for (int col = 0; col < 4; col++) {
+			const float* c = b + col * 4;
+			__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(c[0])), _mm_mul_ps(a1, _mm_set1_ps(c[1]))),
+				_mm_mul_ps(a2, _mm_set1_ps(c[2])));
+			if (col == 3) {
+				result = _mm_add_ps(result, a3);
+			}
+			_mm_storeu_ps(out + col * 4, result);
+		}
+#else
+		for (int col = 0; col < 4; col++) {
+			const float* c = b + col * 4;
+			for (int row = 0; row < 4; row++) {
+				out[col * 4 + row] = a[row] * c[0] + a[4 + row] * c[1] + a[8 + row] * c[2] + (col == 3 ? a[12 + row] : 0.0f);
+			}
+		}
+#endif
+	}
+
+	std::vector<unsigned int> parents;
+	std::vector<unsigned int> depths;
+	std::vector<float> world;
+	std::vector<unsigned char> dirty;
+	std::vector<unsigned int> children;		// nodes grouped by parent
+	std::vector<size_t> childStarts;		// where each node's children start in children, plus the end
+	std::vector<std::vector<unsigned int>> dirtyLevels;	// flagged nodes by depth, each once
+	std::vector<unsigned int> pending, found;			// update's current and next level
+	std::vector<std::vector<unsigned int>> threadFound;
+	bool anyDirty = false;
+	bool childrenValid = false;
+};
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// GL enum of a component type
+template <typename T> struct GLTypeOf;
+template <> struct GLTypeOf<float>			{ static constexpr GLenum value = GL_FLOAT; };
+template <> struct GLTypeOf<int8_t>			{ static constexpr GLenum value = GL_BYTE; };
+template <> struct GLTypeOf<uint8_t>		{ static constexpr GLenum value = GL_UNSIGNED_BYTE; };
+template <> struct GLTypeOf<int16_t>		{ static constexpr GLenum value = GL_SHORT; };
+template <> struct GLTypeOf<uint16_t>		{ static constexpr GLenum value = GL_UNSIGNED_SHORT; };
+template <> struct GLTypeOf<int32_t>		{ static constexpr GLenum value = GL_INT; };
+template <> struct GLTypeOf<uint32_t>		{ static constexpr GLenum value = GL_UNSIGNED_INT; };
+
+// one vertex attribute: Components values of type T, optionally normalized to
+// [0, 1] / [-1, 1] or read by the shader as integers
+template <typename T, int Components, bool Normalized = false, bool Integer = false>
+struct VertexAttrib {
+	using type = T;
+	static constexpr int components = Components;
+	static constexpr bool normalized = Normalized;
+	static constexpr bool integer = Integer;
+	static constexpr GLenum glType = GLTypeOf<T>::value;
+	static constexpr size_t size = sizeof(T) * Components;
+	static_assert(!(Normalized && Integer), "integer attributes cannot be normalized");
+};
+
+// attributes named after the inputs of the sample shaders, used to find their
+// locations by reflection
+struct Position3f : VertexAttrib<float, 3>			{ static constexpr const char* name = "aPos"; };
+struct Color3f : VertexAttrib<float, 3>				{ static constexpr const char* name = "aColor"; };
+struct TexCoord2f : VertexAttrib<float, 2>			{ static constexpr const char* name = "aTexCoord"; };
+struct Normal3f : VertexAttrib<float, 3>			{ static constexpr const char* name = "aNormal"; };
+struct TextureIndex1u : VertexAttrib<uint32_t, 1, false, true> { static constexpr const char* name = "aTexture"; };
+
+// a vertex format whose stride and offsets are computed at compile time.
+// attributes are located by name in the shader when a program is given, and
+// skipped when the program does not use them, and by their position in the
+// list otherwise
+template <typename... Attrs>
+struct VertexLayout {
+	static constexpr size_t count = sizeof...(Attrs);
+	static constexpr std::array<size_t, count> sizes = { Attrs::size... };
+
+	// attributes start on 4 byte boundaries, which GL expects for fast vertex fetch
+	static constexpr size_t align(size_t offset) {
+		return (offset + 3) & ~(size_t)3;
+	}
+
+	static constexpr std::array<size_t, count> computeOffsets() {
+		std::array<size_t, count> result = {};
+		size_t offset = 0;
+		for (size_t i = 0; i < count; i++) {
+			result[i] = offset;
+			offset = align(offset + sizes[i]);
+		}
+		return result;
+	}
+
+	static constexpr std::array<size_t, count> offsets = computeOffsets();
+	static constexpr size_t stride = count == 0 ? 0 : align(offsets[count - 1] + sizes[count - 1]);
+
+	template <size_t I>
+	static constexpr size_t offset() {
+		return offsets[I];
+	}
+
+	// position of Attr in the layout, or -1 when the layout does not have it
+	template <typename Attr>
+	static constexpr int indexOf() {
+		constexpr bool matches[] = { std::is_same<Attr, Attrs>::value..., false };
+		for (size_t i = 0; i < count; i++) {
+			if (matches[i]) {
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	// sets up the attributes of the bound VAO reading from one interleaved buffer
+	static void setup(unsigned int vbo, unsigned int program = 0) {
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		setupInterleaved(program, std::index_sequence_for<Attrs...>());
+	}
+
+	// sets up the attributes of the bound VAO reading each from its own buffer
+	static void setupSplit(const unsigned int (&vbos)[count], unsigned int program = 0) {
+		setupSplit(vbos, program, std::index_sequence_for<Attrs...>());
+	}
+
+	// compares the layout with the program's active attributes, printing every
+	// mismatch; returns false when the program cannot read the layout correctly
+	static bool validate(unsigned int program) {
+		bool valid = true;
+		(validateAttrib<Attrs>(program, valid), ...);
+
+		GLint active = 0;
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &active);
+		for (GLint i = 0; i < active; i++) {
+			char name[256];
+			GLint size;
+			GLenum type;
+			glGetActiveAttrib(program, i, sizeof(name), NULL, &size, &type, name);
+			if (std::strncmp(name, "gl_", 3) != 0 && !provides(name)) {
+				std::cout << "WARNING::VERTEX_LAYOUT::ATTRIBUTE_NOT_PROVIDED " << name << std::endl;
+			}
+		}
+		return valid;
+	}
+
+	static bool provides(const char* name) {
+		return ((std::strcmp(Attrs::name, name) == 0) || ...);
+	}
+
+	// address unique to each layout, used as a cache key
+	static const void* id() {
+		static const char tag = 0;
+		return &tag;
+	}
+
+private:
+	// the program's location for Attr, or its index in the layout without a
+	// program. -1 when the program optimized the attribute out: its list index
+	// could be another active attribute's location, so it is left alone
+	template <typename Attr>
+	static GLint location(unsigned int program, size_t index) {
+		return program != 0 ? glGetAttribLocation(program, Attr::name) : (GLint)index;
+	}
+
+	template <typename Attr>
+	static void pointer(GLint location, size_t stride, size_t offset) {
+		if (location < 0) {
+			return;
+		}
+		if (Attr::integer) {
+			glVertexAttribIPointer(location, Attr::components, Attr::glType, (GLsizei)stride, (void*) offset);
+		}
+		else {
+			glVertexAttribPointer(location, Attr::components, Attr::glType, Attr::normalized ? GL_TRUE : GL_FALSE,
+				(GLsizei)stride, (void*) offset);
+		}
+		glEnableVertexAttribArray(location);
+	}
+
+	template <size_t... I>
+	static void setupInterleaved(unsigned int program, std::index_sequence<I...>) {
+		(pointer<Attrs>(location<Attrs>(program, I), stride, offsets[I]), ...);
+	}
+
+	template <size_t... I>
+	static void setupSplit(const unsigned int (&vbos)[count], unsigned int program, std::index_sequence<I...>) {
+		((glBindBuffer(GL_ARRAY_BUFFER, vbos[I]), pointer<Attrs>(location<Attrs>(program, I), Attrs::size, 0)), ...);
+	}
+
+	template <typename Attr>
+	static void validateAttrib(unsigned int program, bool& valid) {
+		// attributes the shader does not read are inactive and simply not listed
+		GLint active = 0;
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &active);
+		for (GLint i = 0; i < active; i++) {
+			char name[256];
+			GLint size;
+			GLenum type;
+			glGetActiveAttrib(program, i, sizeof(name), NULL, &size, &type, name);
+			if (std::strcmp(name, Attr::name) != 0) {
+				continue;
+			}
+
+			bool shaderInteger = isIntegerType(type);
+			if (shaderInteger != Attr::integer) {
+				std::cout << "ERROR::VERTEX_LAYOUT::TYPE_MISMATCH " << Attr::name << " is "
+					<< (shaderInteger ? "an integer" : "a float") << " in the shader" << std::endl;
+				valid = false;
+			}
+			if (componentCount(type) < Attr::components) {
+				std::cout << "WARNING::VERTEX_LAYOUT::COMPONENTS_DROPPED " << Attr::name << " reads "
+					<< componentCount(type) << " of " << Attr::components << " components" << std::endl;
+			}
+		}
+	}
+
+	static bool isIntegerType(GLenum type) {
+		switch (type) {
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static int componentCount(GLenum type) {
+		switch (type) {
+		case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT:								return 1;
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:				return 2;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:				return 3;
+		default:																		return 4;
+		}
+	}
+};
+
+// VAOs created from a layout and the buffers feeding it, so switching between
+// layouts or buffers is a single glBindVertexArray
+class VertexArrayCache {
+public:
+	~VertexArrayCache() {
+		clear();
+	}
+
+	VertexArrayCache() = default;
+	VertexArrayCache(const VertexArrayCache&) = delete;
+	VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+	// returns the VAO reading Layout from an interleaved vbo (and ebo, if any),
+	// creating and validating it on first use
+	template <typename Layout>
+	unsigned int get(unsigned int vbo, unsigned int ebo = 0, unsigned int program = 0) {
+		Key key(Layout::id(), vbo, ebo, program);
+		auto found = vertexArrays.find(key);
+		if (found != vertexArrays.end()) {
+			return found->second;
+		}
+
+		unsigned int VAO;
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+		if (ebo != 0) {
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+		}
+		Layout::setup(vbo, program);
+		if (program != 0) {
+			Layout::validate(program);
+		}
+
+		vertexArrays[key] = VAO;
+		return VAO;
+	}
+
+	// binds the VAO for a layout and its buffers
+	template <typename Layout>
+	unsigned int bind(unsigned int vbo, unsigned int ebo = 0, unsigned int program = 0) {
+		unsigned int VAO = get<Layout>(vbo, ebo, program);
+		glBindVertexArray(VAO);
+		return VAO;
+	}
+
+	// deletes every VAO; must be called while the GL context is still alive
+	void clear() {
+		for (auto& entry : vertexArrays) {
+			glDeleteVertexArrays(1, &entry.second);
+		}
+		vertexArrays.clear();
+	}
+
+private:
+	typedef std::tuple<const void*, unsigned int, unsigned int, unsigned int> Key;
+	std::map<Key, unsigned int> vertexArrays;
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef VERTEX_QUANTIZE_H
+#define VERTEX_QUANTIZE_H
+
+#include <glad/glad.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hdr_image.h"
+#include "vertex_layout.h"
+
+// component type for GL_HALF_FLOAT attributes
+struct Half {
+	uint16_t bits;
+};
+template <> struct GLTypeOf<Half> { static constexpr GLenum value = GL_HALF_FLOAT; };
+
+// quantized attributes keep the names of their float counterparts, so a layout
+// can be swapped without touching attribute locations
+struct PositionHalf4 : VertexAttrib<Half, 4>					{ static constexpr const char* name = "aPos"; };
+struct PositionSnorm4 : VertexAttrib<int16_t, 4, true>			{ static constexpr const char* name = "aPos"; };
+struct NormalOct2 : VertexAttrib<int16_t, 2, true>				{ static constexpr const char* name = "aNormal"; };
+struct TexCoordUnorm2 : VertexAttrib<uint16_t, 2, true>			{ static constexpr const char* name = "aTexCoord"; };
+struct ColorUnorm4 : VertexAttrib<uint8_t, 4, true>				{ static constexpr const char* name = "aColor"; };
+
+// 20 bytes per vertex instead of 48 for float position, normal, uv and color
+struct QuantizedVertex {
+	int16_t position[4];	// half floats or snorm16 relative to the mesh bounds
+	int16_t normal[2];		// octahedral snorm16
+	uint16_t texCoord[2];	// unorm16 relative to the uv bounds
+	uint8_t color[4];		// unorm8
+};
+
+typedef VertexLayout<PositionHalf4, NormalOct2, TexCoordUnorm2, ColorUnorm4> QuantizedHalfLayout;
+typedef VertexLayout<PositionSnorm4, NormalOct2, TexCoordUnorm2, ColorUnorm4> QuantizedSnormLayout;
+static_assert(QuantizedHalfLayout::stride == sizeof(QuantizedVertex), "QuantizedVertex must match its layouts");
+static_assert(QuantizedSnormLayout::stride == sizeof(QuantizedVertex), "QuantizedVertex must match its layouts");
+
+enum class PositionEncoding {
+	Half,		// no decode needed, ~3 significant digits
+	Snorm16		// 16 bits across the mesh bounds, decoded with positionScale/positionOffset
+};
+
+// float vertex streams to compress; null streams are filled with defaults
+struct VertexStreams {
+	size_t vertexCount = 0;
+	size_t stride = 0;					// bytes between vertices, shared by all streams
+	const float* positions = nullptr;	// xyz
+	const float* normals = nullptr;		// xyz, unit length
+	const float* texCoords = nullptr;	// uv
+	const float* colors = nullptr;		// rgb, in [0, 1]
+};
+
+// quantized vertices and the uniforms the vertex shader needs to decode them:
+// position = aPos.xyz * positionScale + positionOffset and
+// texCoord = aTexCoord * texCoordScale + texCoordOffset
+struct QuantizedMesh {
+	PositionEncoding encoding = PositionEncoding::Snorm16;
+	std::vector<QuantizedVertex> vertices;
+	float positionScale[3] = { 1.0f, 1.0f, 1.0f };
+	float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+	float texCoordScale[2] = { 1.0f, 1.0f };
+	float texCoordOffset[2] = { 0.0f, 0.0f };
+
+	// sets up the bound VAO for the encoding in use
+	void setup(unsigned int vbo, unsigned int program = 0) const {
+		if (encoding == PositionEncoding::Half) {
+			QuantizedHalfLayout::setup(vbo, program);
+		}
+		else {
+			QuantizedSnormLayout::setup(vbo, program);
+		}
+	}
+
+	// uploads the decode uniforms to the currently used program
+	void setUniforms(unsigned int program) const {
+		glUniform3fv(glGetUniformLocation(program, "positionScale"), 1, positionScale);
+		glUniform3fv(glGetUniformLocation(program, "positionOffset"), 1, positionOffset);
+		glUniform2fv(glGetUniformLocation(program, "texCoordScale"), 1, texCoordScale);
+		glUniform2fv(glGetUniformLocation(program, "texCoordOffset"), 1, texCoordOffset);
+	}
+};
+
+inline int16_t quantizeSnorm16(float value) {
+	value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+	return (int16_t)std::lround(value * 32767.0f);
+}
+
+inline uint16_t quantizeUnorm16(float value) {
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (uint16_t)std::lround(value * 65535.0f);
+}
+
+inline uint8_t quantizeUnorm8(float value) {
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (uint8_t)std::lround(value * 255.0f);
+}
+
+// maps a unit vector onto the octahedron and unfolds it into the [-1, 1] square
+inline void encodeOctahedral(const float* n, int16_t* out) {
+	float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+	float x = l1 > 0.0f ? n[0] / l1 : 0.0f;
+	float y = l1 > 0.0f ? n[1] / l1 : 0.0f;
+	if (n[2] < 0.0f) {
+		float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	out[0] = quantizeSnorm16(x);
+	out[1] = quantizeSnorm16(y);
+}
+
+// inverse of encodeOctahedral, as done by the vertex shader
+inline void decodeOctahedral(const int16_t* in, float* n) {
+	float x = in[0] / 32767.0f, y = in[1] / 32767.0f;
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+	float t = z < 0.0f ? -z : 0.0f;
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	float length = std::sqrt(x * x + y * y + z * z);
+	n[0] = x / length;
+	n[1] = y / length;
+	n[2] = z / length;
+}
+
+inline QuantizedMesh quantizeVertices(const VertexStreams& streams, PositionEncoding encoding = PositionEncoding::Snorm16) {
+	QuantizedMesh mesh;
+	mesh.encoding = encoding;
+	mesh.vertices.resize(streams.vertexCount);
+	size_t stride = streams.stride / sizeof(float);
+
+	// bounds of the positions and texture coords
+	float minPos[3] = { 0, 0, 0 }, maxPos[3] = { 0, 0, 0 };
+	float minUV[2] = { 0, 0 }, maxUV[2] = { 1, 1 };
+	for (size_t v = 0; v < streams.vertexCount; v++) {
+		for (int c = 0; c < 3; c++) {
+			float p = streams.positions[v * stride + c];
+			minPos[c] = v == 0 || p < minPos[c] ? p : minPos[c];
+			maxPos[c] = v == 0 || p > maxPos[c] ? p : maxPos[c];
+		}
+		for (int c = 0; streams.texCoords && c < 2; c++) {
+			float t = streams.texCoords[v * stride + c];
+			minUV[c] = v == 0 || t < minUV[c] ? t : minUV[c];
+			maxUV[c] = v == 0 || t > maxUV[c] ? t : maxUV[c];
+		}
+	}
+
+	if (encoding == PositionEncoding::Snorm16) {
+		for (int c = 0; c < 3; c++) {
+			mesh.positionOffset[c] = (minPos[c] + maxPos[c]) * 0.5f;
+			mesh.positionScale[c] = (maxPos[c] - minPos[c]) * 0.5f;
+			mesh.positionScale[c] = mesh.positionScale[c] > 0.0f ? mesh.positionScale[c] : 1.0f;
+		}
+	}
+	for (int c = 0; c < 2; c++) {
+		mesh.texCoordOffset[c] = minUV[c];
+		mesh.texCoordScale[c] = maxUV[c] - minUV[c] > 0.0f ? maxUV[c] - minUV[c] : 1.0f;
+	}
+
+	for (size_t v = 0; v < streams.vertexCount; v++) {
+		QuantizedVertex& out = mesh.vertices[v];
+		const float* p = streams.positions + v * stride;
+		for (int c = 0; c < 3; c++) {
+			out.position[c] = encoding == PositionEncoding::Half
+				? (int16_t)floatToHalf(p[c])
+				: quantizeSnorm16((p[c] - mesh.positionOffset[c]) / mesh.positionScale[c]);
+		}
+		out.position[3] = encoding == PositionEncoding::Half ? (int16_t)floatToHalf(1.0f) : 32767;
+
+		const float up[3] = { 0.0f, 0.0f, 1.0f };
+		encodeOctahedral(streams.normals ? streams.normals + v * stride : up, out.normal);
+
+		for (int c = 0; c < 2; c++) {
+			float t = streams.texCoords ? streams.texCoords[v * stride + c] : 0.0f;
+			out.texCoord[c] = quantizeUnorm16((t - mesh.texCoordOffset[c]) / mesh.texCoordScale[c]);
+		}
+
+		for (int c = 0; c < 3; c++) {
+			out.color[c] = streams.colors ? quantizeUnorm8(streams.colors[v * stride + c]) : 255;
+		}
+		out.color[3] = 255;
+	}
+	return mesh;
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <cstdlib>
+#include "../../dependencies/include/learnopengl/mesh_optimizer.h"
 
 const int scrHeight = 800;
 const int scrWidth	= 600;
@@ -69,6 +70,9 @@ int main(void) {
 		1,2,3  // second triangle
 	};
 
+	// only four vertices, so the indices are packed as GL_UNSIGNED_SHORT
+	PackedIndices rectangleElements = packIndices(rectangleIndices, 6, 4);
+
 
 	/////////////////
 	////// VAO //////
@@ -87,7 +91,7 @@ int main(void) {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 
 	// copy rectangle indices to EBO
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(rectangleIndices), rectangleIndices, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, rectangleElements.data.size(), rectangleElements.data.data(), GL_STATIC_DRAW);
 
 
 	/////////////////
@@ -178,7 +182,7 @@ int main(void) {
 		// draw rectangle
 		glUseProgram(shaderProgram);
 		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		glDrawElements(GL_TRIANGLES, (GLsizei)rectangleElements.count, rectangleElements.type, 0);
 		glBindVertexArray(0);
 
 		glfwSwapBuffers(window);
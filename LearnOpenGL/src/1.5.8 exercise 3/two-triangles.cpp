@@ -2,11 +2,15 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <cstdlib>
+#include "../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../dependencies/include/learnopengl/mesh_pool.h"
 
 const int scrHeight = 800;
 const int scrWidth	= 600;
 const int LOG_SZ	= 512;
 
+typedef VertexLayout<Position3f> TriangleVertex;
+
 const char *vertexShaderSource = "#version 330 core\n"
 "layout (location = 0) in vec3 aPos;\n"
 "void main()\n"
@@ -76,37 +80,17 @@ int main(void) {
 		0.25f, -0.9f,  0.0f
 	};
 
-	/////////////////
-	////// VAO //////
-	/////////////////
-	unsigned int firstTriangleVAO, secondTriangleVAO;
-	glGenVertexArrays(1, &firstTriangleVAO);
-	glGenVertexArrays(1, &secondTriangleVAO);
-	glBindVertexArray(firstTriangleVAO);
-	glBindVertexArray(secondTriangleVAO);
-
-
-	/////////////////
-	////// VBO //////
-	/////////////////
-	// Create buffer objects
-	unsigned int firstTriangleVBO, secondTriangleVBO;
-	glGenBuffers(1, &firstTriangleVBO);
-	glGenBuffers(1, &secondTriangleVBO);
-
-	// Setting up first triangle
-	glBindVertexArray(firstTriangleVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, firstTriangleVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(firstTriangleVertices), firstTriangleVertices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), (void*) 0);
-	glEnableVertexAttribArray(0);
-
-	// Setting up second triangle
-	glBindVertexArray(secondTriangleVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, secondTriangleVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(secondTriangleVertices), secondTriangleVertices, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), (void*) 0);
-	glEnableVertexAttribArray(0);
+	unsigned int triangleIndices[] = { 0, 1, 2 };
+
+
+	///////////////////////
+	////// MESH POOL //////
+	///////////////////////
+	// both triangles are packed into one shared VBO, EBO and VAO; each keeps
+	// its own indices and is drawn from its base vertex
+	MeshPool<TriangleVertex> meshPool(1024, 1024);
+	MeshAllocation firstTriangle = meshPool.add(firstTriangleVertices, 3, triangleIndices, 3);
+	MeshAllocation secondTriangle = meshPool.add(secondTriangleVertices, 3, triangleIndices, 3);
 
 
 	///////////////////////////
@@ -182,25 +166,23 @@ int main(void) {
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 		
+		// the pool binds its VAO once for both draws
+		meshPool.beginFrame();
+
 		// draw first triangle (orange)
 		glUseProgram(orangeProgram);
-		glBindVertexArray(firstTriangleVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		meshPool.draw(firstTriangle);
 
 		// draw second triangle (yellow)
 		glUseProgram(yellowProgram);
-		glBindVertexArray(secondTriangleVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		meshPool.draw(secondTriangle);
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
 	// deallocate everything once program terminates
-	glDeleteVertexArrays(1, &firstTriangleVAO);
-	glDeleteVertexArrays(1, &secondTriangleVAO);
-	glDeleteBuffers(1, &firstTriangleVBO);
-	glDeleteBuffers(1, &secondTriangleVBO);
+	meshPool.clear();
 	glDeleteProgram(orangeProgram);
 	glDeleteProgram(yellowProgram);
 	
@@ -0,0 +1,232 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include "../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../dependencies/include/learnopengl/batcher.h"
+
+const int scrHeight = 800;
+const int scrWidth	= 600;
+const int LOG_SZ	= 512;
+const size_t streamFrameSize = 64 * 1024;
+
+typedef VertexLayout<Position3f> TriangleVertex;
+
+const char *vertexShaderSource = "#version 330 core\n"
+"layout (location = 0) in vec3 aPos;\n"
+"void main()\n"
+"{\n"
+" gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
+"}\0";
+
+const char* fragmentShaderSource = "#version 330 core\n"
+"out vec4 FragColor;\n"
+"void main()\n"
+"{\n"
+" FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+"}\0";
+
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width);
+void processInput(GLFWwindow* window);
+bool programCompiled(unsigned int& shader, const char* shaderName, bool isShaderProgram);
+void rotationAbout(const float* vertices, float angle, float* transform);
+
+int main(void) {
+	/////////////////////////
+	////// GLFW & GLAD //////
+	/////////////////////////
+	// initialize glfw version and profile
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// create glfw window
+	GLFWwindow* window = glfwCreateWindow(scrHeight, scrWidth, "LearnOpenGL", NULL, NULL);
+	if (window == nullptr) {
+		std::cerr << "Failed to initialize GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // resizes viewport when user changes window size
+
+	// set up glad pointer
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	//////////////////////
+	////// VERTICES //////
+	//////////////////////
+	float firstTriangleVertices[] = {
+		-0.75f, 0.9f,  0.0f,
+		-0.75f, 0.25f, 0.0f, 	
+		-0.25f, 0.9f,  0.0f, 	
+	};
+
+	float secondTriangleVertices[] = {
+		0.75f, -0.9f,  0.0f,
+		0.75f, -0.25f, 0.0f,
+		0.25f, -0.9f,  0.0f
+	};
+
+	unsigned int triangleIndices[] = { 0, 1, 2 };
+
+
+	/////////////////////
+	////// BATCHER //////
+	/////////////////////
+	// the two triangles of exercise 2, rotated on the CPU every frame. they share
+	// a program, so the dynamic batcher writes both into its stream buffers and
+	// draws them at once instead of binding a VAO for each
+	DynamicBatcher<TriangleVertex> batcher(streamFrameSize, streamFrameSize);
+
+
+	///////////////////////////
+	////// VERTEX SHADER //////
+	///////////////////////////
+
+	// create, attach, and compile vertex shader
+	unsigned int vertexShader;
+	vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glCompileShader(vertexShader);
+	
+	// error check vertex shader compilation
+	if (!programCompiled(vertexShader, "Vertex shader", false)) {
+		exit(1);
+	}
+
+
+	/////////////////////////////
+	////// FRAGMENT SHADER //////
+	/////////////////////////////
+	// create, attach, and compile fragment shader
+	unsigned int fragmentShader;
+	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+	glCompileShader(fragmentShader);
+
+	// error check fragment shader compilation
+	if (!programCompiled(fragmentShader, "Fragment shader", false)) {
+		exit(1);
+	}
+
+
+	////////////////////////////
+	////// SHADER PROGRAM //////
+	////////////////////////////
+	// create shader program
+	unsigned int shaderProgram;
+	shaderProgram = glCreateProgram();
+
+	// attach and link vertex and fragment shaders
+	glAttachShader(shaderProgram, vertexShader);
+	glAttachShader(shaderProgram, fragmentShader);
+	glLinkProgram(shaderProgram);
+
+	// check shader program's compilation status
+	if (!programCompiled(shaderProgram, "Shader program", true)) {
+		exit(1);
+	}
+
+	// clean-up individual shaders
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+
+	//////////////////
+	///// RENDER /////
+	//////////////////
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+
+		// background
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		
+		// rotate both triangles around their centers
+		float angle = (float)glfwGetTime();
+		float firstTransform[16], secondTransform[16];
+		rotationAbout(firstTriangleVertices, angle, firstTransform);
+		rotationAbout(secondTriangleVertices, -angle, secondTransform);
+
+		// both triangles use the same shader, so they end up in one draw call
+		BatchKey key;
+		key.program = shaderProgram;
+		batcher.beginFrame();
+		batcher.submit(key, firstTriangleVertices, 3, triangleIndices, 3, firstTransform);
+		batcher.submit(key, secondTriangleVertices, 3, triangleIndices, 3, secondTransform);
+		batcher.render();
+		batcher.endFrame();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// deallocate everything once program terminates
+	batcher.clear();
+	glDeleteProgram(shaderProgram);
+	
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width) {
+	glViewport(0, 0, height, width);
+}
+
+void processInput(GLFWwindow* window) {
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
+
+bool programCompiled(unsigned int& shader, const char* shaderName, bool isShaderProgram) {
+	int success;
+	char log[LOG_SZ];
+	if (!isShaderProgram) { // checks shaders
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(shader, LOG_SZ, NULL, log);
+			std::cerr << shaderName << " was unable to compile properly\n"
+				<< log << std::endl;
+			return false;
+		}
+	}
+	else { // check shader programs
+		glGetProgramiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetProgramInfoLog(shader, LOG_SZ, NULL, log);
+			std::cerr << shaderName << " was unable to compile properly\n"
+				<< log << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// column major matrix rotating around the center of a triangle in the xy plane
+void rotationAbout(const float* vertices, float angle, float* transform) {
+	float centerX = (vertices[0] + vertices[3] + vertices[6]) / 3.0f;
+	float centerY = (vertices[1] + vertices[4] + vertices[7]) / 3.0f;
+	float c = std::cos(angle), s = std::sin(angle);
+	for (int i = 0; i < 16; i++) {
+		transform[i] = 0.0f;
+	}
+	transform[0] = c;
+	transform[1] = s;
+	transform[4] = -s;
+	transform[5] = c;
+	transform[10] = 1.0f;
+	transform[12] = centerX - c * centerX + s * centerY;
+	transform[13] = centerY - s * centerX - c * centerY;
+	transform[15] = 1.0f;
+}
@@ -0,0 +1,158 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <filesystem>
+#include "../../dependencies/include/learnopengl/shader.h"
+#include "../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../dependencies/include/learnopengl/stream_buffer.h"
+
+const int scrHeight = 800;
+const int scrWidth	= 600;
+const size_t streamFrameSize = 64 * 1024;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/1.6 shaders-stream-buffer/shaders/";
+
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width);
+void processInput(GLFWwindow* window);
+void animateTriangle(const float* vertices, float time, float* out);
+
+int main(void) {
+	/////////////////////////
+	////// GLFW & GLAD //////
+	/////////////////////////
+	// initialize glfw version and profile
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// create glfw window
+	GLFWwindow* window = glfwCreateWindow(scrHeight, scrWidth, "LearnOpenGL", NULL, NULL);
+	if (window == nullptr) {
+		std::cout << "Failed to initialize GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // resizes viewport when user changes window size
+
+	// set up glad pointer
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	////////////////////
+	///// VERTICES /////
+	////////////////////
+	float triangleVertices[] = {
+	//  position				colors
+		-0.5f, -0.5f, 0.0f, 	1.0f, 0.0f, 0.0f,
+		 0.5f, -0.5f, 0.0f, 	0.0f, 1.0f, 0.0f,
+		 0.0f,  0.5f, 0.0f, 	0.0f, 0.0f, 1.0f,
+	};
+
+	/////////////////////
+	///// VAO & VBO /////
+	/////////////////////
+	// the triangle of shaders-exercise 2 is moved on the CPU instead of in the
+	// vertex shader, so its vertices are rewritten every frame into a triple
+	// buffered stream buffer rather than uploaded once to a static VBO
+	const size_t vertexStride = 6 * sizeof(float);
+	StreamBuffer streamBuffer(GL_ARRAY_BUFFER, streamFrameSize);
+	std::cout << (streamBuffer.isPersistent() ? "persistently mapped ring" : "unsynchronized mapped ring") << std::endl;
+
+	unsigned int VAO;
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer());
+
+
+	//////////////////////
+	///// ATTRIBUTES /////
+	//////////////////////
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*) 0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*) (3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+
+	///////////////////
+	///// SHADERS /////
+	///////////////////
+	std::string vertPath, fragPath;
+	vertPath = shaderPath + "stream.vs";
+	fragPath = shaderPath + "stream.fs";
+	Shader shaderProgram(vertPath.c_str(), fragPath.c_str());
+
+
+	//////////////////
+	///// RENDER /////
+	//////////////////
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+
+		// background
+		glClearColor(1.0f, 0.8f, 0.9f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// write this frame's vertices; the allocation is aligned to the vertex
+		// stride so its offset doubles as the first vertex to draw
+		streamBuffer.beginFrame();
+		StreamAllocation allocation = streamBuffer.allocate(sizeof(triangleVertices), vertexStride);
+		if (allocation.valid()) {
+			animateTriangle(triangleVertices, (float)glfwGetTime(), (float*)allocation.data);
+			streamBuffer.flush();
+
+			// draw triangle
+			shaderProgram.use();
+			glBindVertexArray(VAO);
+			glDrawArrays(GL_TRIANGLES, (GLint)(allocation.offset / vertexStride), 3);
+		}
+		streamBuffer.endFrame();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// clean up buffers and shader program
+	glDeleteVertexArrays(1, &VAO);
+	streamBuffer.clear();
+	glDeleteProgram(shaderProgram.ID);
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width) {
+	glViewport(0, 0, height, width);
+}
+
+void processInput(GLFWwindow* window) {
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
+
+// slides the triangle from side to side like shaders-exercise 2 and spins it
+// around its center, copying the colors through
+void animateTriangle(const float* vertices, float time, float* out) {
+	float offset = std::sin(time) / 2.0f;
+	float c = std::cos(time), s = std::sin(time);
+	float centerX = (vertices[0] + vertices[6] + vertices[12]) / 3.0f;
+	float centerY = (vertices[1] + vertices[7] + vertices[13]) / 3.0f;
+	for (int i = 0; i < 3; i++) {
+		const float* in = vertices + i * 6;
+		float x = in[0] - centerX, y = in[1] - centerY;
+		out[i * 6] = centerX + x * c - y * s + offset;
+		out[i * 6 + 1] = centerY + x * s + y * c;
+		for (int k = 2; k < 6; k++) {
+			out[i * 6 + k] = in[k];
+		}
+	}
+}
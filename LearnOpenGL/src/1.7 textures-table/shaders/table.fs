@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in uint TextureIndex;
+
+// pool bound for this draw; the low 16 bits of the texture index select its layer
+uniform sampler2DArray pool;
+
+void main()
+{
+	FragColor = texture(pool, vec3(TexCoord, float(TextureIndex & 0xFFFFu)));
+}
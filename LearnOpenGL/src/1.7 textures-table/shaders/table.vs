@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in uint aTexture;
+
+out vec2 TexCoord;
+flat out uint TextureIndex;
+
+void main()
+{
+	gl_Position = vec4(aPos, 1.0);
+	TexCoord = aTexCoord;
+	TextureIndex = aTexture;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+#extension GL_ARB_bindless_texture : require
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in uint TextureIndex;
+
+// one bindless handle per pool; the high 16 bits of the texture index select the pool.
+// the length must match TextureTable::MAX_BINDLESS_POOLS
+layout (std140) uniform TextureHandles
+{
+	sampler2DArray pools[16];
+};
+
+void main()
+{
+	uint pool = TextureIndex >> 16;
+	FragColor = texture(pools[pool], vec3(TexCoord, float(TextureIndex & 0xFFFFu)));
+}
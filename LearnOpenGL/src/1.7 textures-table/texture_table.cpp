@@ -0,0 +1,234 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstdlib>
+#include <filesystem>
+#include <cstddef>
+#include <vector>
+#include "../../dependencies/include/learnopengl/shader.h"
+#include "../../dependencies/include/learnopengl/sampler_cache.h"
+#include "../../dependencies/include/learnopengl/texture_table.h"
+#include "../../dependencies/include/learnopengl/vertex_layout.h"
+
+const int scrHeight = 800;
+const int scrWidth	= 600;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/1.7 textures-table/shaders/";
+const std::string texturePath = std::filesystem::current_path().string() + "/resources/textures/";
+
+struct Vertex {
+	float position[3];
+	float texCoord[2];
+	unsigned int texture;	// TextureRef::index()
+};
+
+typedef VertexLayout<Position3f, TexCoord2f, TextureIndex1u> TableVertex;
+static_assert(TableVertex::stride == sizeof(Vertex), "TableVertex must match Vertex");
+static_assert(TableVertex::offset<2>() == offsetof(Vertex, texture), "TableVertex must match Vertex");
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width);
+void processInput(GLFWwindow* window);
+std::vector<unsigned char> checkerboard(int size, int cells, unsigned char r, unsigned char g, unsigned char b);
+void addQuad(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float x, float y, TextureRef texture);
+
+int main(void) {
+	/////////////////////////
+	////// GLFW & GLAD //////
+	/////////////////////////
+	// initialize glfw version and profile
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// create glfw window
+	GLFWwindow* window = glfwCreateWindow(scrHeight, scrWidth, "LearnOpenGL", NULL, NULL);
+	if (window == nullptr) {
+		std::cout << "Failed to initialize GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // resizes viewport when user changes window size
+
+	// set up glad pointer
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+
+	////////////////////
+	///// TEXTURES /////
+	////////////////////
+	// the 512x512 RGBA8 textures share the first pool; the sRGB one of the same
+	// size and the 256x256 one get pools of their own
+	TextureTable textureTable;
+	std::vector<unsigned char> redChecker = checkerboard(512, 8, 200, 40, 40);
+	std::vector<unsigned char> blueChecker = checkerboard(512, 16, 40, 40, 200);
+	std::vector<unsigned char> greenChecker = checkerboard(256, 4, 40, 200, 40);
+
+	TextureRef textures[] = {
+		textureTable.load(texturePath + "container.jpg", true),
+		textureTable.add(redChecker.data(), 512, 512),
+		textureTable.add(blueChecker.data(), 512, 512, GL_SRGB8_ALPHA8),
+		textureTable.add(greenChecker.data(), 256, 256)
+	};
+
+	SamplerCache samplerCache;
+	SamplerState tableSampler;
+
+
+	////////////////////
+	///// VERTICES /////
+	////////////////////
+	// one quad per texture, ordered by pool so each pool is a contiguous index range
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<int> poolFirstIndex(textureTable.poolCount() + 1, 0);
+	const float quadPositions[4][2] = { { -0.5f, 0.5f }, { 0.5f, 0.5f }, { -0.5f, -0.5f }, { 0.5f, -0.5f } };
+	for (int pool = 0; pool < textureTable.poolCount(); pool++) {
+		poolFirstIndex[pool] = (int)indices.size();
+		for (int i = 0; i < 4; i++) {
+			if (textures[i].pool == pool) {
+				addQuad(vertices, indices, quadPositions[i][0], quadPositions[i][1], textures[i]);
+			}
+		}
+	}
+	poolFirstIndex[textureTable.poolCount()] = (int)indices.size();
+
+
+	/////////////////////////
+	///// VAO, VBO, EBO /////
+	/////////////////////////
+	unsigned int VAO, VBO, EBO;
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+	// the texture table index is read as an integer
+	TableVertex::setup(VBO);
+
+
+	///////////////////
+	///// SHADERS /////
+	///////////////////
+	// bindless handles let a single draw reach every pool
+	bool bindless = textureTable.makeResident();
+	std::string vertPath, fragPath;
+	vertPath = shaderPath + "table.vs";
+	fragPath = shaderPath + (bindless ? "table_bindless.fs" : "table.fs");
+	Shader shaderProgram(vertPath.c_str(), fragPath.c_str());
+
+	unsigned int handleUBO = 0;
+	if (bindless) {
+		// always the whole sampler array the shader declares, unused slots zeroed
+		std::vector<GLuint64> handles = textureTable.handleBlock();
+		glGenBuffers(1, &handleUBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, handleUBO);
+		glBufferData(GL_UNIFORM_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_STATIC_DRAW);
+		glUniformBlockBinding(shaderProgram.ID, glGetUniformBlockIndex(shaderProgram.ID, "TextureHandles"), 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, handleUBO);
+	}
+	else {
+		shaderProgram.use();
+		shaderProgram.setInt("pool", 0);
+	}
+	std::cout << (bindless ? "bindless: 1 draw" : "texture arrays: 1 draw per pool") << ", "
+		<< textureTable.poolCount() << " pools, " << textureTable.residentBytes() / 1024 << " KiB" << std::endl;
+
+
+	//////////////////
+	///// RENDER /////
+	//////////////////
+	while (!glfwWindowShouldClose(window)) {
+		processInput(window);
+		samplerCache.beginFrame();
+
+		// background
+		glClearColor(0.1f, 0.3f, 0.3f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		shaderProgram.use();
+		glBindVertexArray(VAO);
+		if (bindless) {
+			glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+		}
+		else {
+			// every quad in a pool is drawn by the same call whatever texture it uses
+			for (int pool = 0; pool < textureTable.poolCount(); pool++) {
+				textureTable.bind(pool, 0);
+				samplerCache.bind(0, tableSampler);
+				GLsizei count = poolFirstIndex[pool + 1] - poolFirstIndex[pool];
+				glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*) (poolFirstIndex[pool] * sizeof(unsigned int)));
+			}
+		}
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// clean up buffers, textures and shader program
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	if (handleUBO != 0) {
+		glDeleteBuffers(1, &handleUBO);
+	}
+	glDeleteProgram(shaderProgram.ID);
+	textureTable.clear();
+	samplerCache.clear();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width) {
+	glViewport(0, 0, height, width);
+}
+
+void processInput(GLFWwindow* window) {
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+		glfwSetWindowShouldClose(window, true);
+	}
+}
+
+std::vector<unsigned char> checkerboard(int size, int cells, unsigned char r, unsigned char g, unsigned char b) {
+	std::vector<unsigned char> pixels((size_t)size * size * 4);
+	int cellSize = size / cells;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			bool dark = ((x / cellSize) + (y / cellSize)) % 2 == 0;
+			unsigned char* p = &pixels[((size_t)y * size + x) * 4];
+			p[0] = dark ? r / 4 : r;
+			p[1] = dark ? g / 4 : g;
+			p[2] = dark ? b / 4 : b;
+			p[3] = 255;
+		}
+	}
+	return pixels;
+}
+
+// appends a quad of half the screen's size centered on (x, y)
+void addQuad(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float x, float y, TextureRef texture) {
+	unsigned int first = (unsigned int)vertices.size();
+	const float size = 0.45f;
+	vertices.push_back({ { x + size, y + size, 0.0f }, { 1.0f, 1.0f }, texture.index() });	// top right
+	vertices.push_back({ { x + size, y - size, 0.0f }, { 1.0f, 0.0f }, texture.index() });	// bottom right
+	vertices.push_back({ { x - size, y - size, 0.0f }, { 0.0f, 0.0f }, texture.index() });	// bottom left
+	vertices.push_back({ { x - size, y + size, 0.0f }, { 0.0f, 1.0f }, texture.index() });	// top left
+
+	unsigned int quadIndices[] = { 0, 1, 3, 1, 2, 3 };
+	for (unsigned int index : quadIndices) {
+		indices.push_back(first + index);
+	}
+}
@@ -5,9 +5,18 @@
 #include <filesystem>
 #include "../../dependencies/include/learnopengl/shader.h"
 #include "../../dependencies/include/stb_image/stb_image.h"
+#include "../../dependencies/include/learnopengl/texture_manager.h"
+#include "../../dependencies/include/learnopengl/sampler_cache.h"
+#include "../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../dependencies/include/learnopengl/mesh_optimizer.h"
 
 const int scrHeight = 800;
 const int scrWidth	= 600;
+const size_t textureBudget = 256 * 1024 * 1024;
+
+// positions, colors and texture coords interleaved in one buffer
+typedef VertexLayout<Position3f, Color3f, TexCoord2f> RectVertex;
+static_assert(RectVertex::stride == 8 * sizeof(float), "RectVertex must match the vertices array");
 
 const std::string shaderPath = std::filesystem::current_path().string() + "/src/1.7 textures/shaders/";
 const std::string texturePath = std::filesystem::current_path().string() + "/resources/textures/";
@@ -59,70 +68,34 @@ int main(void) {
 		1,2,3  // second triangle
 	};
 
-
-	//////////////////////
-	///// ATTRIBUTES /////
-	//////////////////////
-	// position coords
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*) 0);
-	glEnableVertexAttribArray(0);
-
-	// colors
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*) (3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// texture coords
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*) (6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	// four vertices fit in 16 bit indices, halving the index buffer
+	PackedIndices rectElements = packIndices(rectIndices, 6, 4);
 
 
 	////////////////////
 	///// TEXTURES /////
 	////////////////////
-	// generate texture
-	unsigned int texture;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	// texture wrapping
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	// texture filtering
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// load texture
-	int texWidth, texHeight, texNChannels;
-	std::string containerImage = texturePath + "container.jpg";
-	unsigned char* data = stbi_load(containerImage.c_str(), &texWidth, &texHeight, &texNChannels, 0);
-	if (data) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texWidth, texHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Failed to load: " << containerImage << std::endl;
-	}
-
-	// clean-up
-	stbi_image_free(data);
-
+	// the texture manager owns every texture and keeps them within the video memory budget
+	TextureManager textureManager(textureBudget);
+	int containerTexture = textureManager.load(texturePath + "container.jpg");
 
-	///////////////
-	///// VAO /////
-	///////////////
-	unsigned int VAO;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	// wrapping and filtering live in shared sampler objects instead of each texture
+	SamplerCache samplerCache;
+	SamplerState containerSampler;
+	containerSampler.wrapS = GL_REPEAT;
+	containerSampler.wrapT = GL_REPEAT;
+	containerSampler.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	containerSampler.magFilter = GL_LINEAR;
+	containerSampler.maxAnisotropy = 8;
 
 
-	///////////////
-	///// EBO /////
-	///////////////
-	unsigned int EBO;
-	glGenBuffers(1, &EBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(rectIndices), rectIndices, GL_STATIC_DRAW);
+	///////////////////
+	///// SHADERS /////
+	///////////////////
+	std::string vertPath, fragPath;
+	vertPath = shaderPath + "shader.vs";
+	fragPath = shaderPath + "shader.fs";
+	Shader shaderProgram(vertPath.c_str(), fragPath.c_str());
 
 
 	///////////////
@@ -134,13 +107,17 @@ int main(void) {
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
 
-	///////////////////
-	///// SHADERS /////
-	///////////////////
-	std::string vertPath, fragPath;
-	vertPath = shaderPath + "shader.vs";
-	fragPath = shaderPath + "shader.fs";
-	Shader shaderProgram(vertPath.c_str(), fragPath.c_str());
+	/////////////////////
+	///// VAO & EBO /////
+	/////////////////////
+	// attribute locations come from the shader, strides and offsets from RectVertex
+	VertexArrayCache vertexArrays;
+	unsigned int EBO;
+	glGenBuffers(1, &EBO);
+	unsigned int VAO = vertexArrays.bind<RectVertex>(VBO, EBO, shaderProgram.ID);
+
+	// the element buffer binding is VAO state, so it is filled once the VAO exists
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, rectElements.data.size(), rectElements.data.data(), GL_STATIC_DRAW);
 
 
 	//////////////////
@@ -148,26 +125,32 @@ int main(void) {
 	//////////////////
 	while (!glfwWindowShouldClose(window)) {
 		processInput(window);
+		textureManager.beginFrame();
+		samplerCache.beginFrame();
 
 		// background
 		glClearColor(0.1f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
 		// bind texture
-		//glBindTexture(GL_TEXTURE_2D, texture);
+		textureManager.bind(containerTexture, 0);
+		samplerCache.bind(0, containerSampler);
 
 		// draw triangle
 		shaderProgram.use();
 		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		glDrawElements(GL_TRIANGLES, (GLsizei)rectElements.count, rectElements.type, 0);
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	// clean up buffers and shader program
-	glDeleteVertexArrays(1, &VAO);
+	// clean up buffers, textures and shader program
+	vertexArrays.clear();
 	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	textureManager.clear();
+	samplerCache.clear();
 	
 	glfwTerminate();
 	return 0;
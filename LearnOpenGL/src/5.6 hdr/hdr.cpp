@@ -0,0 +1,181 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstdlib>
+#include <filesystem>
+#include "../../dependencies/include/learnopengl/shader.h"
+#include "../../dependencies/include/learnopengl/texture_manager.h"
+#include "../../dependencies/include/learnopengl/sampler_cache.h"
+#include "../../dependencies/include/learnopengl/vertex_layout.h"
+
+const int scrHeight = 800;
+const int scrWidth	= 600;
+const size_t textureBudget = 256 * 1024 * 1024;
+
+typedef VertexLayout<Position3f, TexCoord2f> QuadVertex;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/5.6 hdr/shaders/";
+const std::string texturePath = std::filesystem::current_path().string() + "/resources/textures/";
+
+float exposure = 1.0f;
+int toneMapOperator = 0;
+HdrFormat hdrFormat = HdrFormat::RGBA16F;
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+// usage: hdr [image.hdr]
+// 1/2/3 upload as RGBA32F/RGBA16F/RGB9_E5, up/down change exposure, T cycles tone mapping operators
+int main(int argc, char* argv[]) {
+	/////////////////////////
+	////// GLFW & GLAD //////
+	/////////////////////////
+	// initialize glfw version and profile
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	// create glfw window
+	GLFWwindow* window = glfwCreateWindow(scrHeight, scrWidth, "LearnOpenGL", NULL, NULL);
+	if (window == nullptr) {
+		std::cout << "Failed to initialize GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // resizes viewport when user changes window size
+	glfwSetKeyCallback(window, key_callback);
+
+	// set up glad pointer
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+
+
+	////////////////////
+	///// VERTICES /////
+	////////////////////
+	// full screen quad
+	float vertices[] = {
+		// positions		  // texture coords
+		 1.0f,  1.0f, 0.0f,   1.0f, 1.0f,   // top right
+		 1.0f, -1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
+		-1.0f, -1.0f, 0.0f,   0.0f, 0.0f,   // bottom left
+		-1.0f,  1.0f, 0.0f,   0.0f, 1.0f	// top left
+	};
+
+	unsigned int quadIndices[] = {
+		0,1,3, // first triangle
+		1,2,3  // second triangle
+	};
+
+
+	/////////////////////////
+	///// VAO, VBO, EBO /////
+	/////////////////////////
+	unsigned int VAO, VBO, EBO;
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	QuadVertex::setup(VBO);
+
+
+	////////////////////
+	///// TEXTURES /////
+	////////////////////
+	// 8 bit images are linearized, so any image works when no .hdr file is given
+	std::string imagePath = argc > 1 ? argv[1] : texturePath + "container.jpg";
+	TextureManager textureManager(textureBudget);
+	HdrFormat loadedFormat = hdrFormat;
+	int hdrTexture = textureManager.loadHdr(imagePath, loadedFormat, true);
+
+	SamplerCache samplerCache;
+	SamplerState hdrSampler;
+	hdrSampler.wrapS = GL_CLAMP_TO_EDGE;
+	hdrSampler.wrapT = GL_CLAMP_TO_EDGE;
+
+
+	///////////////////
+	///// SHADERS /////
+	///////////////////
+	std::string vertPath, fragPath;
+	vertPath = shaderPath + "tonemap.vs";
+	fragPath = shaderPath + "tonemap.fs";
+	Shader toneMapShader(vertPath.c_str(), fragPath.c_str());
+	toneMapShader.use();
+	toneMapShader.setInt("hdrBuffer", 0);
+
+
+	//////////////////
+	///// RENDER /////
+	//////////////////
+	while (!glfwWindowShouldClose(window)) {
+		textureManager.beginFrame();
+		samplerCache.beginFrame();
+
+		// re-upload the image when a different format is selected
+		if (hdrFormat != loadedFormat) {
+			textureManager.clear();
+			loadedFormat = hdrFormat;
+			hdrTexture = textureManager.loadHdr(imagePath, loadedFormat, true);
+			std::cout << "video memory: " << textureManager.getStats().residentBytes / 1024 << " KiB" << std::endl;
+		}
+
+		// background
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// tone mapping pass
+		textureManager.bind(hdrTexture, 0);
+		samplerCache.bind(0, hdrSampler);
+		toneMapShader.use();
+		toneMapShader.setFloat("exposure", exposure);
+		toneMapShader.setInt("operator", toneMapOperator);
+		glBindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// clean up buffers, textures and shader program
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteProgram(toneMapShader.ID);
+	textureManager.clear();
+	samplerCache.clear();
+
+	glfwTerminate();
+	return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int height, int width) {
+	glViewport(0, 0, height, width);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (action == GLFW_RELEASE) {
+		return;
+	}
+
+	switch (key) {
+	case GLFW_KEY_ESCAPE:	glfwSetWindowShouldClose(window, true); break;
+	case GLFW_KEY_UP:		exposure *= 1.1f; break;
+	case GLFW_KEY_DOWN:		exposure /= 1.1f; break;
+	case GLFW_KEY_T:		toneMapOperator = (toneMapOperator + 1) % 3; break;
+	case GLFW_KEY_1:		hdrFormat = HdrFormat::RGBA32F; break;
+	case GLFW_KEY_2:		hdrFormat = HdrFormat::RGBA16F; break;
+	case GLFW_KEY_3:		hdrFormat = HdrFormat::RGB9_E5; break;
+	}
+}
@@ -0,0 +1,36 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// linear HDR input
+uniform sampler2D hdrBuffer;
+uniform float exposure;
+uniform int operator;	// 0 = exposure, 1 = Reinhard, 2 = ACES fitted
+
+vec3 aces(vec3 x)
+{
+	const float a = 2.51;
+	const float b = 0.03;
+	const float c = 2.43;
+	const float d = 0.59;
+	const float e = 0.14;
+	return clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0, 1.0);
+}
+
+void main()
+{
+	const float gamma = 2.2;
+	vec3 hdrColor = texture(hdrBuffer, TexCoord).rgb * exposure;
+
+	vec3 mapped;
+	if (operator == 1)
+		mapped = hdrColor / (hdrColor + vec3(1.0));
+	else if (operator == 2)
+		mapped = aces(hdrColor);
+	else
+		mapped = vec3(1.0) - exp(-hdrColor);
+
+	// gamma correction
+	FragColor = vec4(pow(mapped, vec3(1.0 / gamma)), 1.0);
+}
@@ -0,0 +1,223 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_pool.h"
+#include "../../../dependencies/include/learnopengl/batcher.h"
+#include "../benchmark.h"
+
+const int FRAMES = 100;
+const int PROGRAMS = 4;
+const int TEXTURES = 8;
+const float DYNAMIC_SHARE = 0.2f;	// objects that move every frame
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/batching/shaders/";
+
+typedef VertexLayout<Position3f, TexCoord2f> BatchVertex;
+
+const float quadVertices[] = {
+	// positions			// texture coords
+	 0.5f,  0.5f, 0.0f,		1.0f, 1.0f,
+	 0.5f, -0.5f, 0.0f,		1.0f, 0.0f,
+	-0.5f, -0.5f, 0.0f,		0.0f, 0.0f,
+	-0.5f,  0.5f, 0.0f,		0.0f, 1.0f
+};
+const unsigned int quadIndices[] = { 0, 1, 3, 1, 2, 3 };
+const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+struct SceneObject {
+	BatchKey key;
+	float x, y, scale, speed;
+	bool dynamic;
+	MeshAllocation mesh;	// for the unbatched path
+};
+
+// column major scale, rotation around z and translation
+void objectTransform(const SceneObject& object, float time, float* m) {
+	float angle = object.dynamic ? time * object.speed : 0.0f;
+	float c = std::cos(angle) * object.scale, s = std::sin(angle) * object.scale;
+	for (int i = 0; i < 16; i++) {
+		m[i] = identity[i];
+	}
+	m[0] = c;
+	m[1] = s;
+	m[4] = -s;
+	m[5] = c;
+	m[12] = object.x;
+	m[13] = object.y;
+}
+
+// 4x4 texture of a single color
+unsigned int makeTexture(std::mt19937& rng) {
+	unsigned char pixels[4 * 4 * 4];
+	unsigned char r = (unsigned char)(rng() & 0xff), g = (unsigned char)(rng() & 0xff), b = (unsigned char)(rng() & 0xff);
+	for (int i = 0; i < 16; i++) {
+		pixels[i * 4] = r;
+		pixels[i * 4 + 1] = g;
+		pixels[i * 4 + 2] = b;
+		pixels[i * 4 + 3] = 255;
+	}
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	return texture;
+}
+
+// usage: batching [object count]
+// draws a scene of textured quads with a draw per object, then with static
+// objects merged at load time and moving ones batched every frame
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("batching", 512, 512);
+	if (!window) {
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	int objectCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+	std::mt19937 rng(11);
+
+	// separate program objects, as distinct materials would have
+	std::string vertPath = shaderPath + "batch.vs";
+	std::string fragPath = shaderPath + "batch.fs";
+	std::vector<Shader> shaders;
+	for (int p = 0; p < PROGRAMS; p++) {
+		shaders.emplace_back(vertPath.c_str(), fragPath.c_str());
+	}
+	std::vector<unsigned int> textures;
+	for (int t = 0; t < TEXTURES; t++) {
+		textures.push_back(makeTexture(rng));
+	}
+
+	std::uniform_real_distribution<float> position(-1.0f, 1.0f), unit(0.0f, 1.0f);
+	std::vector<SceneObject> objects(objectCount);
+	for (SceneObject& object : objects) {
+		object.key.program = shaders[rng() % PROGRAMS].ID;
+		object.key.textures[0] = textures[rng() % TEXTURES];
+		object.x = position(rng);
+		object.y = position(rng);
+		object.scale = 0.01f + 0.02f * unit(rng);
+		object.speed = position(rng) * 4.0f;
+		object.dynamic = unit(rng) < DYNAMIC_SHARE;
+	}
+
+	// unbatched: every object is its own mesh, drawn with its own model matrix
+	MeshPool<BatchVertex> pool(1 << 18, 1 << 18, shaders[0].ID);
+	for (SceneObject& object : objects) {
+		object.mesh = pool.add(quadVertices, 4, quadIndices, 6);
+	}
+
+	// batched: static objects merged once, dynamic ones every frame
+	StaticBatcher<BatchVertex> staticBatcher(1 << 18, 1 << 18, shaders[0].ID);
+	for (const SceneObject& object : objects) {
+		if (!object.dynamic) {
+			float transform[16];
+			objectTransform(object, 0.0f, transform);
+			staticBatcher.add(object.key, quadVertices, 4, quadIndices, 6, transform);
+		}
+	}
+	staticBatcher.build();
+	DynamicBatcher<BatchVertex> dynamicBatcher(4 << 20, 2 << 20, shaders[0].ID);
+
+	for (const Shader& shader : shaders) {
+		shader.use();
+		shader.setInt("texture1", 0);
+	}
+
+	// the unbatched path sets state only when it changes, as a sorted renderer would not
+	unsigned int unbatchedDraws = 0, unbatchedChanges = 0;
+	auto drawUnbatched = [&](float time) {
+		pool.beginFrame();
+		unbatchedDraws = unbatchedChanges = 0;
+		const BatchKey* current = nullptr;
+		for (const SceneObject& object : objects) {
+			if (!current || !(*current == object.key)) {
+				applyBatchKey(object.key);
+				current = &object.key;
+				unbatchedChanges++;
+			}
+			float transform[16];
+			objectTransform(object, time, transform);
+			glUniformMatrix4fv(glGetUniformLocation(object.key.program, "model"), 1, GL_FALSE, transform);
+			pool.draw(object.mesh);
+			unbatchedDraws++;
+		}
+	};
+
+	// batched vertices are in world space
+	auto setIdentity = [&](const BatchKey& key) {
+		applyBatchKey(key);
+		glUniformMatrix4fv(glGetUniformLocation(key.program, "model"), 1, GL_FALSE, identity);
+	};
+	std::vector<float> dynamicTransforms(objects.size() * 16);
+	auto drawBatched = [&](float time) {
+		staticBatcher.render(setIdentity);
+		dynamicBatcher.beginFrame();
+		for (size_t i = 0; i < objects.size(); i++) {
+			if (objects[i].dynamic) {
+				float* transform = &dynamicTransforms[i * 16];
+				objectTransform(objects[i], time, transform);
+				dynamicBatcher.submit(objects[i].key, quadVertices, 4, quadIndices, 6, transform);
+			}
+		}
+		dynamicBatcher.render(setIdentity);
+		dynamicBatcher.endFrame();
+	};
+
+	auto timeFrames = [&](auto&& drawFrame) {
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			drawFrame(frame / 60.0f);
+		}
+		glFinish();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+	};
+
+	double unbatchedMs = timeFrames(drawUnbatched);
+	double batchedMs = timeFrames(drawBatched);
+	BatchStats staticStats = staticBatcher.getStats();
+	BatchStats dynamicStats = dynamicBatcher.getStats();
+
+	std::cout << objectCount << " objects (" << dynamicStats.objects << " moving), "
+		<< PROGRAMS << " programs x " << TEXTURES << " textures, " << FRAMES << " frames" << std::endl;
+	std::cout << std::left << std::setw(12) << "path"
+		<< std::right << std::setw(12) << "draw calls"
+		<< std::setw(15) << "state changes"
+		<< std::setw(11) << "ms/frame" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< std::left << std::setw(12) << "unbatched" << std::right << std::setw(12) << unbatchedDraws
+		<< std::setw(15) << unbatchedChanges << std::setw(11) << unbatchedMs << std::endl;
+	std::cout << std::left << std::setw(12) << "batched" << std::right << std::setw(12) << staticStats.drawCalls + dynamicStats.drawCalls
+		<< std::setw(15) << staticStats.stateChanges + dynamicStats.stateChanges << std::setw(11) << batchedMs << std::endl;
+	std::cout << "  static    " << std::setw(12) << staticStats.drawCalls << " draws for " << staticStats.objects << " objects" << std::endl;
+	std::cout << "  dynamic   " << std::setw(12) << dynamicStats.drawCalls << " draws for " << dynamicStats.objects << " objects";
+	if (dynamicStats.dropped > 0) {
+		std::cout << ", " << dynamicStats.dropped << " dropped";
+	}
+	std::cout << std::endl;
+
+	dynamicBatcher.clear();
+	staticBatcher.clear();
+	pool.clear();
+	glDeleteTextures((GLsizei)textures.size(), textures.data());
+	for (const Shader& shader : shaders) {
+		glDeleteProgram(shader.ID);
+	}
+	glfwTerminate();
+	return 0;
+}
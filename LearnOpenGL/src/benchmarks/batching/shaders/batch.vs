@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// identity for batched draws, whose vertices are already in world space
+uniform mat4 model;
+
+out vec2 TexCoord;
+
+void main()
+{
+	TexCoord = aTexCoord;
+	gl_Position = model * vec4(aPos, 1.0);
+}
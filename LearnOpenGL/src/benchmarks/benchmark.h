@@ -0,0 +1,80 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// scaffolding shared by the benchmarks; the code being measured lives in
+// dependencies/include/learnopengl
+
+// hidden window that only provides a GL 3.3 core context, current and with
+// glad loaded. returns nullptr, with GLFW terminated, when either fails
+inline GLFWwindow* createBenchmarkWindow(const char* name, int width = 64, int height = 64) {
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(width, height, name, NULL, NULL);
+	if (window == nullptr) {
+		std::cout << "Failed to initialize GLFW window" << std::endl;
+		glfwTerminate();
+		return nullptr;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		glfwTerminate();
+		return nullptr;
+	}
+	return window;
+}
+
+// one grid point of makeSphere; u and v run over [0, 1] around and down
+struct SpherePoint {
+	float position[3];
+	float normal[3];
+	float u, v;
+};
+
+// sphere of size x size grid points, row by row from the top. bumpiness adds
+// 8 x 8 bumps of that fraction of the radius, which gives simplifiers and
+// clusterers some curvature to work with. indices, if given, get two counter
+// clockwise triangles per grid cell
+inline std::vector<SpherePoint> makeSphere(int size, float radius = 1.0f, float bumpiness = 0.0f,
+	std::vector<unsigned int>* indices = nullptr) {
+	const float pi = 3.14159265f;
+	std::vector<SpherePoint> points((size_t)size * size);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			SpherePoint& point = points[(size_t)y * size + x];
+			point.u = (float)x / (size - 1);
+			point.v = (float)y / (size - 1);
+			float theta = point.u * 2.0f * pi, phi = point.v * pi;
+			point.normal[0] = std::sin(phi) * std::cos(theta);
+			point.normal[1] = std::cos(phi);
+			point.normal[2] = std::sin(phi) * std::sin(theta);
+			float distance = radius * (1.0f + bumpiness * std::sin(8.0f * theta) * std::sin(8.0f * phi));
+			for (int c = 0; c < 3; c++) {
+				point.position[c] = point.normal[c] * distance;
+			}
+		}
+	}
+	if (indices) {
+		for (int y = 0; y < size - 1; y++) {
+			for (int x = 0; x < size - 1; x++) {
+				unsigned int a = y * size + x, b = a + 1, c = a + size, d = c + 1;
+				unsigned int triangles[] = { a, c, b, b, c, d };
+				indices->insert(indices->end(), triangles, triangles + 6);
+			}
+		}
+	}
+	return points;
+}
+
+#endif
@@ -0,0 +1,194 @@
+// BVH build time and query throughput against brute force, no GL required
+//
+// usage: bvh [object count] [threads]
+// fills a cube with object boxes (1M by default), builds the BVH on one thread
+// and on all threads (or the given count), refits it after every object moved,
+// and times frustum queries, ray picks and radius queries against testing
+// every object. builds and refits are rated in objects per second, queries in
+// queries (or frames) per second
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/frustum.h"
+#include "../../../dependencies/include/learnopengl/frustum_culling.h"
+#include "../../../dependencies/include/learnopengl/bvh.h"
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+
+const int FRAMES = 100;
+const int RAYS = 100000;
+const int RADIUS_QUERIES = 100000;
+const int BRUTE_FORCE_QUERIES = 100;	// the brute force ray and radius queries are timed on fewer queries
+const float FOV_Y = 0.785398f;			// 45 degrees
+const float ASPECT = 16.0f / 9.0f;
+const float WORLD_SIZE = 1000.0f;
+const float QUERY_RADIUS = 10.0f;
+
+// camera orbiting close to the center, so most of the scene is behind or beside it
+Frustum frameFrustum(int frame) {
+	float angle = frame * 0.0628f;
+	float eye[3] = { std::cos(angle) * WORLD_SIZE * 0.25f, WORLD_SIZE * 0.05f, std::sin(angle) * WORLD_SIZE * 0.25f };
+	Mat4 viewProjection = Mat4::perspective(FOV_Y, ASPECT, 0.1f, WORLD_SIZE * 0.5f)
+		* Mat4::lookAt(Vec3(eye[0], eye[1], eye[2]), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+	return extractFrustum(viewProjection.m);
+}
+
+template <typename Run>
+double timeMs(Run&& run) {
+	auto start = std::chrono::high_resolution_clock::now();
+	run();
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+	size_t objectCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+	unsigned int threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Aabb> boxes(objectCount);
+	for (Aabb& box : boxes) {
+		for (int c = 0; c < 3; c++) {
+			float center = position(random), extent = size(random);
+			box.min[c] = center - extent;
+			box.max[c] = center + extent;
+		}
+	}
+
+	std::cout << objectCount << " objects" << std::endl;
+	std::cout << std::left << std::setw(34) << "operation" << std::right << std::setw(12) << "ms"
+		<< std::setw(16) << "per second" << std::setw(12) << "results" << std::endl;
+	auto printRow = [](const std::string& name, double ms, double operations, size_t results) {
+		std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << ms << std::setw(16) << std::setprecision(0) << operations / ms * 1000.0
+			<< std::setw(12) << results << std::endl;
+	};
+
+	Bvh bvh;
+	for (unsigned int t : { 1u, threads }) {
+		double ms = timeMs([&]() {
+			bvh.build(boxes.data(), boxes.size(), t);
+		});
+		printRow("build, " + std::to_string(t) + " thread" + (t > 1 ? "s" : ""), ms, (double)objectCount, bvh.getNodes().size());
+		if (threads == 1) {
+			break;
+		}
+	}
+
+	// every object moves a little, as in a frame of animation
+	for (size_t i = 0; i < boxes.size(); i++) {
+		for (int c = 0; c < 3; c++) {
+			float offset = 0.5f * unit(random);
+			boxes[i].min[c] += offset;
+			boxes[i].max[c] += offset;
+		}
+		bvh.update((unsigned int)i, boxes[i]);
+	}
+	double ms = timeMs([&]() {
+		bvh.refit();
+	});
+	printRow("refit", ms, (double)objectCount, bvh.getNodes().size());
+
+	// frustum queries
+	std::vector<unsigned int> results;
+	size_t found = 0;
+	ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			results.clear();
+			found += bvh.queryFrustum(frameFrustum(frame), results);
+		}
+	}) / FRAMES;
+	printRow("frustum, BVH", ms, 1.0, found / FRAMES);
+
+	CullingBounds bounds;
+	bounds.reserve(boxes.size());
+	for (const Aabb& box : boxes) {
+		bounds.addBox(box.min, box.max);
+	}
+	found = 0;
+	ms = timeMs([&]() {
+		for (int frame = 0; frame < FRAMES; frame++) {
+			found += cullFrustum(frameFrustum(frame), bounds, results, 1);
+		}
+	}) / FRAMES;
+	printRow("frustum, SoA brute force", ms, 1.0, found / FRAMES);
+
+	// ray picks from random points in random directions
+	std::vector<float> rays(RAYS * 6);
+	for (int r = 0; r < RAYS; r++) {
+		float* ray = &rays[r * 6];
+		float length = 0.0f;
+		for (int c = 0; c < 3; c++) {
+			ray[c] = position(random);
+			ray[3 + c] = unit(random);
+			length += ray[3 + c] * ray[3 + c];
+		}
+		length = std::sqrt(length);
+		for (int c = 3; c < 6; c++) {
+			ray[c] /= length;
+		}
+	}
+	found = 0;
+	ms = timeMs([&]() {
+		for (int r = 0; r < RAYS; r++) {
+			float distance = WORLD_SIZE;
+			found += bvh.raycast(&rays[r * 6], &rays[r * 6 + 3], distance) != BVH_NO_HIT;
+		}
+	});
+	printRow("ray picks, BVH", ms, RAYS, found);
+
+	found = 0;
+	ms = timeMs([&]() {
+		for (int r = 0; r < BRUTE_FORCE_QUERIES; r++) {
+			const float* origin = &rays[r * 6];
+			float inverse[3] = { 1.0f / rays[r * 6 + 3], 1.0f / rays[r * 6 + 4], 1.0f / rays[r * 6 + 5] };
+			float distance = WORLD_SIZE;
+			bool hit = false;
+			for (const Aabb& box : boxes) {
+				float entry = Bvh::rayBox(origin, inverse, box.min, box.max, distance);
+				if (entry >= 0.0f) {
+					distance = entry;
+					hit = true;
+				}
+			}
+			found += hit;
+		}
+	});
+	printRow("ray picks, brute force", ms, BRUTE_FORCE_QUERIES, found);
+
+	// neighbours within QUERY_RADIUS of random points
+	found = 0;
+	ms = timeMs([&]() {
+		for (int q = 0; q < RADIUS_QUERIES; q++) {
+			results.clear();
+			found += bvh.querySphere(&rays[(q % RAYS) * 6], QUERY_RADIUS, results);
+		}
+	});
+	printRow("radius queries, BVH", ms, RADIUS_QUERIES, found / RADIUS_QUERIES);
+
+	found = 0;
+	ms = timeMs([&]() {
+		for (int q = 0; q < BRUTE_FORCE_QUERIES; q++) {
+			const float* center = &rays[q * 6];
+			for (const Aabb& box : boxes) {
+				float distance = 0.0f;
+				for (int c = 0; c < 3; c++) {
+					float d = std::max(std::max(box.min[c] - center[c], center[c] - box.max[c]), 0.0f);
+					distance += d * d;
+				}
+				found += distance <= QUERY_RADIUS * QUERY_RADIUS;
+			}
+		}
+	});
+	printRow("radius queries, brute force", ms, BRUTE_FORCE_QUERIES, found / BRUTE_FORCE_QUERIES);
+	return 0;
+}
@@ -0,0 +1,94 @@
+// depth buffer precision of the camera's depth modes, no GL required
+//
+// usage: depth_precision [near plane]
+// runs points straight ahead of a Camera through its projection the way the
+// GPU would, in float, and stores the window depth as 24 bit fixed point or
+// as a 32 bit float. for each mode and format the table shows the smallest
+// gap between two surfaces at a given distance that still keeps them apart
+// in the depth buffer; the smaller, the less z fighting. "-" means the
+// distance is past the far plane or the surfaces never separate
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../../../dependencies/include/learnopengl/camera.h"
+
+const float FAR_PLANE = 10000.0f;
+const float DISTANCES[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f };
+
+struct Setup {
+	const char* name;
+	DepthMode mode;
+	float farPlane;		// 0 is infinite
+	bool floatDepth;
+};
+
+// the value a depth buffer of the given format would hold for a point
+// distance units in front of the camera
+int64_t storedDepth(const Camera& camera, float distance, bool floatDepth) {
+	Vec4 clip = camera.getViewProjection() * Vec4(0.0f, 0.0f, -distance, 1.0f);
+	float depth = clip.z / clip.w;
+	if (camera.getDepthMode() != DEPTH_REVERSED_ZERO_TO_ONE) {
+		depth = depth * 0.5f + 0.5f;
+	}
+	depth = std::min(1.0f, std::max(0.0f, depth));
+	if (!floatDepth) {
+		return (int64_t)std::lround((double)depth * 16777215.0);
+	}
+	int32_t bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+	return bits;		// positive floats order the same as their bits
+}
+
+// smallest gap behind distance that stores a depth on the far side of the
+// one at distance, or 0 when none up to distance itself does
+float resolvableGap(const Camera& camera, float distance, bool floatDepth) {
+	bool reversed = camera.getDepthMode() != DEPTH_STANDARD;
+	int64_t front = storedDepth(camera, distance, floatDepth);
+	for (float gap = distance * 1e-8f; gap <= distance; gap *= 1.02f) {
+		int64_t back = storedDepth(camera, distance + gap, floatDepth);
+		if (reversed ? back < front : back > front) {
+			return gap;
+		}
+	}
+	return 0.0f;
+}
+
+int main(int argc, char* argv[]) {
+	float nearPlane = argc > 1 ? std::max(1e-4f, (float)std::atof(argv[1])) : 0.1f;
+
+	const Setup setups[] = {
+		{ "standard, far, D24", DEPTH_STANDARD, FAR_PLANE, false },
+		{ "standard, far, D32F", DEPTH_STANDARD, FAR_PLANE, true },
+		{ "standard, infinite, D32F", DEPTH_STANDARD, 0.0f, true },
+		{ "reversed -1..1, infinite, D32F", DEPTH_REVERSED, 0.0f, true },
+		{ "reversed 0..1, infinite, D24", DEPTH_REVERSED_ZERO_TO_ONE, 0.0f, false },
+		{ "reversed 0..1, infinite, D32F", DEPTH_REVERSED_ZERO_TO_ONE, 0.0f, true }
+	};
+
+	std::cout << "near plane " << nearPlane << ", far plane " << FAR_PLANE << " where finite; smallest separable gap at distance" << std::endl;
+	std::cout << std::left << std::setw(32) << "mode" << std::right;
+	for (float distance : DISTANCES) {
+		std::cout << std::setw(11) << distance;
+	}
+	std::cout << std::endl;
+
+	for (const Setup& setup : setups) {
+		Camera camera(1.047198f, 16.0f / 9.0f, nearPlane, setup.farPlane, setup.mode);
+		std::cout << std::left << std::setw(32) << setup.name << std::right;
+		for (float distance : DISTANCES) {
+			float gap = setup.farPlane > 0.0f && distance >= setup.farPlane ? 0.0f : resolvableGap(camera, distance, setup.floatDepth);
+			std::ostringstream text;
+			text << std::setprecision(3) << gap;
+			std::cout << std::setw(11) << (gap > 0.0f ? text.str() : std::string("-"));
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+// frustum culling throughput over a large object set, no GL required
+//
+// usage: frustum_culling [object count] [threads]
+// a camera orbits inside a cube filled with objects (1M by default) and each
+// frame culls them with sphereInFrustum over an array of structs, then with
+// the structure of arrays culler on one thread and on all threads (or the
+// given count), for bounding spheres and for boxes
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/frustum.h"
+#include "../../../dependencies/include/learnopengl/frustum_culling.h"
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+
+const int FRAMES = 100;
+const float FOV_Y = 0.785398f;	// 45 degrees
+const float ASPECT = 16.0f / 9.0f;
+const float WORLD_SIZE = 1000.0f;
+
+struct SceneObject {
+	float center[3];
+	float radius;
+};
+
+Frustum frameFrustum(int frame) {
+	float angle = frame * 0.0628f;
+	float eye[3] = { std::cos(angle) * WORLD_SIZE * 0.25f, WORLD_SIZE * 0.05f, std::sin(angle) * WORLD_SIZE * 0.25f };
+	Mat4 viewProjection = Mat4::perspective(FOV_Y, ASPECT, 0.1f, WORLD_SIZE)
+		* Mat4::lookAt(Vec3(eye[0], eye[1], eye[2]), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+	return extractFrustum(viewProjection.m);
+}
+
+// average ms per frame of cull(frustum), which returns the visible count
+template <typename Cull>
+double timeFrames(Cull&& cull, size_t& visible) {
+	visible = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		visible += cull(frameFrustum(frame));
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	visible /= FRAMES;
+	return ms / FRAMES;
+}
+
+int main(int argc, char* argv[]) {
+	size_t objectCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+	unsigned int threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(-WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f);
+	std::uniform_real_distribution<float> size(0.5f, 4.0f);
+	std::vector<SceneObject> objects(objectCount);
+	CullingBounds spheres, boxes;
+	spheres.reserve(objectCount);
+	boxes.reserve(objectCount);
+	for (SceneObject& object : objects) {
+		for (float& c : object.center) {
+			c = position(random);
+		}
+		object.radius = size(random);
+		spheres.addSphere(object.center, object.radius);
+		float minCorner[3], maxCorner[3];
+		for (int c = 0; c < 3; c++) {
+			minCorner[c] = object.center[c] - object.radius * 0.7f;
+			maxCorner[c] = object.center[c] + object.radius * 0.7f;
+		}
+		boxes.addBox(minCorner, maxCorner);
+	}
+
+	std::vector<unsigned int> visible(objectCount);
+	size_t visibleCount = 0;
+	std::cout << objectCount << " objects, " << FRAMES << " frames, " << frustumCullingPath() << " culling loop" << std::endl;
+	std::cout << std::left << std::setw(30) << "culler" << std::right << std::setw(10) << "ms"
+		<< std::setw(14) << "Mobjects/s" << std::setw(12) << "visible" << std::endl;
+	auto printRow = [&](const std::string& name, double ms) {
+		std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << ms << std::setw(14) << std::setprecision(1) << objectCount / ms / 1000.0
+			<< std::setw(12) << visibleCount << std::endl;
+	};
+
+	double ms = timeFrames([&](const Frustum& frustum) {
+		size_t count = 0;
+		for (size_t i = 0; i < objects.size(); i++) {
+			if (sphereInFrustum(frustum, objects[i].center, objects[i].radius)) {
+				visible[count++] = (unsigned int)i;
+			}
+		}
+		return count;
+	}, visibleCount);
+	printRow("spheres, scalar AoS", ms);
+
+	for (unsigned int t : { 1u, threads }) {
+		ms = timeFrames([&](const Frustum& frustum) {
+			return cullFrustum(frustum, spheres, visible, t);
+		}, visibleCount);
+		printRow("spheres, SoA " + std::to_string(t) + " thread" + (t > 1 ? "s" : ""), ms);
+		ms = timeFrames([&](const Frustum& frustum) {
+			return cullFrustum(frustum, boxes, visible, t);
+		}, visibleCount);
+		printRow("boxes, SoA " + std::to_string(t) + " thread" + (t > 1 ? "s" : ""), ms);
+		if (threads == 1) {
+			break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include "../../../dependencies/include/learnopengl/hdr_image.h"
+#include "../../../dependencies/include/learnopengl/texture_manager.h"
+#include "../benchmark.h"
+
+const int ITERATIONS = 10;
+
+// synthetic HDR image with values spanning several orders of magnitude
+HdrImage makeTestImage(int width, int height) {
+	HdrImage image;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize((size_t)width * height * 4);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			float* p = &image.pixels[((size_t)y * width + x) * 4];
+			float intensity = std::pow(2.0f, 16.0f * x / width - 8.0f);
+			p[0] = intensity;
+			p[1] = intensity * (float)y / height;
+			p[2] = intensity * 0.25f;
+			p[3] = 1.0f;
+		}
+	}
+	return image;
+}
+
+// usage: hdr_upload [image]
+// compares video memory, CPU conversion and upload time of the three HDR formats
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("hdr_upload");
+	if (!window) {
+		return -1;
+	}
+
+	HdrImage image = argc > 1 ? loadHdrImage(argv[1]) : makeTestImage(2048, 2048);
+	if (!image.valid()) {
+		glfwTerminate();
+		return -1;
+	}
+	std::cout << "image: " << image.width << "x" << image.height << ", " << ITERATIONS << " iterations" << std::endl;
+	std::cout << std::left << std::setw(10) << "format"
+		<< std::right << std::setw(14) << "VRAM (KiB)"
+		<< std::setw(16) << "convert (ms)"
+		<< std::setw(15) << "upload (ms)" << std::endl;
+
+	const HdrFormat formats[] = { HdrFormat::RGBA32F, HdrFormat::RGBA16F, HdrFormat::RGB9_E5 };
+	const char* names[] = { "RGBA32F", "RGBA16F", "RGB9_E5" };
+
+	for (int f = 0; f < 3; f++) {
+		double convertMs = 0.0, uploadMs = 0.0;
+		for (int i = 0; i < ITERATIONS; i++) {
+			auto start = std::chrono::high_resolution_clock::now();
+			std::vector<HdrLevel> levels = convertHdrImage(image, formats[f]);
+			auto converted = std::chrono::high_resolution_clock::now();
+
+			unsigned int texture;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glFinish();
+			auto uploadStart = std::chrono::high_resolution_clock::now();
+			uploadHdrLevels(levels, formats[f]);
+			glFinish();
+			auto uploaded = std::chrono::high_resolution_clock::now();
+			glDeleteTextures(1, &texture);
+
+			convertMs += std::chrono::duration<double, std::milli>(converted - start).count();
+			uploadMs += std::chrono::duration<double, std::milli>(uploaded - uploadStart).count();
+		}
+
+		size_t bytes = TextureManager::textureBytes(image.width, image.height, hdrInternalFormat(formats[f]),
+			TextureManager::mipLevels(image.width, image.height));
+		std::cout << std::left << std::setw(10) << names[f]
+			<< std::right << std::setw(14) << bytes / 1024
+			<< std::setw(16) << std::fixed << std::setprecision(2) << convertMs / ITERATIONS
+			<< std::setw(15) << uploadMs / ITERATIONS << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,323 @@
+// decode throughput of the bundled stb_image, no GL required
+//
+// usage: image_decode [--threads N] [--iterations N] [--json out.json] [files or directories...]
+// every file is read into memory once, then decoded with stbi_load_from_memory
+// (stbi_loadf_from_memory for .hdr) single threaded and with N threads.
+// built on its own by ImageDecode.vcxproj, which leaves out stb_image.cpp so
+// this file can compile stb_image with counting allocators
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// the implementation is compiled here rather than taken from stb_image.cpp
+// so its allocations can be counted
+void* countedMalloc(size_t size);
+void* countedRealloc(void* p, size_t size);
+void countedFree(void* p);
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(size)		countedMalloc(size)
+#define STBI_REALLOC(p, size)	countedRealloc(p, size)
+#define STBI_FREE(p)			countedFree(p)
+#include "../../../dependencies/include/stb_image/stb_image.h"
+
+/////////////////////////////
+///// ALLOCATION COUNTS /////
+/////////////////////////////
+std::atomic<unsigned long long> allocationCount{ 0 };
+std::atomic<long long> liveBytes{ 0 };
+std::atomic<long long> peakLiveBytes{ 0 };
+
+// every block is prefixed with its size so frees can be accounted
+const size_t HEADER_SIZE = 16;
+
+void trackAllocation(long long bytes) {
+	long long live = liveBytes.fetch_add(bytes) + bytes;
+	long long peak = peakLiveBytes.load();
+	while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live)) {}
+}
+
+void* countedMalloc(size_t size) {
+	unsigned char* block = (unsigned char*)std::malloc(size + HEADER_SIZE);
+	if (!block) {
+		return nullptr;
+	}
+	*(size_t*)block = size;
+	allocationCount++;
+	trackAllocation((long long)size);
+	return block + HEADER_SIZE;
+}
+
+void* countedRealloc(void* p, size_t size) {
+	if (!p) {
+		return countedMalloc(size);
+	}
+	unsigned char* block = (unsigned char*)p - HEADER_SIZE;
+	size_t oldSize = *(size_t*)block;
+	block = (unsigned char*)std::realloc(block, size + HEADER_SIZE);
+	if (!block) {
+		return nullptr;
+	}
+	*(size_t*)block = size;
+	allocationCount++;
+	trackAllocation((long long)size - (long long)oldSize);
+	return block + HEADER_SIZE;
+}
+
+void countedFree(void* p) {
+	if (!p) {
+		return;
+	}
+	unsigned char* block = (unsigned char*)p - HEADER_SIZE;
+	liveBytes -= (long long)*(size_t*)block;
+	std::free(block);
+}
+
+// peak resident set size of the whole process so far; it never goes down,
+// so it only says something about the run as a whole
+size_t peakRSS() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+
+//////////////////
+///// CORPUS /////
+//////////////////
+struct EncodedImage {
+	std::string path;
+	std::string format;
+	std::vector<unsigned char> bytes;
+};
+
+struct FormatResult {
+	int files = 0;
+	size_t encodedBytes = 0;
+	unsigned long long pixels = 0;
+	double singleSeconds = 0.0;
+	double multiSeconds = 0.0;
+	unsigned long long allocations = 0;
+	long long peakHeapBytes = 0;		// stb_image's own peak, decoding one image at a time
+	long long peakHeapMultiBytes = 0;	// the same with N decodes in flight
+	int failures = 0;
+};
+
+std::string formatOf(const std::filesystem::path& path) {
+	std::string extension = path.extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	if (extension == ".jpg" || extension == ".jpeg") return "jpeg";
+	if (extension == ".png") return "png";
+	if (extension == ".tga") return "tga";
+	if (extension == ".hdr") return "hdr";
+	if (extension == ".bmp") return "bmp";
+	return "";
+}
+
+void addFile(const std::filesystem::path& path, std::vector<EncodedImage>& corpus) {
+	std::string format = formatOf(path);
+	if (format.empty()) {
+		return;
+	}
+	std::ifstream file(path, std::ios::binary);
+	EncodedImage image{ path.string(), format, std::vector<unsigned char>(std::istreambuf_iterator<char>(file), {}) };
+	if (!image.bytes.empty()) {
+		corpus.push_back(std::move(image));
+	}
+}
+
+// decodes one image and returns its pixel count, or 0 on failure
+unsigned long long decode(const EncodedImage& image) {
+	int width, height, nChannels;
+	void* pixels;
+	if (image.format == "hdr") {
+		pixels = stbi_loadf_from_memory(image.bytes.data(), (int)image.bytes.size(), &width, &height, &nChannels, 0);
+	}
+	else {
+		pixels = stbi_load_from_memory(image.bytes.data(), (int)image.bytes.size(), &width, &height, &nChannels, 0);
+	}
+	if (!pixels) {
+		return 0;
+	}
+	stbi_image_free(pixels);
+	return (unsigned long long)width * height;
+}
+
+// decodes every image iterations times across threads and returns the elapsed seconds
+double decodeAll(const std::vector<const EncodedImage*>& images, int iterations, int threads) {
+	std::atomic<size_t> next{ 0 };
+	size_t jobs = images.size() * iterations;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back([&]() {
+			for (size_t job = next++; job < jobs; job = next++) {
+				decode(*images[job % images.size()]);
+			}
+		});
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void writeJson(const std::string& path, const std::map<std::string, FormatResult>& results, int iterations, int threads) {
+	std::ofstream out(path);
+	out << "{\n  \"iterations\": " << iterations << ",\n  \"threads\": " << threads << ",\n  \"formats\": {";
+	bool first = true;
+	for (const auto& entry : results) {
+		const FormatResult& r = entry.second;
+		double megapixels = r.pixels * (double)iterations / 1e6;
+		double megabytes = r.encodedBytes * (double)iterations / 1e6;
+		out << (first ? "\n" : ",\n") << "    \"" << entry.first << "\": {"
+			<< "\"files\": " << r.files
+			<< ", \"failures\": " << r.failures
+			<< ", \"encoded_bytes\": " << r.encodedBytes
+			<< ", \"pixels\": " << r.pixels
+			<< ", \"single_mpix_per_s\": " << megapixels / r.singleSeconds
+			<< ", \"single_mb_per_s\": " << megabytes / r.singleSeconds
+			<< ", \"multi_mpix_per_s\": " << megapixels / r.multiSeconds
+			<< ", \"multi_mb_per_s\": " << megabytes / r.multiSeconds
+			<< ", \"allocations_per_image\": " << (double)r.allocations / r.files
+			<< ", \"peak_heap_bytes\": " << r.peakHeapBytes
+			<< ", \"peak_heap_multi_bytes\": " << r.peakHeapMultiBytes << "}";
+		first = false;
+	}
+	out << "\n  },\n  \"process_peak_rss_bytes\": " << peakRSS() << "\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+	int iterations = 5;
+	int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	std::string jsonPath;
+	std::vector<std::string> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--iterations" && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--json" && i + 1 < argc) jsonPath = argv[++i];
+		else inputs.push_back(arg);
+	}
+	if (inputs.empty()) {
+		inputs.push_back((std::filesystem::current_path() / "resources" / "textures").string());
+	}
+
+	std::vector<EncodedImage> corpus;
+	for (const std::string& input : inputs) {
+		if (std::filesystem::is_directory(input)) {
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
+				if (entry.is_regular_file()) {
+					addFile(entry.path(), corpus);
+				}
+			}
+		}
+		else {
+			addFile(input, corpus);
+		}
+	}
+	if (corpus.empty()) {
+		std::cout << "No JPEG, PNG, TGA, BMP or HDR files found" << std::endl;
+		return -1;
+	}
+
+	// group the corpus by format
+	std::map<std::string, std::vector<const EncodedImage*>> byFormat;
+	for (const EncodedImage& image : corpus) {
+		byFormat[image.format].push_back(&image);
+	}
+
+	std::map<std::string, FormatResult> results;
+	for (const auto& entry : byFormat) {
+		FormatResult& r = results[entry.first];
+
+		// one counted pass for pixel counts, allocations and heap peak. the
+		// peak restarts from what is live now, so each format is measured alone
+		allocationCount = 0;
+		peakLiveBytes = liveBytes.load();
+		for (const EncodedImage* image : entry.second) {
+			unsigned long long pixels = decode(*image);
+			r.files++;
+			r.encodedBytes += image->bytes.size();
+			r.pixels += pixels;
+			if (pixels == 0) {
+				r.failures++;
+				std::cout << "Failed to decode: " << image->path << " (" << stbi_failure_reason() << ")" << std::endl;
+			}
+		}
+		r.allocations = allocationCount;
+		r.peakHeapBytes = peakLiveBytes;
+
+		r.singleSeconds = decodeAll(entry.second, iterations, 1);
+		peakLiveBytes = liveBytes.load();
+		r.multiSeconds = decodeAll(entry.second, iterations, threads);
+		r.peakHeapMultiBytes = peakLiveBytes;
+	}
+
+	std::cout << corpus.size() << " files, " << iterations << " iterations, " << threads << " threads, process peak RSS "
+		<< peakRSS() / 1024 << " KiB" << std::endl;
+	std::cout << std::left << std::setw(8) << "format"
+		<< std::right << std::setw(7) << "files"
+		<< std::setw(12) << "Mpix/s x1"
+		<< std::setw(12) << "MB/s x1"
+		<< std::setw(12) << "Mpix/s xN"
+		<< std::setw(12) << "MB/s xN"
+		<< std::setw(12) << "allocs/img"
+		<< std::setw(13) << "heap KiB x1"
+		<< std::setw(13) << "heap KiB xN" << std::endl;
+	for (const auto& entry : results) {
+		const FormatResult& r = entry.second;
+		double megapixels = r.pixels * (double)iterations / 1e6;
+		double megabytes = r.encodedBytes * (double)iterations / 1e6;
+		std::cout << std::left << std::setw(8) << entry.first
+			<< std::right << std::setw(7) << r.files
+			<< std::fixed << std::setprecision(1)
+			<< std::setw(12) << megapixels / r.singleSeconds
+			<< std::setw(12) << megabytes / r.singleSeconds
+			<< std::setw(12) << megapixels / r.multiSeconds
+			<< std::setw(12) << megabytes / r.multiSeconds
+			<< std::setw(12) << (double)r.allocations / r.files
+			<< std::setw(13) << r.peakHeapBytes / 1024
+			<< std::setw(13) << r.peakHeapMultiBytes / 1024 << std::endl;
+	}
+
+	if (!jsonPath.empty()) {
+		writeJson(jsonPath, results, iterations, threads);
+		std::cout << "wrote " << jsonPath << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,219 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_pool.h"
+#include "../../../dependencies/include/learnopengl/instanced_renderer.h"
+#include "../benchmark.h"
+
+const int FRAMES = 100;
+const int TEXTURES = 4;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/instancing/shaders/";
+
+typedef VertexLayout<Position3f, TexCoord2f> QuadVertex;
+
+const float quadVertices[] = {
+	// positions			// texture coords
+	 0.5f,  0.5f, 0.0f,		1.0f, 1.0f,
+	 0.5f, -0.5f, 0.0f,		1.0f, 0.0f,
+	-0.5f, -0.5f, 0.0f,		0.0f, 0.0f,
+	-0.5f,  0.5f, 0.0f,		0.0f, 1.0f
+};
+const unsigned int quadIndices[] = { 0, 1, 3, 1, 2, 3 };
+
+const float triangleVertices[] = {
+	// positions			// texture coords
+	-0.5f, -0.5f, 0.0f,		0.0f, 0.0f,
+	 0.5f, -0.5f, 0.0f,		1.0f, 0.0f,
+	 0.0f,  0.5f, 0.0f,		0.5f, 1.0f
+};
+const unsigned int triangleIndices[] = { 0, 1, 2 };
+
+struct SceneObject {
+	int mesh;				// 0 quad, 1 triangle
+	int texture;
+	float x, y, scale, speed;
+	float color[4];
+};
+
+// column major scale, rotation around z and translation
+void objectTransform(const SceneObject& object, float time, float* m) {
+	float angle = time * object.speed;
+	float c = std::cos(angle) * object.scale, s = std::sin(angle) * object.scale;
+	for (int i = 0; i < 16; i++) {
+		m[i] = 0.0f;
+	}
+	m[0] = c;
+	m[1] = s;
+	m[4] = -s;
+	m[5] = c;
+	m[10] = 1.0f;
+	m[12] = object.x;
+	m[13] = object.y;
+	m[15] = 1.0f;
+}
+
+// 4x4 checkerboard
+unsigned int makeTexture(std::mt19937& rng) {
+	unsigned char pixels[4 * 4 * 4];
+	unsigned char shade = (unsigned char)(128 + (rng() & 0x7f));
+	for (int i = 0; i < 16; i++) {
+		unsigned char value = ((i + i / 4) & 1) ? shade : 255;
+		pixels[i * 4] = pixels[i * 4 + 1] = pixels[i * 4 + 2] = value;
+		pixels[i * 4 + 3] = 255;
+	}
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	return texture;
+}
+
+// usage: instancing [instance count]
+// draws many moving copies of two meshes with a draw per object, then with one
+// instanced draw per mesh and texture pair
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("instancing", 512, 512);
+	if (!window) {
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	int instanceCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+	std::mt19937 rng(5);
+
+	std::string fragPath = shaderPath + "quad.fs";
+	Shader individualShader((shaderPath + "quad.vs").c_str(), fragPath.c_str());
+	Shader instancedShader((shaderPath + "instanced.vs").c_str(), fragPath.c_str());
+	std::vector<unsigned int> textures;
+	for (int t = 0; t < TEXTURES; t++) {
+		textures.push_back(makeTexture(rng));
+	}
+
+	std::uniform_real_distribution<float> position(-1.0f, 1.0f), unit(0.0f, 1.0f);
+	std::vector<SceneObject> objects(instanceCount);
+	for (SceneObject& object : objects) {
+		object.mesh = (int)(rng() % 2);
+		object.texture = (int)(rng() % TEXTURES);
+		object.x = position(rng);
+		object.y = position(rng);
+		object.scale = 0.005f + 0.01f * unit(rng);
+		object.speed = position(rng) * 4.0f;
+		object.color[0] = unit(rng);
+		object.color[1] = unit(rng);
+		object.color[2] = unit(rng);
+		object.color[3] = 1.0f;
+	}
+
+	// individual: both meshes in a pool, drawn once per object with uniforms
+	MeshPool<QuadVertex> pool(64, 64, individualShader.ID);
+	MeshAllocation poolMeshes[2] = {
+		pool.add(quadVertices, 4, quadIndices, 6),
+		pool.add(triangleVertices, 3, triangleIndices, 3)
+	};
+	int modelLocation = glGetUniformLocation(individualShader.ID, "model");
+	int colorLocation = glGetUniformLocation(individualShader.ID, "color");
+
+	// instanced: the same meshes registered once, objects submitted every frame
+	InstancedRenderer<QuadVertex> renderer(instanceCount, instancedShader.ID);
+	int instancedMeshes[2] = {
+		renderer.addMesh(quadVertices, 4, quadIndices, 6),
+		renderer.addMesh(triangleVertices, 3, triangleIndices, 3)
+	};
+
+	individualShader.use();
+	individualShader.setInt("texture1", 0);
+	instancedShader.use();
+	instancedShader.setInt("texture1", 0);
+
+	// the individual path sorts objects once and sets state only when it changes,
+	// so the difference is the draw calls alone
+	std::vector<SceneObject> sorted = objects;
+	std::sort(sorted.begin(), sorted.end(), [](const SceneObject& a, const SceneObject& b) {
+		return a.texture < b.texture || (a.texture == b.texture && a.mesh < b.mesh);
+	});
+	unsigned int individualDraws = 0;
+	auto drawIndividual = [&](float time) {
+		pool.beginFrame();
+		glUseProgram(individualShader.ID);
+		individualDraws = 0;
+		int currentTexture = -1;
+		for (const SceneObject& object : sorted) {
+			if (object.texture != currentTexture) {
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, textures[object.texture]);
+				currentTexture = object.texture;
+			}
+			float transform[16];
+			objectTransform(object, time, transform);
+			glUniformMatrix4fv(modelLocation, 1, GL_FALSE, transform);
+			glUniform4fv(colorLocation, 1, object.color);
+			pool.draw(poolMeshes[object.mesh]);
+			individualDraws++;
+		}
+	};
+
+	auto drawInstanced = [&](float time) {
+		renderer.beginFrame();
+		for (const SceneObject& object : objects) {
+			BatchKey material;
+			material.program = instancedShader.ID;
+			material.textures[0] = textures[object.texture];
+			InstanceData instance;
+			objectTransform(object, time, instance.transform);
+			std::copy(object.color, object.color + 4, instance.color);
+			renderer.submit(instancedMeshes[object.mesh], material, instance);
+		}
+		renderer.render();
+		renderer.endFrame();
+	};
+
+	auto timeFrames = [&](auto&& drawFrame) {
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			drawFrame(frame / 60.0f);
+		}
+		glFinish();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+	};
+
+	double individualMs = timeFrames(drawIndividual);
+	double instancedMs = timeFrames(drawInstanced);
+	InstanceStats stats = renderer.getStats();
+
+	std::cout << instanceCount << " instances of 2 meshes, " << TEXTURES << " textures, " << FRAMES << " frames"
+		<< (glext.bufferStorage ? ", persistent instance stream" : "") << std::endl;
+	std::cout << std::left << std::setw(12) << "path"
+		<< std::right << std::setw(12) << "draw calls"
+		<< std::setw(11) << "ms/frame"
+		<< std::setw(10) << "speedup" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< std::left << std::setw(12) << "individual" << std::right << std::setw(12) << individualDraws
+		<< std::setw(11) << individualMs << std::setw(10) << 1.0 << std::endl;
+	std::cout << std::left << std::setw(12) << "instanced" << std::right << std::setw(12) << stats.drawCalls
+		<< std::setw(11) << instancedMs << std::setw(10) << individualMs / instancedMs << std::endl;
+
+	renderer.clear();
+	pool.clear();
+	glDeleteTextures((GLsizei)textures.size(), textures.data());
+	glDeleteProgram(individualShader.ID);
+	glDeleteProgram(instancedShader.ID);
+	glfwTerminate();
+	return 0;
+}
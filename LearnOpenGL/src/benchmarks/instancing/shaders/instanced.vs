@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per instance, advanced once per instance by glVertexAttribDivisor
+layout (location = 8) in mat4 aInstanceModel;
+layout (location = 12) in vec4 aInstanceColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main()
+{
+	TexCoord = aTexCoord;
+	Color = aInstanceColor;
+	gl_Position = aInstanceModel * vec4(aPos, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// set per draw on the individual path
+uniform mat4 model;
+uniform vec4 color;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main()
+{
+	TexCoord = aTexCoord;
+	Color = color;
+	gl_Position = model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,148 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_import.h"
+#include "../../../dependencies/include/learnopengl/mesh_cache.h"
+#include "../benchmark.h"
+
+const int ITERATIONS = 5;
+
+typedef VertexLayout<Position3f, TexCoord2f, Normal3f> ModelVertex;
+
+// grid sphere written the way exporters write OBJ, about 200 bytes per grid point
+void writeSphere(const std::string& path, int size) {
+	std::vector<unsigned int> indices;
+	std::vector<SpherePoint> points = makeSphere(size, 1.0f, 0.0f, &indices);
+	std::ofstream obj(path, std::ios::binary);
+	char line[160];
+	for (const SpherePoint& point : points) {
+		const float* n = point.normal;
+		int length = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+			point.position[0], point.position[1], point.position[2], point.u, point.v, n[0], n[1], n[2]);
+		obj.write(line, length);
+	}
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		unsigned int a = indices[i] + 1, b = indices[i + 1] + 1, c = indices[i + 2] + 1;
+		int length = std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+		obj.write(line, length);
+	}
+}
+
+// best of ITERATIONS, each ending with glFinish so the upload is included
+template <typename Load>
+double bestMs(Load&& load) {
+	double best = 1e30;
+	for (int i = 0; i < ITERATIONS; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		load();
+		glFinish();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+	return best;
+}
+
+// usage: mesh_cache [model file] or mesh_cache --generate [size in MB]
+// loads a model into a vertex and an index buffer the way a sample starts up,
+// once by importing the text (or glTF) file and once by mapping each of the
+// raw and encoded mesh caches converted from it. without a model a sphere OBJ
+// of about the given size (64 MB by default) is written to the temp directory
+int main(int argc, char* argv[]) {
+	std::string path;
+	double generateMB = 64.0;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+			generateMB = std::atof(argv[++i]);
+		}
+		else {
+			path = argv[i];
+		}
+	}
+
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("mesh_cache");
+	if (!window) {
+		return -1;
+	}
+
+	std::string directory = std::filesystem::temp_directory_path().string() + "/";
+	if (path.empty()) {
+		int size = std::max(8, (int)std::sqrt(generateMB * 1e6 / 200.0));
+		std::cout << "writing a " << size << " x " << size << " sphere to " << directory << std::endl;
+		path = directory + "mesh_cache.obj";
+		writeSphere(path, size);
+	}
+
+	ImportedMesh mesh;
+	if (!importMesh<ModelVertex>(path, mesh)) {
+		glfwTerminate();
+		return -1;
+	}
+	std::string cachePath = directory + "mesh_cache.mesh", encodedPath = directory + "mesh_cache_encoded.mesh";
+	if (!writeMeshCache<ModelVertex>(cachePath, mesh.vertices.data(), mesh.vertexCount, mesh.indices)
+		|| !writeMeshCache<ModelVertex>(encodedPath, mesh.vertices.data(), mesh.vertexCount, mesh.indices, {}, true)) {
+		glfwTerminate();
+		return -1;
+	}
+
+	unsigned int VAO, buffers[2];
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(2, buffers);
+	glBindVertexArray(VAO);
+
+	// import parses the file into heap vectors, which are then copied into the buffers
+	double importMs = bestMs([&]() {
+		ImportedMesh imported;
+		importMesh<ModelVertex>(path, imported);
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+		glBufferData(GL_ARRAY_BUFFER, imported.vertices.size(), imported.vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, imported.indices.size() * sizeof(unsigned int), imported.indices.data(), GL_STATIC_DRAW);
+	});
+	// the cache is mapped and GL reads the blobs straight from the mapping
+	size_t cacheBytes = 0;
+	double cacheMs = bestMs([&]() {
+		MeshCache cache(cachePath);
+		cache.upload(buffers[0], buffers[1]);
+		cacheBytes = (size_t)(cache.header().indexOffset + cache.header().indexBytes);
+	});
+	// encoded blobs are decoded into the mapped GL buffers
+	size_t encodedBytes = 0;
+	double encodedMs = bestMs([&]() {
+		MeshCache cache(encodedPath);
+		cache.upload(buffers[0], buffers[1]);
+		encodedBytes = (size_t)(cache.header().indexOffset + cache.header().indexBytes);
+	});
+	double openMs = bestMs([&]() {
+		MeshCache cache(cachePath);
+	});
+
+	std::cout << mesh.vertexCount << " vertices, " << mesh.indices.size() / 3 << " triangles" << std::endl;
+	std::cout << std::left << std::setw(24) << "load" << std::right << std::setw(10) << "MB"
+		<< std::setw(12) << "ms" << std::setw(12) << "speedup" << std::endl;
+	auto printRow = [&](const char* name, size_t bytes, double ms) {
+		std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << bytes / 1e6 << std::setw(12) << ms
+			<< std::setw(11) << importMs / ms << "x" << std::endl;
+	};
+	printRow("import + upload", mesh.sourceBytes, importMs);
+	printRow("mesh cache + upload", cacheBytes, cacheMs);
+	printRow("encoded cache + upload", encodedBytes, encodedMs);
+	printRow("mesh cache open", cacheBytes, openMs);
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(2, buffers);
+	glfwTerminate();
+	return 0;
+}
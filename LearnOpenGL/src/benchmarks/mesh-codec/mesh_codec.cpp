@@ -0,0 +1,204 @@
+// vertex and index buffer compression ratio and decode speed, no GL required
+//
+// usage: mesh_codec [model files...]
+// every model (OBJ, glTF or mesh cache) is optimized the way mesh_convert does
+// it and encoded with mesh_codec.h; without files a corpus of generated meshes
+// is used. ratios are against 32 byte vertices and 32 bit indices, decode
+// speed is in decoded bytes per second
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_import.h"
+#include "../../../dependencies/include/learnopengl/mesh_optimizer.h"
+#include "../../../dependencies/include/learnopengl/mesh_cache.h"
+#include "../../../dependencies/include/learnopengl/mesh_codec.h"
+
+const int ITERATIONS = 10;
+
+struct ModelVertex {
+	float position[3];
+	float texCoord[2];
+	float normal[3];
+};
+
+typedef VertexLayout<Position3f, TexCoord2f, Normal3f> ModelLayout;
+static_assert(ModelLayout::stride == sizeof(ModelVertex), "ModelLayout must match ModelVertex");
+
+struct CorpusMesh {
+	std::string name;
+	std::vector<ModelVertex> vertices;
+	std::vector<unsigned int> indices;
+};
+
+// size x size grid wrapped by surface(u, v, position, normal)
+template <typename Surface>
+CorpusMesh makeGrid(const std::string& name, int size, Surface&& surface) {
+	CorpusMesh mesh;
+	mesh.name = name;
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			ModelVertex vertex;
+			vertex.texCoord[0] = (float)x / (size - 1);
+			vertex.texCoord[1] = (float)y / (size - 1);
+			surface(vertex.texCoord[0], vertex.texCoord[1], vertex.position, vertex.normal);
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	for (int y = 0; y < size - 1; y++) {
+		for (int x = 0; x < size - 1; x++) {
+			unsigned int a = y * size + x, b = a + 1, c = a + size, d = c + 1;
+			unsigned int triangles[] = { a, c, b, b, c, d };
+			mesh.indices.insert(mesh.indices.end(), triangles, triangles + 6);
+		}
+	}
+	return mesh;
+}
+
+std::vector<CorpusMesh> makeCorpus() {
+	const float pi = 3.14159265f;
+	std::vector<CorpusMesh> corpus;
+	corpus.push_back(makeGrid("sphere", 512, [&](float u, float v, float* p, float* n) {
+		float theta = u * 2.0f * pi, phi = v * pi;
+		n[0] = std::sin(phi) * std::cos(theta);
+		n[1] = std::cos(phi);
+		n[2] = std::sin(phi) * std::sin(theta);
+		std::copy(n, n + 3, p);
+	}));
+	corpus.push_back(makeGrid("torus", 512, [&](float u, float v, float* p, float* n) {
+		float theta = u * 2.0f * pi, phi = v * 2.0f * pi;
+		n[0] = std::cos(phi) * std::cos(theta);
+		n[1] = std::sin(phi);
+		n[2] = std::cos(phi) * std::sin(theta);
+		p[0] = (2.0f + std::cos(phi)) * std::cos(theta);
+		p[1] = std::sin(phi);
+		p[2] = (2.0f + std::cos(phi)) * std::sin(theta);
+	}));
+	corpus.push_back(makeGrid("terrain", 512, [&](float u, float v, float* p, float* n) {
+		float height = 0.1f * std::sin(u * 31.0f) * std::cos(v * 17.0f) + 0.03f * std::sin(u * 97.0f + v * 89.0f);
+		float dx = 0.1f * 31.0f * std::cos(u * 31.0f) * std::cos(v * 17.0f) + 0.03f * 97.0f * std::cos(u * 97.0f + v * 89.0f);
+		float dz = -0.1f * 17.0f * std::sin(u * 31.0f) * std::sin(v * 17.0f) + 0.03f * 89.0f * std::cos(u * 97.0f + v * 89.0f);
+		float length = std::sqrt(dx * dx + 1.0f + dz * dz);
+		p[0] = u * 10.0f;
+		p[1] = height;
+		p[2] = v * 10.0f;
+		n[0] = -dx / length;
+		n[1] = 1.0f / length;
+		n[2] = -dz / length;
+	}));
+	return corpus;
+}
+
+bool loadModel(const std::string& path, CorpusMesh& mesh) {
+	mesh.name = std::filesystem::path(path).filename().string();
+	std::string extension = std::filesystem::path(path).extension().string();
+	if (extension == ".mesh") {
+		MeshCache cache(path);
+		if (!cache.matches<ModelLayout>()) {
+			return false;
+		}
+		std::vector<unsigned char> indices(cache.decodedIndexBytes());
+		mesh.vertices.resize((size_t)cache.header().vertexCount);
+		cache.decodeVertices(mesh.vertices.data());
+		cache.decodeIndices(indices.data());
+		for (size_t i = 0; i < (size_t)cache.header().indexCount; i++) {
+			mesh.indices.push_back(cache.indexType() == GL_UNSIGNED_SHORT ? ((const uint16_t*)indices.data())[i]
+				: ((const uint32_t*)indices.data())[i]);
+		}
+		return true;
+	}
+	ImportedMesh imported;
+	if (!importMesh<ModelLayout>(path, imported)) {
+		return false;
+	}
+	mesh.vertices.resize(imported.vertexCount);
+	std::memcpy(mesh.vertices.data(), imported.vertices.data(), imported.vertexCount * sizeof(ModelVertex));
+	mesh.indices = imported.indices;
+	return true;
+}
+
+template <typename Decode>
+double bestSeconds(Decode&& decode) {
+	double best = 1e30;
+	for (int i = 0; i < ITERATIONS; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		decode();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<CorpusMesh> corpus;
+	for (int i = 1; i < argc; i++) {
+		CorpusMesh mesh;
+		if (loadModel(argv[i], mesh)) {
+			corpus.push_back(std::move(mesh));
+		}
+		else {
+			std::cout << std::left << std::setw(20) << argv[i] << "load failed" << std::endl;
+		}
+	}
+	if (argc < 2) {
+		corpus = makeCorpus();
+	}
+
+	std::cout << std::left << std::setw(20) << "mesh" << std::setw(10) << "stream"
+		<< std::right << std::setw(10) << "MB" << std::setw(12) << "encoded MB"
+		<< std::setw(8) << "ratio" << std::setw(12) << "encode ms" << std::setw(12) << "decode GB/s" << std::endl;
+	auto printRow = [](const std::string& name, const char* stream, size_t raw, size_t encoded, double encodeSeconds,
+		double decodeSeconds) {
+		std::cout << std::left << std::setw(20) << name.substr(0, 19) << std::setw(10) << stream
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << raw / 1e6 << std::setw(12) << encoded / 1e6
+			<< std::setw(8) << (double)raw / encoded << std::setw(12) << encodeSeconds * 1000.0
+			<< std::setw(12) << raw / decodeSeconds / 1e9 << std::endl;
+	};
+
+	size_t totalRaw = 0, totalEncoded = 0;
+	for (CorpusMesh& mesh : corpus) {
+		optimizeMesh(mesh.vertices, mesh.indices);
+		size_t vertexBytes = mesh.vertices.size() * sizeof(ModelVertex), indexBytes = mesh.indices.size() * sizeof(unsigned int);
+
+		std::vector<unsigned char> vertices, indices;
+		double vertexEncode = bestSeconds([&]() {
+			vertices = encodeVertexBuffer(mesh.vertices.data(), mesh.vertices.size(), sizeof(ModelVertex));
+		});
+		double indexEncode = bestSeconds([&]() {
+			indices = encodeIndexBuffer(mesh.indices.data(), mesh.indices.size());
+		});
+
+		std::vector<ModelVertex> decodedVertices(mesh.vertices.size());
+		std::vector<unsigned int> decodedIndices(mesh.indices.size());
+		bool valid = true;
+		double vertexDecode = bestSeconds([&]() {
+			valid = decodeVertexBuffer(decodedVertices.data(), mesh.vertices.size(), sizeof(ModelVertex),
+				vertices.data(), vertices.size()) && valid;
+		});
+		double indexDecode = bestSeconds([&]() {
+			valid = decodeIndexBuffer(decodedIndices.data(), mesh.indices.size(), indices.data(), indices.size()) && valid;
+		});
+		valid = valid && std::memcmp(decodedVertices.data(), mesh.vertices.data(), vertexBytes) == 0;
+		if (!valid) {
+			std::cout << std::left << std::setw(20) << mesh.name << "round trip failed" << std::endl;
+			continue;
+		}
+
+		printRow(mesh.name, "vertices", vertexBytes, vertices.size(), vertexEncode, vertexDecode);
+		printRow(mesh.name, "indices", indexBytes, indices.size(), indexEncode, indexDecode);
+		totalRaw += vertexBytes + indexBytes;
+		totalEncoded += vertices.size() + indices.size();
+	}
+	if (totalEncoded > 0) {
+		std::cout << "corpus " << std::fixed << std::setprecision(2) << totalRaw / 1e6 << " MB -> "
+			<< totalEncoded / 1e6 << " MB, ratio " << (double)totalRaw / totalEncoded << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+// OBJ and glTF import throughput, no GL required
+//
+// usage: mesh_import [model files...] or mesh_import --generate [size in MB]
+// every file is imported with the mapped SIMD assisted importer and OBJ files
+// also with a getline / istringstream reader for comparison. without files a
+// textured sphere of about the given size (256 MB by default) is written as
+// OBJ and as GLB to the temp directory and imported instead
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_import.h"
+#include "../benchmark.h"
+
+typedef VertexLayout<Position3f, TexCoord2f, Normal3f> ModelVertex;
+
+// grid sphere with positions, texture coords and normals listed separately, the
+// way exporters write OBJ; about 200 bytes of text per grid point
+void writeSphere(const std::string& objPath, const std::string& glbPath, int size) {
+	std::vector<uint32_t> indices;
+	std::vector<SpherePoint> points = makeSphere(size, 1.0f, 0.05f, &indices);
+	std::vector<float> vertices;
+	std::ofstream obj(objPath, std::ios::binary);
+	char line[160];
+	for (const SpherePoint& point : points) {
+		const float* p = point.position;
+		const float* n = point.normal;
+		float vertex[8] = { p[0], p[1], p[2], point.u, point.v, n[0], n[1], n[2] };
+		vertices.insert(vertices.end(), vertex, vertex + 8);
+		int length = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+			vertex[0], vertex[1], vertex[2], vertex[3], vertex[4], vertex[5], vertex[6], vertex[7]);
+		obj.write(line, length);
+	}
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		uint32_t a = indices[i] + 1, b = indices[i + 1] + 1, c = indices[i + 2] + 1;
+		int length = std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+		obj.write(line, length);
+	}
+
+	// the same mesh as one interleaved buffer view in a GLB
+	size_t vertexBytes = vertices.size() * sizeof(float), indexBytes = indices.size() * sizeof(uint32_t);
+	size_t count = vertices.size() / 8;
+	std::ostringstream json;
+	json << "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":" << vertexBytes + indexBytes << "}],"
+		<< "\"bufferViews\":[{\"buffer\":0,\"byteLength\":" << vertexBytes << ",\"byteStride\":32},"
+		<< "{\"buffer\":0,\"byteOffset\":" << vertexBytes << ",\"byteLength\":" << indexBytes << "}],"
+		<< "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+		<< "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC2\"},"
+		<< "{\"bufferView\":0,\"byteOffset\":20,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+		<< "{\"bufferView\":1,\"componentType\":5125,\"count\":" << indices.size() << ",\"type\":\"SCALAR\"}],"
+		<< "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1,\"NORMAL\":2},\"indices\":3}]}]}";
+	std::string text = json.str();
+	while (text.size() % 4 != 0) {
+		text += ' ';
+	}
+	uint32_t header[] = { 0x46546C67, 2, (uint32_t)(12 + 8 + text.size() + 8 + vertexBytes + indexBytes) };
+	uint32_t jsonChunk[] = { (uint32_t)text.size(), 0x4E4F534A };
+	uint32_t binChunk[] = { (uint32_t)(vertexBytes + indexBytes), 0x004E4942 };
+	std::ofstream glb(glbPath, std::ios::binary);
+	glb.write((const char*)header, sizeof(header));
+	glb.write((const char*)jsonChunk, sizeof(jsonChunk));
+	glb.write(text.data(), text.size());
+	glb.write((const char*)binChunk, sizeof(binChunk));
+	glb.write((const char*)vertices.data(), vertexBytes);
+	glb.write((const char*)indices.data(), indexBytes);
+}
+
+// the usual tutorial reader: getline, istringstream and a map keyed by corner text
+bool importObjStream(const std::string& path, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	std::vector<float> positions, texCoords, normals;
+	std::unordered_map<std::string, unsigned int> corners;
+	std::string line, type, corner;
+	while (std::getline(file, line)) {
+		std::istringstream stream(line);
+		stream >> type;
+		if (type == "v" || type == "vn") {
+			float x, y, z;
+			stream >> x >> y >> z;
+			std::vector<float>& target = type == "v" ? positions : normals;
+			target.insert(target.end(), { x, y, z });
+		}
+		else if (type == "vt") {
+			float u, v;
+			stream >> u >> v;
+			texCoords.insert(texCoords.end(), { u, v });
+		}
+		else if (type == "f") {
+			std::vector<unsigned int> polygon;
+			while (stream >> corner) {
+				auto found = corners.find(corner);
+				if (found == corners.end()) {
+					int p = 0, t = 0, n = 0;
+					std::sscanf(corner.c_str(), "%d/%d/%d", &p, &t, &n);
+					float vertex[8] = {};
+					std::copy(&positions[(p - 1) * 3], &positions[(p - 1) * 3] + 3, vertex);
+					if (t > 0) {
+						std::copy(&texCoords[(t - 1) * 2], &texCoords[(t - 1) * 2] + 2, vertex + 3);
+					}
+					if (n > 0) {
+						std::copy(&normals[(n - 1) * 3], &normals[(n - 1) * 3] + 3, vertex + 5);
+					}
+					found = corners.emplace(corner, (unsigned int)(vertices.size() / 8)).first;
+					vertices.insert(vertices.end(), vertex, vertex + 8);
+				}
+				polygon.push_back(found->second);
+			}
+			for (size_t k = 2; k < polygon.size(); k++) {
+				indices.insert(indices.end(), { polygon[0], polygon[k - 1], polygon[k] });
+			}
+		}
+	}
+	return true;
+}
+
+template <typename Import>
+double timeSeconds(Import&& import) {
+	auto start = std::chrono::high_resolution_clock::now();
+	import();
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void printRow(const std::string& file, const char* reader, size_t bytes, size_t vertices, size_t triangles, double seconds) {
+	std::cout << std::left << std::setw(28) << file.substr(0, 27) << std::setw(10) << reader
+		<< std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << bytes / 1e6
+		<< std::setw(12) << vertices
+		<< std::setw(12) << triangles
+		<< std::setw(10) << seconds * 1000.0
+		<< std::setw(10) << bytes / 1e6 / seconds << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<std::string> files;
+	double generateMB = 256.0;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+			generateMB = std::atof(argv[++i]);
+		}
+		else {
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (files.empty()) {
+		std::string directory = std::filesystem::temp_directory_path().string() + "/";
+		int size = std::max(8, (int)std::sqrt(generateMB * 1e6 / 200.0));
+		std::cout << "writing a " << size << " x " << size << " sphere to " << directory << std::endl;
+		writeSphere(directory + "mesh_import.obj", directory + "mesh_import.glb", size);
+		files.push_back(directory + "mesh_import.obj");
+		files.push_back(directory + "mesh_import.glb");
+	}
+
+	std::cout << std::left << std::setw(28) << "file" << std::setw(10) << "reader"
+		<< std::right << std::setw(10) << "MB"
+		<< std::setw(12) << "vertices"
+		<< std::setw(12) << "triangles"
+		<< std::setw(10) << "ms"
+		<< std::setw(10) << "MB/s" << std::endl;
+	for (const std::string& path : files) {
+		std::string name = std::filesystem::path(path).filename().string();
+		ImportedMesh mesh;
+		bool imported = false;
+		double seconds = timeSeconds([&]() {
+			imported = importMesh<ModelVertex>(path, mesh);
+		});
+		if (!imported) {
+			std::cout << std::left << std::setw(28) << name << "import failed" << std::endl;
+			continue;
+		}
+		printRow(name, "mapped", mesh.sourceBytes, mesh.vertexCount, mesh.indices.size() / 3, seconds);
+
+		std::string extension = std::filesystem::path(path).extension().string();
+		if (extension == ".obj" || extension == ".OBJ") {
+			std::vector<float> vertices;
+			std::vector<unsigned int> indices;
+			seconds = timeSeconds([&]() {
+				importObjStream(path, vertices, indices);
+			});
+			printRow(name, "stream", mesh.sourceBytes, vertices.size() / 8, indices.size() / 3, seconds);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,193 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_optimizer.h"
+#include "../../../dependencies/include/learnopengl/mesh_simplify.h"
+#include "../benchmark.h"
+
+const int ITERATIONS = 10;
+const int COPIES = 64;			// draws per measurement, side by side
+const int SCR_WIDTH = 1920;
+const int SCR_HEIGHT = 1080;
+const float FOV_Y = 0.785398f;	// 45 degrees
+const float MAX_PIXEL_ERROR = 1.0f;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/mesh-lod/shaders/";
+
+struct LodVertex {
+	float position[3];
+	float normal[3];
+};
+
+typedef VertexLayout<Position3f, Normal3f> LodLayout;
+static_assert(LodLayout::stride == sizeof(LodVertex), "LodLayout must match LodVertex");
+
+// column major perspective matrix, as glUniformMatrix4fv expects
+void perspective(float fovY, float aspect, float nearPlane, float farPlane, float* m) {
+	float f = 1.0f / std::tan(fovY * 0.5f);
+	for (int i = 0; i < 16; i++) {
+		m[i] = 0.0f;
+	}
+	m[0] = f / aspect;
+	m[5] = f;
+	m[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+	m[11] = -1.0f;
+	m[14] = 2.0f * farPlane * nearPlane / (nearPlane - farPlane);
+}
+
+// average GPU time of drawing COPIES meshes at distance with one LOD
+double timeDraws(const Shader& shader, const MeshLod& lod, GLenum indexType, float distance, float spacing) {
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	double totalMs = 0.0;
+	for (int i = 0; i <= ITERATIONS; i++) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (int copy = 0; copy < COPIES; copy++) {
+			float x = ((copy % 8) - 3.5f) * spacing, y = ((copy / 8) - 3.5f) * spacing;
+			glUniform3f(glGetUniformLocation(shader.ID, "offset"), x, y, -distance);
+			glDrawElements(GL_TRIANGLES, lod.indexCount, indexType, lod.offset(indexType));
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		// the first round warms up
+		totalMs += i > 0 ? elapsed / 1e6 : 0.0;
+	}
+
+	glDeleteQueries(1, &query);
+	return totalMs / ITERATIONS;
+}
+
+// usage: mesh_lod [grid size]
+// draws a grid of meshes at increasing distances at full resolution and with
+// the LOD picked for a 1080p screen, comparing triangle counts and GPU time
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("mesh_lod");
+	if (!window) {
+		return -1;
+	}
+
+	int gridSize = argc > 1 ? std::max(8, std::atoi(argv[1])) : 512;
+	// bumpy sphere so the simplifier has curvature to preserve
+	std::vector<unsigned int> indices;
+	std::vector<LodVertex> vertices;
+	for (const SpherePoint& point : makeSphere(gridSize, 1.0f, 0.05f, &indices)) {
+		LodVertex vertex;
+		std::copy(point.position, point.position + 3, vertex.position);
+		std::copy(point.normal, point.normal + 3, vertex.normal);
+		vertices.push_back(vertex);
+	}
+
+	// normals keep collapses from flattening creases
+	SimplifyOptions options;
+	options.attributes = vertices[0].normal;
+	options.attributeCount = 3;
+	options.attributeStride = sizeof(LodVertex);
+	options.attributeWeight = 0.01f;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	LodChain chain = buildLodChain(indices, vertices[0].position, sizeof(LodVertex), vertices.size(), options, 8);
+	double buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "LOD chain built in " << std::fixed << std::setprecision(1) << buildMs << " ms" << std::endl;
+	std::cout << std::left << std::setw(6) << "lod" << std::right << std::setw(12) << "triangles" << std::setw(14) << "error" << std::endl;
+	for (size_t l = 0; l < chain.lods.size(); l++) {
+		std::cout << std::left << std::setw(6) << l << std::right << std::setw(12) << chain.lods[l].indexCount / 3
+			<< std::setw(14) << std::setprecision(5) << chain.lods[l].error << std::endl;
+	}
+
+	// offscreen 1080p target so pixel error and fill match a real screen
+	unsigned int FBO, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	// every LOD lives in one index buffer next to the others
+	PackedIndices packed = packIndices(chain.indices.data(), chain.indices.size(), vertices.size());
+	unsigned int VBO, EBO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(LodVertex), vertices.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &EBO);
+
+	std::string vertPath = shaderPath + "lod.vs";
+	std::string fragPath = shaderPath + "lod.fs";
+	Shader shader(vertPath.c_str(), fragPath.c_str());
+
+	VertexArrayCache vertexArrays;
+	vertexArrays.bind<LodLayout>(VBO, EBO, shader.ID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.data.size(), packed.data.data(), GL_STATIC_DRAW);
+
+	float projection[16];
+	perspective(FOV_Y, (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, 1000.0f, projection);
+	shader.use();
+	glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, projection);
+
+	std::cout << std::endl << COPIES << " meshes per frame, " << ITERATIONS << " iterations" << std::endl;
+	std::cout << std::right << std::setw(9) << "distance"
+		<< std::setw(6) << "lod"
+		<< std::setw(12) << "triangles"
+		<< std::setw(10) << "px error"
+		<< std::setw(11) << "full ms"
+		<< std::setw(10) << "lod ms"
+		<< std::setw(13) << "full Mtri/s"
+		<< std::setw(12) << "lod Mtri/s" << std::endl;
+	const float distances[] = { 4.0f, 8.0f, 16.0f, 32.0f, 64.0f, 128.0f, 256.0f };
+	for (float distance : distances) {
+		int lod = selectLod(chain, distance, FOV_Y, SCR_HEIGHT, MAX_PIXEL_ERROR);
+		float spacing = chain.radius * 2.5f;
+		double fullMs = timeDraws(shader, chain.lods[0], packed.type, distance, spacing);
+		double lodMs = timeDraws(shader, chain.lods[lod], packed.type, distance, spacing);
+		double fullTriangles = (double)chain.lods[0].indexCount / 3 * COPIES;
+		double lodTriangles = (double)chain.lods[lod].indexCount / 3 * COPIES;
+
+		std::cout << std::right << std::fixed << std::setprecision(0) << std::setw(9) << distance
+			<< std::setw(6) << lod
+			<< std::setw(12) << chain.lods[lod].indexCount / 3
+			<< std::setprecision(2)
+			<< std::setw(10) << projectedError(chain.lods[lod].error, distance - chain.radius, FOV_Y, SCR_HEIGHT)
+			<< std::setw(11) << fullMs
+			<< std::setw(10) << lodMs
+			<< std::setprecision(1)
+			<< std::setw(13) << fullTriangles / (fullMs * 1000.0)
+			<< std::setw(12) << lodTriangles / (lodMs * 1000.0) << std::endl;
+	}
+
+	vertexArrays.clear();
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteProgram(shader.ID);
+	glfwTerminate();
+	return 0;
+}
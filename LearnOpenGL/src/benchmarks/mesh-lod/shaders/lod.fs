@@ -0,0 +1,8 @@
+#version 330 core
+in vec3 Normal;
+out vec4 FragColor;
+
+void main()
+{
+	FragColor = vec4(normalize(Normal) * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+uniform mat4 projection;
+uniform vec3 offset;
+
+out vec3 Normal;
+
+void main()
+{
+	Normal = aNormal;
+	gl_Position = projection * vec4(aPos + offset, 1.0);
+}
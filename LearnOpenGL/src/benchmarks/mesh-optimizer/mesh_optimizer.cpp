@@ -0,0 +1,107 @@
+// vertex cache, overdraw and vertex fetch optimization of a generated mesh, no GL required
+//
+// usage: mesh_optimizer [grid size]
+// a sphere is tessellated into a grid, every vertex is duplicated per triangle
+// and the triangles are shuffled, then each optimization stage is timed
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/mesh_optimizer.h"
+#include "../benchmark.h"
+
+struct MeshVertex {
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+// unindexed sphere: three fresh vertices per triangle, triangles in random order
+void makeShuffledSphere(int size, std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices) {
+	std::vector<unsigned int> quads;
+	std::vector<MeshVertex> grid;
+	for (const SpherePoint& point : makeSphere(size, 1.0f, 0.0f, &quads)) {
+		MeshVertex vertex;
+		std::copy(point.position, point.position + 3, vertex.position);
+		std::copy(point.normal, point.normal + 3, vertex.normal);
+		vertex.texCoord[0] = point.u;
+		vertex.texCoord[1] = point.v;
+		grid.push_back(vertex);
+	}
+
+	std::mt19937 rng(42);
+	std::vector<size_t> order(quads.size() / 3);
+	for (size_t t = 0; t < order.size(); t++) {
+		order[t] = t;
+	}
+	std::shuffle(order.begin(), order.end(), rng);
+
+	vertices.clear();
+	indices.clear();
+	for (size_t t : order) {
+		for (int k = 0; k < 3; k++) {
+			indices.push_back((unsigned int)vertices.size());
+			vertices.push_back(grid[quads[t * 3 + k]]);
+		}
+	}
+}
+
+template <typename F>
+double timeMs(F&& f) {
+	auto start = std::chrono::high_resolution_clock::now();
+	f();
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void printRow(const char* stage, double ms, size_t vertexCount, const std::vector<unsigned int>& indices) {
+	VertexCacheStats fifo16 = analyzeVertexCache(indices, vertexCount, 16);
+	VertexCacheStats fifo32 = analyzeVertexCache(indices, vertexCount, 32);
+	std::cout << std::left << std::setw(16) << stage
+		<< std::right << std::fixed << std::setprecision(2)
+		<< std::setw(10) << ms
+		<< std::setw(10) << vertexCount
+		<< std::setprecision(3)
+		<< std::setw(10) << fifo16.acmr
+		<< std::setw(10) << fifo16.atvr
+		<< std::setw(10) << fifo32.acmr
+		<< std::setw(10) << fifo32.atvr << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	int gridSize = argc > 1 ? std::max(2, std::atoi(argv[1])) : 256;
+	std::vector<MeshVertex> vertices;
+	std::vector<unsigned int> indices;
+	makeShuffledSphere(gridSize, vertices, indices);
+
+	std::cout << indices.size() / 3 << " triangles" << std::endl;
+	std::cout << std::left << std::setw(16) << "stage"
+		<< std::right << std::setw(10) << "ms"
+		<< std::setw(10) << "vertices"
+		<< std::setw(10) << "ACMR16"
+		<< std::setw(10) << "ATVR16"
+		<< std::setw(10) << "ACMR32"
+		<< std::setw(10) << "ATVR32" << std::endl;
+	printRow("input", 0.0, vertices.size(), indices);
+
+	double ms = timeMs([&]() { weldVertices(vertices, indices); });
+	printRow("weld", ms, vertices.size(), indices);
+
+	ms = timeMs([&]() { indices = optimizeVertexCache(indices, vertices.size()); });
+	printRow("vertex cache", ms, vertices.size(), indices);
+
+	ms = timeMs([&]() { indices = optimizeOverdraw(indices, vertices[0].position, sizeof(MeshVertex), vertices.size()); });
+	printRow("overdraw", ms, vertices.size(), indices);
+
+	ms = timeMs([&]() { optimizeVertexFetch(vertices, indices); });
+	printRow("vertex fetch", ms, vertices.size(), indices);
+
+	PackedIndices packed = packIndices(indices.data(), indices.size(), vertices.size());
+	std::cout << "index buffer: " << (packed.type == GL_UNSIGNED_SHORT ? "GL_UNSIGNED_SHORT" : "GL_UNSIGNED_INT")
+		<< ", " << packed.data.size() / 1024 << " KiB" << std::endl;
+	return 0;
+}
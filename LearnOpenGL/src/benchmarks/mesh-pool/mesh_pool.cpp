@@ -0,0 +1,156 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_pool.h"
+#include "../benchmark.h"
+
+const int FRAMES = 100;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/mesh-pool/shaders/";
+
+typedef VertexLayout<Position3f> PoolVertex;
+
+struct SmallMesh {
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+};
+
+// small grid of random size placed at a random spot on screen
+SmallMesh makeMesh(std::mt19937& rng) {
+	std::uniform_int_distribution<int> cells(1, 8);
+	std::uniform_real_distribution<float> position(-0.95f, 0.95f);
+	int width = cells(rng), height = cells(rng);
+	float x0 = position(rng), y0 = position(rng);
+
+	SmallMesh mesh;
+	for (int y = 0; y <= height; y++) {
+		for (int x = 0; x <= width; x++) {
+			mesh.vertices.insert(mesh.vertices.end(), { x0 + x * 0.005f, y0 + y * 0.005f, 0.0f });
+		}
+	}
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			unsigned int a = y * (width + 1) + x, b = a + 1, c = a + width + 1, d = c + 1;
+			mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+		}
+	}
+	return mesh;
+}
+
+template <typename F>
+double timeFramesMs(F&& drawFrame) {
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawFrame();
+	}
+	glFinish();
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+}
+
+// usage: mesh_pool [mesh count]
+// draws the same small meshes with a VAO, VBO and EBO each and packed into a
+// MeshPool, then churns the pool's allocator with random adds and removes
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("mesh_pool", 256, 256);
+	if (!window) {
+		return -1;
+	}
+
+	int meshCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+	std::mt19937 rng(7);
+	std::vector<SmallMesh> meshes;
+	for (int i = 0; i < meshCount; i++) {
+		meshes.push_back(makeMesh(rng));
+	}
+
+	std::string vertPath = shaderPath + "pool.vs";
+	std::string fragPath = shaderPath + "pool.fs";
+	Shader shader(vertPath.c_str(), fragPath.c_str());
+	shader.use();
+
+	// one VAO, VBO and EBO per mesh
+	std::vector<unsigned int> VAOs(meshCount), VBOs(meshCount), EBOs(meshCount);
+	glGenVertexArrays(meshCount, VAOs.data());
+	glGenBuffers(meshCount, VBOs.data());
+	glGenBuffers(meshCount, EBOs.data());
+	for (int i = 0; i < meshCount; i++) {
+		glBindVertexArray(VAOs[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, VBOs[i]);
+		glBufferData(GL_ARRAY_BUFFER, meshes[i].vertices.size() * sizeof(float), meshes[i].vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOs[i]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshes[i].indices.size() * sizeof(unsigned int), meshes[i].indices.data(), GL_STATIC_DRAW);
+		PoolVertex::setup(VBOs[i], shader.ID);
+	}
+
+	// everything in one pool
+	MeshPool<PoolVertex> pool(1 << 20, 3 << 20, shader.ID);
+	std::vector<MeshAllocation> allocations;
+	for (const SmallMesh& mesh : meshes) {
+		allocations.push_back(pool.add(mesh.vertices.data(), (uint32_t)mesh.vertices.size() / 3,
+			mesh.indices.data(), (uint32_t)mesh.indices.size()));
+	}
+
+	double separateMs = timeFramesMs([&]() {
+		for (int i = 0; i < meshCount; i++) {
+			glBindVertexArray(VAOs[i]);
+			glDrawElements(GL_TRIANGLES, (GLsizei)meshes[i].indices.size(), GL_UNSIGNED_INT, 0);
+		}
+	});
+	double pooledMs = timeFramesMs([&]() {
+		pool.beginFrame();
+		for (const MeshAllocation& allocation : allocations) {
+			pool.draw(allocation);
+		}
+	});
+	MeshPoolStats stats = pool.getStats();
+
+	std::cout << meshCount << " meshes, " << FRAMES << " frames" << std::endl;
+	std::cout << std::left << std::setw(12) << "buffers"
+		<< std::right << std::setw(10) << "ms/frame"
+		<< std::setw(12) << "VAO binds"
+		<< std::setw(10) << "draws"
+		<< std::setw(10) << "buffers" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< std::left << std::setw(12) << "per mesh" << std::right << std::setw(10) << separateMs
+		<< std::setw(12) << meshCount << std::setw(10) << meshCount << std::setw(10) << meshCount * 2 << std::endl;
+	std::cout << std::left << std::setw(12) << "mesh pool" << std::right << std::setw(10) << pooledMs
+		<< std::setw(12) << stats.bindsThisFrame << std::setw(10) << stats.drawsThisFrame << std::setw(10) << stats.pages * 2 << std::endl;
+	std::cout << "pool uses " << (stats.vertexBytesUsed + stats.indexBytesUsed) / 1024 << " KiB of "
+		<< stats.bytesReserved / 1024 << " KiB reserved" << std::endl;
+
+	// allocator churn: replace random meshes, as streaming levels would
+	std::uniform_int_distribution<int> pick(0, meshCount - 1);
+	const int churn = 100000;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < churn; i++) {
+		int slot = pick(rng);
+		pool.remove(allocations[slot]);
+		const SmallMesh& mesh = meshes[pick(rng)];
+		allocations[slot] = pool.add(mesh.vertices.data(), (uint32_t)mesh.vertices.size() / 3,
+			mesh.indices.data(), (uint32_t)mesh.indices.size());
+	}
+	glFinish();
+	double churnMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << churn << " remove + add pairs in " << std::setprecision(1) << churnMs << " ms, "
+		<< pool.pageCount() << " page(s) afterwards" << std::endl;
+
+	pool.clear();
+	glDeleteVertexArrays(meshCount, VAOs.data());
+	glDeleteBuffers(meshCount, VBOs.data());
+	glDeleteBuffers(meshCount, EBOs.data());
+	glDeleteProgram(shader.ID);
+	glfwTerminate();
+	return 0;
+}
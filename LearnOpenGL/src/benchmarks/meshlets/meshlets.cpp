@@ -0,0 +1,206 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_optimizer.h"
+#include "../../../dependencies/include/learnopengl/stream_buffer.h"
+#include "../../../dependencies/include/learnopengl/frustum.h"
+#include "../../../dependencies/include/learnopengl/meshlet.h"
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+#include "../benchmark.h"
+
+const int ITERATIONS = 20;
+const int SCR_WIDTH = 1920;
+const int SCR_HEIGHT = 1080;
+const float FOV_Y = 0.785398f;	// 45 degrees
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/meshlets/shaders/";
+
+struct MeshVertex {
+	float position[3];
+	float normal[3];
+};
+
+typedef VertexLayout<Position3f, Normal3f> MeshLayout;
+static_assert(MeshLayout::stride == sizeof(MeshVertex), "MeshLayout must match MeshVertex");
+
+// average GPU time of a draw call
+template <typename Draw>
+double timeDraw(Draw&& draw) {
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	double totalMs = 0.0;
+	for (int i = 0; i <= ITERATIONS; i++) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		draw();
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		// the first round warms up
+		totalMs += i > 0 ? elapsed / 1e6 : 0.0;
+	}
+
+	glDeleteQueries(1, &query);
+	return totalMs / ITERATIONS;
+}
+
+// usage: meshlets [grid size]
+// splits a dense mesh into meshlets, then draws it from several cameras whole
+// and with the clusters outside the view or facing away culled on the CPU
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("meshlets");
+	if (!window) {
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	int gridSize = argc > 1 ? std::max(8, std::atoi(argv[1])) : 512;
+	// bumpy sphere, dense enough that whole clusters fall outside the view or face away
+	std::vector<unsigned int> indices;
+	std::vector<MeshVertex> vertices;
+	for (const SpherePoint& point : makeSphere(gridSize, 1.0f, 0.05f, &indices)) {
+		MeshVertex vertex;
+		std::copy(point.position, point.position + 3, vertex.position);
+		std::copy(point.normal, point.normal + 3, vertex.normal);
+		vertices.push_back(vertex);
+	}
+	indices = optimizeVertexCache(indices, vertices.size());
+
+	auto start = std::chrono::high_resolution_clock::now();
+	MeshletMesh meshlets = buildMeshlets(indices, vertices[0].position, sizeof(MeshVertex), vertices.size());
+	double buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	unsigned int withCone = 0;
+	for (const Meshlet& meshlet : meshlets.meshlets) {
+		withCone += meshlet.coneCutoff < 1.0f;
+	}
+	std::cout << indices.size() / 3 << " triangles in " << meshlets.meshlets.size() << " meshlets ("
+		<< std::fixed << std::setprecision(1) << (double)meshlets.vertices.size() / meshlets.meshlets.size() << " vertices, "
+		<< (double)meshlets.triangles.size() / 3 / meshlets.meshlets.size() << " triangles on average, "
+		<< withCone << " with a usable cone), built in " << buildMs << " ms" << std::endl;
+
+	// offscreen 1080p target
+	unsigned int FBO, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	unsigned int VBO, EBO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &EBO);
+
+	Shader shader((shaderPath + "meshlet.vs").c_str(), (shaderPath + "meshlet.fs").c_str());
+
+	// the whole mesh reads a static element buffer, the culled one the index
+	// stream, which is mapped through GL_COPY_WRITE_BUFFER to leave VAO state alone
+	VertexArrayCache vertexArrays;
+	unsigned int fullVAO = vertexArrays.bind<MeshLayout>(VBO, EBO, shader.ID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	StreamBuffer indexStream(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int));
+	unsigned int culledVAO = vertexArrays.get<MeshLayout>(VBO, indexStream.buffer(), shader.ID);
+
+	shader.use();
+	int viewProjectionLocation = glGetUniformLocation(shader.ID, "viewProjection");
+
+	std::cout << std::endl << "1080p, " << ITERATIONS << " iterations" << std::endl;
+	std::cout << std::left << std::setw(10) << "camera"
+		<< std::right << std::setw(12) << "triangles"
+		<< std::setw(10) << "frustum"
+		<< std::setw(10) << "facing"
+		<< std::setw(10) << "cull ms"
+		<< std::setw(11) << "full ms"
+		<< std::setw(12) << "culled ms" << std::endl;
+
+	// far sees all of the front, near only part of it, grazing looks along the surface
+	struct Camera {
+		const char* name;
+		float eye[3];
+	};
+	const Camera cameras[] = {
+		{ "far", { 0.0f, 0.0f, 4.0f } },
+		{ "near", { 0.3f, 0.2f, 1.6f } },
+		{ "grazing", { 1.15f, 0.1f, 0.3f } }
+	};
+	std::vector<unsigned int> visible;
+	for (const Camera& camera : cameras) {
+		Mat4 viewProjection = Mat4::perspective(FOV_Y, (float)SCR_WIDTH / SCR_HEIGHT, 0.01f, 100.0f)
+			* Mat4::lookAt(Vec3(camera.eye[0], camera.eye[1], camera.eye[2]), Vec3(), Vec3(0.0f, 1.0f, 0.0f));
+		glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, viewProjection.m);
+		Frustum frustum = extractFrustum(viewProjection.m);
+
+		MeshletCullStats stats;
+		size_t count = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < ITERATIONS; i++) {
+			count = cullMeshlets(meshlets, frustum, camera.eye, visible, &stats);
+		}
+		double cullMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / ITERATIONS;
+
+		double fullMs = timeDraw([&]() {
+			glBindVertexArray(fullVAO);
+			glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+		});
+		// the culled draw includes uploading its compacted indices
+		double culledMs = timeDraw([&]() {
+			indexStream.beginFrame();
+			StreamAllocation space = indexStream.allocate(count * sizeof(unsigned int), sizeof(unsigned int));
+			if (space.valid()) {
+				std::memcpy(space.data, visible.data(), count * sizeof(unsigned int));
+				indexStream.flush();
+				glBindVertexArray(culledVAO);
+				glDrawElements(GL_TRIANGLES, (GLsizei)count, GL_UNSIGNED_INT, (void*)space.offset);
+			}
+			indexStream.endFrame();
+		});
+
+		std::cout << std::left << std::setw(10) << camera.name
+			<< std::right << std::setw(12) << stats.trianglesEmitted
+			<< std::setw(10) << stats.frustumCulled
+			<< std::setw(10) << stats.backfaceCulled
+			<< std::setprecision(3)
+			<< std::setw(10) << cullMs
+			<< std::setw(11) << fullMs
+			<< std::setw(12) << culledMs << std::endl;
+	}
+
+	indexStream.clear();
+	vertexArrays.clear();
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteProgram(shader.ID);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+uniform mat4 viewProjection;
+
+out vec3 Normal;
+
+void main()
+{
+	Normal = aNormal;
+	gl_Position = viewProjection * vec4(aPos, 1.0);
+}
@@ -0,0 +1,164 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_pool.h"
+#include "../../../dependencies/include/learnopengl/indirect_draw.h"
+#include "../benchmark.h"
+
+const int FRAMES = 100;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/multi-draw/shaders/";
+
+typedef VertexLayout<Position3f> ObjectVertex;
+
+const unsigned int quadIndices[] = { 0, 1, 3, 1, 2, 3 };
+
+struct SceneObject {
+	float x, y;
+	MeshAllocation mesh;
+};
+
+// objects inside a band sweeping across the screen are visible, so the command
+// list has to be rebuilt every frame
+bool isVisible(const SceneObject& object, float time) {
+	float band = std::fmod(time * 0.5f, 2.0f) - 1.0f;
+	return std::fabs(object.x - band) < 0.5f;
+}
+
+struct PathResult {
+	std::string name;
+	unsigned int drawCalls = 0;
+	double buildMs = 0.0;
+	double frameMs = 0.0;
+};
+
+// usage: multi_draw [object count]
+// draws many distinct meshes of one pool with a call each, then through command
+// lists built across threads and submitted with one multi-draw call
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("multi_draw", 512, 512);
+	if (!window) {
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	int objectCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	std::mt19937 rng(3);
+
+	Shader shader((shaderPath + "object.vs").c_str(), (shaderPath + "object.fs").c_str());
+
+	// every object is its own small quad in a single pool page
+	std::uniform_real_distribution<float> position(-1.0f, 1.0f), unit(0.0f, 1.0f);
+	MeshPool<ObjectVertex> pool(objectCount * 4, objectCount * 6, shader.ID);
+	std::vector<SceneObject> objects(objectCount);
+	for (SceneObject& object : objects) {
+		object.x = position(rng);
+		object.y = position(rng);
+		float size = 0.002f + 0.004f * unit(rng);
+		float vertices[] = {
+			object.x + size, object.y + size, 0.0f,
+			object.x + size, object.y - size, 0.0f,
+			object.x - size, object.y - size, 0.0f,
+			object.x - size, object.y + size, 0.0f
+		};
+		object.mesh = pool.add(vertices, 4, quadIndices, 6);
+	}
+
+	// culled objects keep their slot with an instance count of 0
+	auto makeCommand = [&](float time) {
+		return [&objects, time](size_t i) {
+			return indirectCommand(objects[i].mesh, isVisible(objects[i], time) ? 1 : 0);
+		};
+	};
+
+	auto timeFrames = [&](auto&& drawFrame) {
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			glClear(GL_COLOR_BUFFER_BIT);
+			drawFrame(frame / 60.0f);
+		}
+		glFinish();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+	};
+
+	std::vector<PathResult> results;
+	shader.use();
+
+	PathResult individual;
+	individual.name = "individual";
+	individual.frameMs = timeFrames([&](float time) {
+		pool.beginFrame();
+		for (const SceneObject& object : objects) {
+			if (isVisible(object, time)) {
+				pool.draw(object.mesh);
+			}
+		}
+		individual.drawCalls = pool.getStats().drawsThisFrame;
+	});
+	results.push_back(individual);
+
+	// each multi-draw path is run with the commands built on one thread and on all of them
+	auto runMultiDraw = [&](const std::string& name, bool allowIndirect, unsigned int buildThreads) {
+		IndirectDrawBuffer draws(objectCount, allowIndirect);
+		PathResult result;
+		result.name = name + (buildThreads > 1 ? " x" + std::to_string(buildThreads) : "");
+		double buildTotal = 0.0;
+		result.frameMs = timeFrames([&](float time) {
+			pool.beginFrame();
+			pool.bind(0);
+			draws.beginFrame();
+			auto start = std::chrono::high_resolution_clock::now();
+			draws.build(objects.size(), makeCommand(time), buildThreads);
+			buildTotal += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			draws.submit();
+			draws.endFrame();
+		});
+		result.buildMs = buildTotal / FRAMES;
+		result.drawCalls = draws.getStats().drawCalls;
+		draws.clear();
+		results.push_back(result);
+	};
+	runMultiDraw("multi-draw", false, 1);
+	runMultiDraw("multi-draw", false, threads);
+	if (glext.multiDrawIndirect) {
+		runMultiDraw("indirect", true, 1);
+		runMultiDraw("indirect", true, threads);
+	}
+
+	std::cout << objectCount << " objects in " << pool.pageCount() << " pool page, " << FRAMES << " frames"
+		<< (glext.multiDrawIndirect ? "" : ", ARB_multi_draw_indirect not available") << std::endl;
+	std::cout << std::left << std::setw(16) << "path"
+		<< std::right << std::setw(12) << "draw calls"
+		<< std::setw(11) << "build ms"
+		<< std::setw(11) << "ms/frame"
+		<< std::setw(10) << "speedup" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	for (const PathResult& result : results) {
+		std::cout << std::left << std::setw(16) << result.name
+			<< std::right << std::setw(12) << result.drawCalls
+			<< std::setw(11) << result.buildMs
+			<< std::setw(11) << result.frameMs
+			<< std::setw(10) << results[0].frameMs / result.frameMs << std::endl;
+	}
+
+	pool.clear();
+	glDeleteProgram(shader.ID);
+	glfwTerminate();
+	return 0;
+}
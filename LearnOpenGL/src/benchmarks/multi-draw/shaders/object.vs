@@ -0,0 +1,8 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// objects are baked into world space, so there is nothing to set per draw
+void main()
+{
+	gl_Position = vec4(aPos, 1.0);
+}
@@ -0,0 +1,300 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/occlusion_culling.h"
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+#include "../benchmark.h"
+
+const int FRAMES = 240;
+const int SCR_WIDTH = 1920;
+const int SCR_HEIGHT = 1080;
+const float FOV_Y = 0.785398f;	// 45 degrees
+const float SPACING = 4.0f;		// between spheres
+const int ROWS_PER_WALL = 4;
+const float WALL_HEIGHT = 6.0f;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/occlusion/shaders/";
+
+struct SceneVertex {
+	float position[3];
+	float normal[3];
+};
+
+struct Mesh {
+	unsigned int VAO = 0, VBO = 0, EBO = 0;
+	int indexCount = 0;
+};
+
+Mesh uploadMesh(const std::vector<SceneVertex>& vertices, const std::vector<unsigned int>& indices) {
+	Mesh mesh;
+	glGenVertexArrays(1, &mesh.VAO);
+	glGenBuffers(1, &mesh.VBO);
+	glGenBuffers(1, &mesh.EBO);
+	glBindVertexArray(mesh.VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SceneVertex), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SceneVertex), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SceneVertex), (void*)offsetof(SceneVertex, normal));
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+	mesh.indexCount = (int)indices.size();
+	return mesh;
+}
+
+void deleteMesh(Mesh& mesh) {
+	glDeleteVertexArrays(1, &mesh.VAO);
+	glDeleteBuffers(1, &mesh.VBO);
+	glDeleteBuffers(1, &mesh.EBO);
+}
+
+// unit sphere, size x size vertices, dense enough to make every draw count
+Mesh makeSphereMesh(int size) {
+	std::vector<SceneVertex> vertices;
+	std::vector<unsigned int> indices;
+	for (const SpherePoint& point : makeSphere(size, 1.0f, 0.0f, &indices)) {
+		SceneVertex vertex;
+		std::copy(point.position, point.position + 3, vertex.position);
+		std::copy(point.normal, point.normal + 3, vertex.normal);
+		vertices.push_back(vertex);
+	}
+	return uploadMesh(vertices, indices);
+}
+
+// cube over [0, 1], scaled and offset into walls
+Mesh makeCube() {
+	std::vector<SceneVertex> vertices;
+	std::vector<unsigned int> indices;
+	for (int axis = 0; axis < 3; axis++) {
+		for (int side = 0; side < 2; side++) {
+			int u = (axis + 1) % 3, v = (axis + 2) % 3;
+			unsigned int base = (unsigned int)vertices.size();
+			for (int corner = 0; corner < 4; corner++) {
+				SceneVertex vertex = {};
+				vertex.position[axis] = (float)side;
+				vertex.position[u] = (float)(corner & 1);
+				vertex.position[v] = (float)(corner >> 1);
+				vertex.normal[axis] = side ? 1.0f : -1.0f;
+				vertices.push_back(vertex);
+			}
+			// u x v points along +axis, so flip the winding on the negative side
+			unsigned int triangles[2][6] = { { 0, 2, 1, 1, 2, 3 }, { 0, 1, 2, 1, 3, 2 } };
+			for (unsigned int index : triangles[side]) {
+				indices.push_back(base + index);
+			}
+		}
+	}
+	return uploadMesh(vertices, indices);
+}
+
+struct Wall {
+	float offset[3];
+	float scale[3];
+};
+
+struct RunResult {
+	double cpuMs = 0.0;
+	double gpuMs = 0.0;
+	double drawn = 0.0;
+	double occluded = 0.0;
+	double skipped = 0.0;
+	double queries = 0.0;
+};
+
+// usage: occlusion [grid size] [sphere resolution]
+// a camera sweeps along the front of a grid of dense spheres (64 x 64 by
+// default) split up by rows of walls with gaps in them, and every frame is
+// drawn once with every sphere and once through OcclusionCuller. CPU time is
+// the submission time, GPU time comes from timer queries read after the run
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("occlusion");
+	if (!window) {
+		return -1;
+	}
+
+	int gridSize = argc > 1 ? std::max(4, std::atoi(argv[1])) : 64;
+	int sphereSize = argc > 2 ? std::max(8, std::atoi(argv[2])) : 96;
+
+	// offscreen 1080p target so fill matches a real screen
+	unsigned int FBO, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_CULL_FACE);
+
+	Mesh sphere = makeSphereMesh(sphereSize);
+	Mesh cube = makeCube();
+
+	std::string objectVert = shaderPath + "object.vs";
+	std::string objectFrag = shaderPath + "object.fs";
+	std::string boxVert = shaderPath + "occlusion_box.vs";
+	std::string boxFrag = shaderPath + "occlusion_box.fs";
+	Shader objectShader(objectVert.c_str(), objectFrag.c_str());
+	Shader boxShader(boxVert.c_str(), boxFrag.c_str());
+
+	// spheres on the ground, a wall in front of every few rows with a gap
+	// that moves along from wall to wall
+	float width = gridSize * SPACING;
+	std::vector<float> centers;
+	for (int row = 0; row < gridSize; row++) {
+		for (int column = 0; column < gridSize; column++) {
+			centers.push_back((column + 0.5f) * SPACING);
+			centers.push_back(1.0f);
+			centers.push_back((row + 0.5f) * SPACING);
+		}
+	}
+	std::vector<Wall> walls;
+	for (int row = ROWS_PER_WALL; row < gridSize; row += ROWS_PER_WALL) {
+		float gap = std::fmod(row * 0.37f * width, width - 2.0f * SPACING);
+		float z = row * SPACING - 0.25f;
+		walls.push_back({ { 0.0f, 0.0f, z }, { gap, WALL_HEIGHT, 0.5f } });
+		walls.push_back({ { gap + 2.0f * SPACING, 0.0f, z }, { width - gap - 2.0f * SPACING, WALL_HEIGHT, 0.5f } });
+	}
+
+	OcclusionCuller culler(boxShader.ID);
+	for (size_t i = 0; i < centers.size() / 3; i++) {
+		float boxMin[3], boxMax[3];
+		for (int c = 0; c < 3; c++) {
+			boxMin[c] = centers[i * 3 + c] - 1.0f;
+			boxMax[c] = centers[i * 3 + c] + 1.0f;
+		}
+		culler.addObject(boxMin, boxMax);
+	}
+
+	GLint offsetLocation = glGetUniformLocation(objectShader.ID, "offset");
+	GLint scaleLocation = glGetUniformLocation(objectShader.ID, "scale");
+	GLint colorLocation = glGetUniformLocation(objectShader.ID, "color");
+	auto drawSphere = [&](size_t i) {
+		glUniform3fv(offsetLocation, 1, &centers[i * 3]);
+		glDrawElements(GL_TRIANGLES, sphere.indexCount, GL_UNSIGNED_INT, (void*)0);
+	};
+
+	std::vector<unsigned int> timers(FRAMES);
+	glGenQueries(FRAMES, timers.data());
+
+	auto run = [&](bool cull) {
+		RunResult result;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			float sweep = std::sin(frame * 0.05f);
+			float eye[3] = { width * (0.5f + 0.4f * sweep), 3.0f, -6.0f };
+			float target[3] = { width * (0.5f + 0.2f * sweep), 1.0f, width };
+			Mat4 viewProjection = Mat4::perspective(FOV_Y, (float)SCR_WIDTH / SCR_HEIGHT, 0.1f, width * 2.0f)
+				* Mat4::lookAt(Vec3(eye[0], eye[1], eye[2]), Vec3(target[0], target[1], target[2]), Vec3(0.0f, 1.0f, 0.0f));
+
+			glBeginQuery(GL_TIME_ELAPSED, timers[frame]);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			boxShader.use();
+			glUniformMatrix4fv(glGetUniformLocation(boxShader.ID, "viewProjection"), 1, GL_FALSE, viewProjection.m);
+			objectShader.use();
+			glUniformMatrix4fv(glGetUniformLocation(objectShader.ID, "viewProjection"), 1, GL_FALSE, viewProjection.m);
+
+			// walls first, they are the main occluders
+			glBindVertexArray(cube.VAO);
+			glUniform3f(colorLocation, 0.6f, 0.6f, 0.6f);
+			for (const Wall& wall : walls) {
+				glUniform3fv(offsetLocation, 1, wall.offset);
+				glUniform3fv(scaleLocation, 1, wall.scale);
+				glDrawElements(GL_TRIANGLES, cube.indexCount, GL_UNSIGNED_INT, (void*)0);
+			}
+
+			glBindVertexArray(sphere.VAO);
+			glUniform3f(scaleLocation, 1.0f, 1.0f, 1.0f);
+			glUniform3f(colorLocation, 0.8f, 0.4f, 0.2f);
+			if (!cull) {
+				for (size_t i = 0; i < culler.size(); i++) {
+					drawSphere(i);
+				}
+				result.drawn += (double)culler.size();
+			}
+			else {
+				culler.beginFrame(eye);
+				for (unsigned int i = 0; i < culler.size(); i++) {
+					if (culler.isVisible(i)) {
+						culler.drawVisible(i, [&]() { drawSphere(i); });
+					}
+				}
+				culler.queryOccluded();
+				objectShader.use();
+				glBindVertexArray(sphere.VAO);
+				for (unsigned int i = 0; i < culler.size(); i++) {
+					if (!culler.isVisible(i)) {
+						culler.drawOccluded(i, [&]() { drawSphere(i); });
+					}
+				}
+				culler.endFrame();
+				OcclusionStats stats = culler.getStats();
+				result.drawn += stats.drawn;
+				result.occluded += stats.occluded;
+				result.skipped += stats.skipped;
+				result.queries += stats.queries;
+			}
+			glEndQuery(GL_TIME_ELAPSED);
+		}
+		result.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+		glFinish();
+
+		// the first frames fill the pipeline and, when culling, start with everything visible
+		for (int frame = FRAMES / 4; frame < FRAMES; frame++) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(timers[frame], GL_QUERY_RESULT, &elapsed);
+			result.gpuMs += elapsed / 1e6;
+		}
+		result.gpuMs /= FRAMES - FRAMES / 4;
+		result.drawn /= FRAMES;
+		result.occluded /= FRAMES;
+		result.skipped /= FRAMES;
+		result.queries /= FRAMES;
+		return result;
+	};
+
+	std::cout << culler.size() << " spheres of " << sphere.indexCount / 3 << " triangles, " << walls.size()
+		<< " walls, " << FRAMES << " frames" << std::endl;
+	std::cout << std::left << std::setw(12) << "mode" << std::right << std::setw(10) << "cpu ms" << std::setw(10) << "gpu ms"
+		<< std::setw(10) << "drawn" << std::setw(14) << "conditional" << std::setw(10) << "skipped" << std::setw(10) << "queries" << std::endl;
+	auto printRow = [](const char* name, const RunResult& result) {
+		std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << result.cpuMs << std::setw(10) << result.gpuMs << std::setprecision(0)
+			<< std::setw(10) << result.drawn << std::setw(14) << result.occluded << std::setw(10) << result.skipped << std::setw(10) << result.queries << std::endl;
+	};
+	printRow("draw all", run(false));
+	printRow("occlusion", run(true));
+
+	glDeleteQueries(FRAMES, timers.data());
+	culler.clear();
+	deleteMesh(sphere);
+	deleteMesh(cube);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteProgram(objectShader.ID);
+	glDeleteProgram(boxShader.ID);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 Normal;
+out vec4 FragColor;
+
+uniform vec3 color;
+
+void main()
+{
+	vec3 lightDir = normalize(vec3(0.3, 1.0, 0.5));
+	float diffuse = max(dot(normalize(Normal), lightDir), 0.0);
+	FragColor = vec4(color * (0.2 + 0.8 * diffuse), 1.0);
+}
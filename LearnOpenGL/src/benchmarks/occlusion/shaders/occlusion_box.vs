@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 viewProjection;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+void main()
+{
+	gl_Position = viewProjection * vec4(mix(boxMin, boxMax, aPos), 1.0);
+}
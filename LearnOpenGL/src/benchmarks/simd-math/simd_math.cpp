@@ -0,0 +1,180 @@
+// SIMD math library against plain scalar loops, no GL required
+//
+// usage: simd_math [count]
+// times matrix products, matrix * vector and point transforms over arrays of
+// count elements (1M by default), written the way they would be without a
+// math library (float[16] and triple loops, points as xyz structs) and with
+// simd_math.h. the checksum column only shows both sides computed the same
+// thing
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+
+const int ROUNDS = 10;
+
+struct PlainMatrix {
+	float m[16];
+};
+
+struct PlainPoint {
+	float x, y, z;
+};
+
+void plainMultiply(const PlainMatrix& a, const PlainMatrix& b, PlainMatrix& out) {
+	for (int col = 0; col < 4; col++) {
+		for (int row = 0; row < 4; row++) {
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++) {
+				sum += a.m[k * 4 + row] * b.m[col * 4 + k];
+			}
+			out.m[col * 4 + row] = sum;
+		}
+	}
+}
+
+void plainTransform(const PlainMatrix& a, const float* v, float* out) {
+	for (int row = 0; row < 4; row++) {
+		float sum = 0.0f;
+		for (int k = 0; k < 4; k++) {
+			sum += a.m[k * 4 + row] * v[k];
+		}
+		out[row] = sum;
+	}
+}
+
+// average ms per round of run
+template <typename Run>
+double timeRounds(Run&& run) {
+	run();		// warm up
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int round = 0; round < ROUNDS; round++) {
+		run();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / ROUNDS;
+}
+
+int main(int argc, char* argv[]) {
+	size_t count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Mat4> matrices(count), products(count);
+	std::vector<PlainMatrix> plainMatrices(count), plainProducts(count);
+	for (size_t i = 0; i < count; i++) {
+		Quat rotation = normalize(Quat(unit(random), unit(random), unit(random), unit(random)));
+		matrices[i] = Mat4::fromTrs(Vec3(unit(random), unit(random), unit(random)), rotation, Vec3(1.0f + 0.5f * unit(random)));
+		std::copy(matrices[i].m, matrices[i].m + 16, plainMatrices[i].m);
+	}
+	Mat4 viewProjection = Mat4::perspective(0.785398f, 16.0f / 9.0f, 0.1f, 100.0f)
+		* Mat4::lookAt(Vec3(0.0f, 2.0f, 5.0f), Vec3(0.0f), Vec3(0.0f, 1.0f, 0.0f));
+	PlainMatrix plainViewProjection;
+	std::copy(viewProjection.m, viewProjection.m + 16, plainViewProjection.m);
+
+	std::vector<Vec4> vectors(count), transformed(count);
+	std::vector<PlainPoint> points(count), plainOut(count);
+	std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+	for (size_t i = 0; i < count; i++) {
+		points[i] = { unit(random), unit(random), unit(random) };
+		vectors[i] = Vec4(points[i].x, points[i].y, points[i].z, 1.0f);
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+		z[i] = points[i].z;
+	}
+
+	std::cout << count << " elements, " << ROUNDS << " rounds" << std::endl;
+	std::cout << std::left << std::setw(34) << "operation" << std::right << std::setw(10) << "ms"
+		<< std::setw(12) << "M/s" << std::setw(14) << "checksum" << std::endl;
+	auto printRow = [&](const std::string& name, double ms, double checksum) {
+		std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << ms << std::setw(12) << std::setprecision(1) << count / ms / 1000.0
+			<< std::setw(14) << std::setprecision(3) << checksum << std::endl;
+	};
+
+	double ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			plainMultiply(plainViewProjection, plainMatrices[i], plainProducts[i]);
+		}
+	});
+	double checksum = 0.0;
+	for (const PlainMatrix& product : plainProducts) {
+		checksum += product.m[5];
+	}
+	printRow("mat4 * mat4, plain loops", ms, checksum);
+
+	ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			products[i] = scalarMultiply(viewProjection, matrices[i]);
+		}
+	});
+	checksum = 0.0;
+	for (const Mat4& product : products) {
+		checksum += product.m[5];
+	}
+	printRow("mat4 * mat4, scalarMultiply", ms, checksum);
+
+	ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			products[i] = viewProjection * matrices[i];
+		}
+	});
+	checksum = 0.0;
+	for (const Mat4& product : products) {
+		checksum += product.m[5];
+	}
+	printRow("mat4 * mat4, SIMD", ms, checksum);
+
+	ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			float v[4] = { points[i].x, points[i].y, points[i].z, 1.0f }, out[4];
+			plainTransform(plainViewProjection, v, out);
+			plainOut[i] = { out[0], out[1], out[3] };
+		}
+	});
+	checksum = 0.0;
+	for (const PlainPoint& point : plainOut) {
+		checksum += point.z;
+	}
+	printRow("mat4 * vec4, plain loops", ms, checksum);
+
+	ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			transformed[i] = viewProjection * vectors[i];
+		}
+	});
+	checksum = 0.0;
+	for (const Vec4& v : transformed) {
+		checksum += v.w;
+	}
+	printRow("mat4 * vec4, SIMD", ms, checksum);
+
+	ms = timeRounds([&]() {
+		for (size_t i = 0; i < count; i++) {
+			const float* m = matrices[0].m;
+			const PlainPoint& p = points[i];
+			plainOut[i] = { m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12], m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+				m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14] };
+		}
+	});
+	checksum = 0.0;
+	for (const PlainPoint& point : plainOut) {
+		checksum += point.x;
+	}
+	printRow("points, plain xyz structs", ms, checksum);
+
+	ms = timeRounds([&]() {
+		transformPoints(matrices[0], x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+	});
+	checksum = 0.0;
+	for (float value : outX) {
+		checksum += value;
+	}
+	printRow("points, SoA transformPoints", ms, checksum);
+	return 0;
+}
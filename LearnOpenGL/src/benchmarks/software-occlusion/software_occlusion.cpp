@@ -0,0 +1,258 @@
+// software occlusion culling against a city of occluders, no GL required
+//
+// usage: software_occlusion [object count]
+// a street level camera moves through a grid of buildings with small objects
+// (100k by default) scattered between them. each frame the buildings are
+// rasterized into MaskedDepthBuffer and the objects left after frustum
+// culling are tested against it, at a few buffer resolutions. rasterization
+// is rated in triangles submitted per second, testing in objects per second.
+// every few frames the culled objects are checked against a ray cast through
+// the pixel centers they cover; the run fails if the buffer hid one of them
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/frustum.h"
+#include "../../../dependencies/include/learnopengl/frustum_culling.h"
+#include "../../../dependencies/include/learnopengl/masked_occlusion.h"
+#include "../../../dependencies/include/learnopengl/simd_math.h"
+
+const int FRAMES = 100;
+const int CHECK_INTERVAL = 4;		// frames between checks against the ray cast reference, which is slow
+const int BLOCKS = 32;				// buildings per side
+const float BLOCK_SIZE = 20.0f;
+const float FOV_Y = 1.047198f;		// 60 degrees
+const float ASPECT = 2.0f;
+
+// appends a box as 12 counter clockwise triangles facing out
+void addBox(const float* boxMin, const float* boxMax, std::vector<float>& positions, std::vector<unsigned int>& indices) {
+	const unsigned int faces[] = {
+		0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+		3, 6, 2, 3, 7, 6,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5
+	};
+	const int corners[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+	unsigned int base = (unsigned int)(positions.size() / 3);
+	for (const int* corner : corners) {
+		for (int c = 0; c < 3; c++) {
+			positions.push_back(corner[c] ? boxMax[c] : boxMin[c]);
+		}
+	}
+	for (unsigned int index : faces) {
+		indices.push_back(base + index);
+	}
+}
+
+// where the segment from a to b enters the box, as a fraction of its length,
+// or a negative value when it misses. slab clipping
+float enterBox(const float* a, const float* b, const float* boxMin, const float* boxMax) {
+	float enter = 0.0f, leave = 1.0f;
+	for (int c = 0; c < 3; c++) {
+		float d = b[c] - a[c];
+		if (std::fabs(d) < 1e-12f) {
+			if (a[c] < boxMin[c] || a[c] > boxMax[c]) {
+				return -1.0f;
+			}
+			continue;
+		}
+		float t0 = (boxMin[c] - a[c]) / d, t1 = (boxMax[c] - a[c]) / d;
+		enter = std::max(enter, std::min(t0, t1));
+		leave = std::min(leave, std::max(t0, t1));
+		if (enter > leave) {
+			return -1.0f;
+		}
+	}
+	return enter;
+}
+
+// true when a building lies on the segment from the eye to the point.
+// buildings holds one min / max box per grid cell, so only the cells around
+// the segment are tested
+bool buildingBetween(const float* eye, const float* point, const std::vector<float>& buildings) {
+	// steps at most a cell apart, so every cell the segment crosses neighbours a step
+	float length = std::sqrt((point[0] - eye[0]) * (point[0] - eye[0]) + (point[2] - eye[2]) * (point[2] - eye[2]));
+	int steps = (int)(length / BLOCK_SIZE) + 1;
+	int lastX = -2, lastZ = -2;
+	for (int s = 0; s <= steps; s++) {
+		float t = (float)s / steps;
+		int cellX = (int)std::floor((eye[0] + (point[0] - eye[0]) * t) / BLOCK_SIZE);
+		int cellZ = (int)std::floor((eye[2] + (point[2] - eye[2]) * t) / BLOCK_SIZE);
+		if (cellX == lastX && cellZ == lastZ) {
+			continue;
+		}
+		lastX = cellX;
+		lastZ = cellZ;
+		for (int z = std::max(0, cellZ - 1); z <= std::min(BLOCKS - 1, cellZ + 1); z++) {
+			for (int x = std::max(0, cellX - 1); x <= std::min(BLOCKS - 1, cellX + 1); x++) {
+				const float* box = &buildings[((size_t)z * BLOCKS + x) * 6];
+				if (enterBox(eye, point, box, box + 3) >= 0.0f) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// reference for the depth buffer: the objects among tested that cullOccluded
+// left out of kept although a ray from the eye through one of the pixel
+// centers they cover reaches them before any building. a conservative buffer
+// of width x height pixels never does this
+size_t countFalselyHidden(const CullingBounds& objects, const std::vector<unsigned int>& tested,
+	const std::vector<unsigned int>& kept, size_t keptCount, const float* eye, const Mat4& viewProjection,
+	const std::vector<float>& buildings, int width, int height) {
+	std::vector<unsigned int> sortedKept(kept.begin(), kept.begin() + keptCount);
+	std::sort(sortedKept.begin(), sortedKept.end());
+	Mat4 unproject = inverse(viewProjection);
+	const float* m = viewProjection.m;
+	size_t wrong = 0;
+	for (unsigned int object : tested) {
+		if (std::binary_search(sortedKept.begin(), sortedKept.end(), object)) {
+			continue;
+		}
+		float extent[3] = { objects.r[object] + objects.ex[object], objects.r[object] + objects.ey[object], objects.r[object] + objects.ez[object] };
+		float boxMin[3] = { objects.x[object] - extent[0], objects.y[object] - extent[1], objects.z[object] - extent[2] };
+		float boxMax[3] = { objects.x[object] + extent[0], objects.y[object] + extent[1], objects.z[object] + extent[2] };
+
+		// pixel rectangle of the box; hidden boxes lie wholly in front of the eye
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		for (int corner = 0; corner < 8; corner++) {
+			float p[3] = { corner & 1 ? boxMax[0] : boxMin[0], corner & 2 ? boxMax[1] : boxMin[1], corner & 4 ? boxMax[2] : boxMin[2] };
+			float clip[4];
+			for (int r = 0; r < 4; r++) {
+				clip[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+			}
+			float x = (clip[0] / clip[3] * 0.5f + 0.5f) * width, y = (clip[1] / clip[3] * 0.5f + 0.5f) * height;
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+		}
+		int pixelMinX = std::max(0, (int)std::ceil(minX - 0.5f)), pixelMaxX = std::min(width - 1, (int)std::floor(maxX - 0.5f));
+		int pixelMinY = std::max(0, (int)std::ceil(minY - 0.5f)), pixelMaxY = std::min(height - 1, (int)std::floor(maxY - 0.5f));
+
+		bool seen = false;
+		for (int py = pixelMinY; py <= pixelMaxY && !seen; py++) {
+			for (int px = pixelMinX; px <= pixelMaxX && !seen; px++) {
+				// the far end of the pixel's ray, unprojected from the far plane
+				float ndc[4] = { (px + 0.5f) / width * 2.0f - 1.0f, (py + 0.5f) / height * 2.0f - 1.0f, 1.0f, 1.0f };
+				float far[4];
+				for (int r = 0; r < 4; r++) {
+					far[r] = 0.0f;
+					for (int c = 0; c < 4; c++) {
+						far[r] += unproject.m[c * 4 + r] * ndc[c];
+					}
+				}
+				for (int c = 0; c < 3; c++) {
+					far[c] /= far[3];
+				}
+				float enter = enterBox(eye, far, boxMin, boxMax);
+				if (enter < 0.0f) {
+					continue;
+				}
+				float hit[3];
+				for (int c = 0; c < 3; c++) {
+					hit[c] = eye[c] + (far[c] - eye[c]) * enter;
+				}
+				seen = !buildingBetween(eye, hit, buildings);
+			}
+		}
+		if (seen) {
+			wrong++;
+		}
+	}
+	return wrong;
+}
+
+int main(int argc, char* argv[]) {
+	size_t objectCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+	float worldSize = BLOCKS * BLOCK_SIZE;
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<float> positions, buildings;
+	std::vector<unsigned int> indices;
+	for (int z = 0; z < BLOCKS; z++) {
+		for (int x = 0; x < BLOCKS; x++) {
+			float footprint = BLOCK_SIZE * (0.5f + 0.2f * unit(random));
+			float boxMin[3] = { (x + 0.5f) * BLOCK_SIZE - footprint * 0.5f, 0.0f, (z + 0.5f) * BLOCK_SIZE - footprint * 0.5f };
+			float boxMax[3] = { boxMin[0] + footprint, 10.0f + 30.0f * unit(random), boxMin[2] + footprint };
+			addBox(boxMin, boxMax, positions, indices);
+			buildings.insert(buildings.end(), boxMin, boxMin + 3);
+			buildings.insert(buildings.end(), boxMax, boxMax + 3);
+		}
+	}
+
+	CullingBounds objects;
+	objects.reserve(objectCount);
+	for (size_t i = 0; i < objectCount; i++) {
+		float size = 0.25f + 0.75f * unit(random);
+		float center[3] = { unit(random) * worldSize, size + 4.0f * unit(random), unit(random) * worldSize };
+		float boxMin[3] = { center[0] - size, center[1] - size, center[2] - size };
+		float boxMax[3] = { center[0] + size, center[1] + size, center[2] + size };
+		objects.addBox(boxMin, boxMax);
+	}
+
+	std::cout << BLOCKS * BLOCKS << " buildings, " << indices.size() / 3 << " occluder triangles, " << objectCount
+		<< " objects, " << FRAMES << " frames" << std::endl;
+	std::cout << std::right << std::setw(11) << "resolution" << std::setw(12) << "raster ms" << std::setw(12) << "Mtri/s"
+		<< std::setw(10) << "test ms" << std::setw(14) << "Mobjects/s" << std::setw(10) << "frustum" << std::setw(12) << "occlusion"
+		<< std::setw(8) << "wrong" << std::endl;
+
+	const int resolutions[][2] = { { 256, 128 }, { 512, 256 }, { 1024, 512 } };
+	std::vector<unsigned int> visible, tested;
+	size_t totalWrong = 0;
+	for (const int* resolution : resolutions) {
+		MaskedDepthBuffer buffer(resolution[0], resolution[1]);
+		double rasterMs = 0.0, testMs = 0.0;
+		size_t triangles = 0, frustumVisible = 0, occlusionVisible = 0, wrong = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			// down the middle of a street, swinging the view from side to side
+			float along = worldSize * (0.1f + 0.8f * frame / FRAMES);
+			float swing = std::sin(frame * 0.1f);
+			float eye[3] = { worldSize * 0.5f, 2.0f, along };
+			float target[3] = { eye[0] + 50.0f * swing, 2.0f, along + 50.0f };
+			Mat4 viewProjection = Mat4::perspective(FOV_Y, ASPECT, 0.5f, worldSize)
+				* Mat4::lookAt(Vec3(eye[0], eye[1], eye[2]), Vec3(target[0], target[1], target[2]), Vec3(0.0f, 1.0f, 0.0f));
+
+			auto start = std::chrono::high_resolution_clock::now();
+			buffer.beginFrame(viewProjection.m);
+			buffer.renderOccluder(positions.data(), 3 * sizeof(float), indices.data(), indices.size());
+			auto rasterized = std::chrono::high_resolution_clock::now();
+
+			size_t count = cullFrustum(extractFrustum(viewProjection.m), objects, visible, 1);
+			tested.assign(visible.begin(), visible.begin() + count);
+			auto culled = std::chrono::high_resolution_clock::now();
+			size_t kept = buffer.cullOccluded(objects, visible, count);
+			auto done = std::chrono::high_resolution_clock::now();
+			if (frame % CHECK_INTERVAL == 0) {
+				wrong += countFalselyHidden(objects, tested, visible, kept, eye, viewProjection, buildings,
+					buffer.getWidth(), buffer.getHeight());
+			}
+
+			rasterMs += std::chrono::duration<double, std::milli>(rasterized - start).count();
+			testMs += std::chrono::duration<double, std::milli>(done - culled).count();
+			triangles += indices.size() / 3;
+			frustumVisible += count;
+			occlusionVisible += kept;
+		}
+		std::cout << std::right << std::setw(11) << std::to_string(resolution[0]) + "x" + std::to_string(resolution[1])
+			<< std::fixed << std::setprecision(3) << std::setw(12) << rasterMs / FRAMES
+			<< std::setprecision(1) << std::setw(12) << triangles / rasterMs / 1000.0
+			<< std::setprecision(3) << std::setw(10) << testMs / FRAMES
+			<< std::setprecision(1) << std::setw(14) << frustumVisible / testMs / 1000.0
+			<< std::setw(10) << frustumVisible / FRAMES << std::setw(12) << occlusionVisible / FRAMES << std::setw(8) << wrong << std::endl;
+		totalWrong += wrong;
+	}
+	if (totalWrong > 0) {
+		std::cout << totalWrong << " objects culled although a ray from the eye reaches them" << std::endl;
+		return -1;
+	}
+	return 0;
+}
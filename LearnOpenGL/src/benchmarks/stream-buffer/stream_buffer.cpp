@@ -0,0 +1,170 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/gl_extensions.h"
+#include "../../../dependencies/include/learnopengl/stream_buffer.h"
+#include "../benchmark.h"
+
+const int FRAMES = 300;
+const size_t VERTEX_STRIDE = 3 * sizeof(float);
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/stream-buffer/shaders/";
+
+enum class UploadMethod {
+	BufferSubData,		// rewrite one buffer in place
+	Orphaning,			// glBufferData(NULL) then glBufferSubData
+	Unsynchronized,		// StreamBuffer ring mapped with GL_MAP_UNSYNCHRONIZED_BIT
+	Persistent			// StreamBuffer ring with ARB_buffer_storage
+};
+
+struct UploadResult {
+	double msPerFrame = 0.0;
+	unsigned int stalls = 0;
+};
+
+// fills vertices for one frame of animation
+void animate(float* out, size_t vertexCount, int frame) {
+	float phase = frame * 0.05f;
+	for (size_t v = 0; v < vertexCount; v++) {
+		float t = (float)v / vertexCount;
+		out[v * 3] = std::cos(t * 6.2831853f + phase) * 0.9f;
+		out[v * 3 + 1] = std::sin(t * 6.2831853f * 3.0f + phase) * 0.9f;
+		out[v * 3 + 2] = t;
+	}
+}
+
+// streams vertexCount vertices every frame and draws them as points with
+// rasterization disabled, so upload cost dominates
+UploadResult run(UploadMethod method, size_t vertexCount, const Shader& shader) {
+	size_t frameBytes = vertexCount * VERTEX_STRIDE;
+	std::vector<float> staging(vertexCount * 3);
+	UploadResult result;
+
+	unsigned int VBO = 0, VAO;
+	StreamBuffer* stream = nullptr;
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	if (method == UploadMethod::BufferSubData || method == UploadMethod::Orphaning) {
+		glGenBuffers(1, &VBO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, frameBytes, nullptr, GL_STREAM_DRAW);
+	}
+	else {
+		stream = new StreamBuffer(GL_ARRAY_BUFFER, frameBytes, 3, method == UploadMethod::Persistent);
+		glBindBuffer(GL_ARRAY_BUFFER, stream->buffer());
+	}
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void*) 0);
+	glEnableVertexAttribArray(0);
+
+	shader.use();
+	glEnable(GL_RASTERIZER_DISCARD);
+	glFinish();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		GLint first = 0;
+		if (stream) {
+			// animation is written straight into the mapped ring
+			stream->beginFrame();
+			StreamAllocation allocation = stream->allocate(frameBytes, VERTEX_STRIDE);
+			animate((float*)allocation.data, vertexCount, frame);
+			stream->flush();
+			first = (GLint)(allocation.offset / VERTEX_STRIDE);
+		}
+		else {
+			animate(staging.data(), vertexCount, frame);
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			if (method == UploadMethod::Orphaning) {
+				glBufferData(GL_ARRAY_BUFFER, frameBytes, nullptr, GL_STREAM_DRAW);
+			}
+			glBufferSubData(GL_ARRAY_BUFFER, 0, frameBytes, staging.data());
+		}
+
+		glDrawArrays(GL_POINTS, first, (GLsizei)vertexCount);
+		if (stream) {
+			stream->endFrame();
+		}
+		glFlush();
+	}
+	glFinish();
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	result.msPerFrame = seconds * 1000.0 / FRAMES;
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	if (stream) {
+		result.stalls = stream->getStats().stalls;
+		stream->clear();
+		delete stream;
+	}
+	glDeleteBuffers(1, &VBO);
+	glDeleteVertexArrays(1, &VAO);
+	return result;
+}
+
+// usage: stream_buffer [vertices per frame...]
+// compares per frame vertex uploads through glBufferSubData, orphaning with
+// glBufferData, an unsynchronized mapped ring and a persistent mapped ring
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("stream_buffer");
+	if (!window) {
+		return -1;
+	}
+	loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+	std::vector<size_t> sizes;
+	for (int i = 1; i < argc; i++) {
+		sizes.push_back((size_t)std::max(1, std::atoi(argv[i])));
+	}
+	if (sizes.empty()) {
+		sizes = { 1024, 16384, 262144, 1048576 };
+	}
+
+	std::string vertPath = shaderPath + "stream.vs";
+	std::string fragPath = shaderPath + "stream.fs";
+	Shader shader(vertPath.c_str(), fragPath.c_str());
+
+	std::cout << FRAMES << " frames per run";
+	if (!glext.bufferStorage) {
+		std::cout << ", ARB_buffer_storage unavailable so the persistent ring is skipped";
+	}
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(16) << "method"
+		<< std::right << std::setw(10) << "vertices"
+		<< std::setw(10) << "KiB"
+		<< std::setw(12) << "ms/frame"
+		<< std::setw(10) << "GB/s"
+		<< std::setw(9) << "stalls" << std::endl;
+
+	const char* names[] = { "BufferSubData", "orphaning", "unsynchronized", "persistent" };
+	for (size_t vertexCount : sizes) {
+		for (int m = 0; m < 4; m++) {
+			UploadMethod method = (UploadMethod)m;
+			if (method == UploadMethod::Persistent && !glext.bufferStorage) {
+				continue;
+			}
+			UploadResult result = run(method, vertexCount, shader);
+			double bytes = (double)vertexCount * VERTEX_STRIDE;
+			std::cout << std::left << std::setw(16) << names[m]
+				<< std::right << std::setw(10) << vertexCount
+				<< std::setw(10) << (size_t)bytes / 1024
+				<< std::fixed << std::setprecision(3)
+				<< std::setw(12) << result.msPerFrame
+				<< std::setprecision(2)
+				<< std::setw(10) << bytes / (result.msPerFrame * 1e6)
+				<< std::setw(9) << result.stalls << std::endl;
+		}
+	}
+
+	glDeleteProgram(shader.ID);
+	glfwTerminate();
+	return 0;
+}
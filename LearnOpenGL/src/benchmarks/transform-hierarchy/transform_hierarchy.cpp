@@ -0,0 +1,181 @@
+// world matrix updates over a large transform hierarchy, no GL required
+//
+// usage: transform_hierarchy [node count] [threads]
+// builds a forest of trees four levels deep (1M nodes by default) and times
+// TransformHierarchy::update when every node moved, when a tenth of the roots
+// moved, when one leaf in a hundred moved and when nothing moved, on one
+// thread and on all threads (or the given count). a recursive scene graph of
+// heap nodes that recomputes everything is timed for comparison
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/transform_hierarchy.h"
+
+const int FRAMES = 20;
+const int BRANCHING = 10;		// children per node above the leaves
+
+// the usual object oriented scene graph
+struct SceneNode {
+	float translation[3] = { 0.0f, 0.0f, 0.0f };
+	float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float scale[3] = { 1.0f, 1.0f, 1.0f };
+	float world[16];
+	std::vector<std::unique_ptr<SceneNode>> children;
+
+	void update(const float* parentWorld) {
+		float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+		float local[16] = {
+			(1.0f - 2.0f * (y * y + z * z)) * scale[0], 2.0f * (x * y + w * z) * scale[0], 2.0f * (x * z - w * y) * scale[0], 0.0f,
+			2.0f * (x * y - w * z) * scale[1], (1.0f - 2.0f * (x * x + z * z)) * scale[1], 2.0f * (y * z + w * x) * scale[1], 0.0f,
+			2.0f * (x * z + w * y) * scale[2], 2.0f * (y * z - w * x) * scale[2], (1.0f - 2.0f * (x * x + y * y)) * scale[2], 0.0f,
+			translation[0], translation[1], translation[2], 1.0f
+		};
+		if (parentWorld) {
+			for (int col = 0; col < 4; col++) {
+				for (int row = 0; row < 4; row++) {
+					float sum = 0.0f;
+					for (int k = 0; k < 4; k++) {
+						sum += parentWorld[k * 4 + row] * local[col * 4 + k];
+					}
+					world[col * 4 + row] = sum;
+				}
+			}
+		}
+		else {
+			std::copy(local, local + 16, world);
+		}
+		for (std::unique_ptr<SceneNode>& child : children) {
+			child->update(world);
+		}
+	}
+};
+
+// half angle rotation about y, as a quaternion
+void yawQuaternion(float angle, float* q) {
+	q[0] = 0.0f;
+	q[1] = std::sin(angle * 0.5f);
+	q[2] = 0.0f;
+	q[3] = std::cos(angle * 0.5f);
+}
+
+template <typename Run>
+double timeFrames(Run&& run) {
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		run(frame);
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+}
+
+int main(int argc, char* argv[]) {
+	size_t nodeCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+	unsigned int threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+
+	// a tree is 1 + 10 + 100 + 1000 nodes; built breadth first, as a loader would
+	const size_t treeSize = 1 + BRANCHING + BRANCHING * BRANCHING + BRANCHING * BRANCHING * BRANCHING;
+	size_t trees = std::max<size_t>(1, nodeCount / treeSize);
+	TransformHierarchy hierarchy;
+	hierarchy.reserve(trees * treeSize);
+	std::vector<std::unique_ptr<SceneNode>> roots;
+	std::vector<unsigned int> rootNodes, leafNodes;
+	std::vector<unsigned int> level, nextLevel;
+	std::vector<SceneNode*> sceneLevel, nextSceneLevel;
+	for (size_t t = 0; t < trees; t++) {
+		unsigned int root = hierarchy.addNode();
+		hierarchy.setTranslation(root, (float)(t % 1000) * 10.0f, 0.0f, (float)(t / 1000) * 10.0f);
+		rootNodes.push_back(root);
+		roots.push_back(std::unique_ptr<SceneNode>(new SceneNode()));
+		level.assign(1, root);
+		sceneLevel.assign(1, roots.back().get());
+		for (int depth = 1; depth < 4; depth++) {
+			nextLevel.clear();
+			nextSceneLevel.clear();
+			for (size_t i = 0; i < level.size(); i++) {
+				for (int c = 0; c < BRANCHING; c++) {
+					unsigned int node = hierarchy.addNode(level[i]);
+					hierarchy.setTranslation(node, 1.0f + c, 0.5f, 0.0f);
+					nextLevel.push_back(node);
+					sceneLevel[i]->children.push_back(std::unique_ptr<SceneNode>(new SceneNode()));
+					SceneNode* child = sceneLevel[i]->children.back().get();
+					child->translation[0] = 1.0f + c;
+					child->translation[1] = 0.5f;
+					nextSceneLevel.push_back(child);
+				}
+			}
+			std::swap(level, nextLevel);
+			std::swap(sceneLevel, nextSceneLevel);
+		}
+		leafNodes.insert(leafNodes.end(), level.begin(), level.end());
+	}
+	hierarchy.update(threads);
+
+	std::cout << hierarchy.size() << " nodes in " << trees << " trees, " << FRAMES << " frames" << std::endl;
+	std::cout << std::left << std::setw(30) << "update" << std::right << std::setw(10) << "ms"
+		<< std::setw(12) << "updated" << std::setw(14) << "Mupdated/s" << std::endl;
+	auto printRow = [&](const std::string& name, double ms, size_t updated) {
+		std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << ms << std::setw(12) << updated << std::setw(14) << std::setprecision(1)
+			<< updated / ms / 1000.0 << std::endl;
+	};
+
+	size_t updated = 0;
+	double ms = timeFrames([&](int frame) {
+		for (std::unique_ptr<SceneNode>& root : roots) {
+			yawQuaternion(frame * 0.01f, root->rotation);
+			root->update(nullptr);
+		}
+	});
+	printRow("scene graph, everything", ms, hierarchy.size());
+
+	for (unsigned int t : { 1u, threads }) {
+		std::string suffix = ", " + std::to_string(t) + " thread" + (t > 1 ? "s" : "");
+		ms = timeFrames([&](int frame) {
+			float q[4];
+			yawQuaternion(frame * 0.01f, q);
+			for (unsigned int node = 0; node < hierarchy.size(); node++) {
+				hierarchy.rx[node] = q[0];
+				hierarchy.ry[node] = q[1];
+				hierarchy.rz[node] = q[2];
+				hierarchy.rw[node] = q[3];
+				hierarchy.markDirty(node);
+			}
+			updated = hierarchy.update(t);
+		});
+		printRow("every node" + suffix, ms, updated);
+
+		ms = timeFrames([&](int frame) {
+			float q[4];
+			yawQuaternion(frame * 0.01f, q);
+			for (size_t i = frame % 10; i < rootNodes.size(); i += 10) {
+				hierarchy.setRotation(rootNodes[i], q[0], q[1], q[2], q[3]);
+			}
+			updated = hierarchy.update(t);
+		});
+		printRow("1 root in 10" + suffix, ms, updated);
+
+		ms = timeFrames([&](int frame) {
+			for (size_t i = frame % 100; i < leafNodes.size(); i += 100) {
+				hierarchy.setScale(leafNodes[i], 1.0f, 1.0f + frame * 0.01f, 1.0f);
+			}
+			updated = hierarchy.update(t);
+		});
+		printRow("1 leaf in 100" + suffix, ms, updated);
+
+		ms = timeFrames([&](int) {
+			updated = hierarchy.update(t);
+		});
+		printRow("nothing" + suffix, ms, updated);
+		if (threads == 1) {
+			break;
+		}
+	}
+	return 0;
+}
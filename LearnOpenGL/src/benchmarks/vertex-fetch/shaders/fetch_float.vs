@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aColor;
+
+void main()
+{
+	// every attribute feeds the output so none of them is optimized away
+	vec3 position = aPos + (aNormal + vec3(aTexCoord, 0.0) + aColor) * 0.001;
+	gl_Position = vec4(position, 1.0);
+}
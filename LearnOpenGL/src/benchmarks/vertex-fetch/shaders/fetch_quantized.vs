@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) in vec4 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec4 aColor;
+
+// decode of the quantized mesh bounds
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform vec2 texCoordScale;
+uniform vec2 texCoordOffset;
+
+// inverse of the octahedral mapping done on the CPU
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+void main()
+{
+	vec3 normal = decodeOctahedral(aNormal);
+	vec2 texCoord = aTexCoord * texCoordScale + texCoordOffset;
+	vec3 position = aPos.xyz * positionScale + positionOffset;
+
+	// every attribute feeds the output so none of them is optimized away
+	position += (normal + vec3(texCoord, 0.0) + aColor.rgb) * 0.001;
+	gl_Position = vec4(position, 1.0);
+}
@@ -0,0 +1,178 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/shader.h"
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/vertex_quantize.h"
+#include "../benchmark.h"
+
+const int ITERATIONS = 20;
+
+const std::string shaderPath = std::filesystem::current_path().string() + "/src/benchmarks/vertex-fetch/shaders/";
+
+// uncompressed vertex as the samples store it, 44 bytes
+struct FloatVertex {
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+	float color[3];
+};
+
+typedef VertexLayout<Position3f, Normal3f, TexCoord2f, Color3f> FloatLayout;
+static_assert(FloatLayout::stride == sizeof(FloatVertex), "FloatLayout must match FloatVertex");
+
+// largest position and normal errors introduced by quantization
+void reportError(const char* name, const std::vector<FloatVertex>& source, const QuantizedMesh& mesh) {
+	double maxPosition = 0.0, maxAngle = 0.0;
+	for (size_t i = 0; i < source.size(); i++) {
+		const QuantizedVertex& q = mesh.vertices[i];
+		for (int c = 0; c < 3; c++) {
+			float decoded;
+			if (mesh.encoding == PositionEncoding::Half) {
+				uint32_t bits = (uint32_t)(uint16_t)q.position[c];
+				uint32_t exponent = (bits >> 10) & 0x1f, mantissa = bits & 0x3ff;
+				float magnitude = exponent == 0 ? std::ldexp((float)mantissa, -24) : std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+				decoded = bits & 0x8000 ? -magnitude : magnitude;
+			}
+			else {
+				decoded = q.position[c] / 32767.0f * mesh.positionScale[c] + mesh.positionOffset[c];
+			}
+			maxPosition = std::max(maxPosition, (double)std::fabs(decoded - source[i].position[c]));
+		}
+
+		float normal[3];
+		decodeOctahedral(q.normal, normal);
+		double dot = normal[0] * source[i].normal[0] + normal[1] * source[i].normal[1] + normal[2] * source[i].normal[2];
+		maxAngle = std::max(maxAngle, std::acos(std::min(1.0, dot)) * 180.0 / 3.14159265);
+	}
+	std::cout << name << ": max position error " << maxPosition << ", max normal error " << maxAngle << " degrees" << std::endl;
+}
+
+// average GPU time of drawing every vertex as a point with rasterization disabled
+double timeDraw(unsigned int VAO, const Shader& shader, const QuantizedMesh* mesh, GLsizei vertexCount) {
+	shader.use();
+	if (mesh) {
+		mesh->setUniforms(shader.ID);
+	}
+	glBindVertexArray(VAO);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	// warm up
+	glDrawArrays(GL_POINTS, 0, vertexCount);
+	glFinish();
+
+	double totalMs = 0.0;
+	for (int i = 0; i < ITERATIONS; i++) {
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		glDrawArrays(GL_POINTS, 0, vertexCount);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		totalMs += elapsed / 1e6;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	glDeleteQueries(1, &query);
+	return totalMs / ITERATIONS;
+}
+
+// usage: vertex_fetch [grid size]
+// compares vertex fetch bound draws of float and quantized vertices
+int main(int argc, char* argv[]) {
+	// hidden window, only needed for a GL context
+	GLFWwindow* window = createBenchmarkWindow("vertex_fetch");
+	if (!window) {
+		return -1;
+	}
+
+	int gridSize = argc > 1 ? std::atoi(argv[1]) : 2048;
+	// sphere tessellated into a gridSize x gridSize grid of vertices
+	std::vector<FloatVertex> vertices;
+	for (const SpherePoint& point : makeSphere(gridSize, 0.9f)) {
+		FloatVertex vertex;
+		for (int c = 0; c < 3; c++) {
+			vertex.position[c] = point.position[c];
+			vertex.normal[c] = point.normal[c];
+			vertex.color[c] = point.normal[c] * 0.5f + 0.5f;
+		}
+		vertex.texCoord[0] = point.u * 4.0f;
+		vertex.texCoord[1] = point.v * 2.0f;
+		vertices.push_back(vertex);
+	}
+	GLsizei vertexCount = (GLsizei)vertices.size();
+
+	VertexStreams streams;
+	streams.vertexCount = vertices.size();
+	streams.stride = sizeof(FloatVertex);
+	streams.positions = vertices[0].position;
+	streams.normals = vertices[0].normal;
+	streams.texCoords = vertices[0].texCoord;
+	streams.colors = vertices[0].color;
+	QuantizedMesh halfMesh = quantizeVertices(streams, PositionEncoding::Half);
+	QuantizedMesh snormMesh = quantizeVertices(streams, PositionEncoding::Snorm16);
+	reportError("half positions", vertices, halfMesh);
+	reportError("snorm16 positions", vertices, snormMesh);
+
+	std::string vertFloat = shaderPath + "fetch_float.vs";
+	std::string vertQuantized = shaderPath + "fetch_quantized.vs";
+	std::string frag = shaderPath + "fetch.fs";
+	Shader floatShader(vertFloat.c_str(), frag.c_str());
+	Shader quantizedShader(vertQuantized.c_str(), frag.c_str());
+
+	// one VBO and VAO per format
+	unsigned int VBOs[3], VAOs[3];
+	glGenBuffers(3, VBOs);
+	glGenVertexArrays(3, VAOs);
+
+	glBindVertexArray(VAOs[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, VBOs[0]);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(FloatVertex), vertices.data(), GL_STATIC_DRAW);
+	FloatLayout::setup(VBOs[0], floatShader.ID);
+
+	const QuantizedMesh* meshes[] = { &halfMesh, &snormMesh };
+	for (int i = 0; i < 2; i++) {
+		glBindVertexArray(VAOs[i + 1]);
+		glBindBuffer(GL_ARRAY_BUFFER, VBOs[i + 1]);
+		glBufferData(GL_ARRAY_BUFFER, meshes[i]->vertices.size() * sizeof(QuantizedVertex), meshes[i]->vertices.data(), GL_STATIC_DRAW);
+		meshes[i]->setup(VBOs[i + 1], quantizedShader.ID);
+	}
+
+	double floatMs = timeDraw(VAOs[0], floatShader, nullptr, vertexCount);
+	double halfMs = timeDraw(VAOs[1], quantizedShader, &halfMesh, vertexCount);
+	double snormMs = timeDraw(VAOs[2], quantizedShader, &snormMesh, vertexCount);
+
+	std::cout << vertexCount << " vertices, " << ITERATIONS << " iterations" << std::endl;
+	std::cout << std::left << std::setw(18) << "format"
+		<< std::right << std::setw(8) << "bytes"
+		<< std::setw(12) << "MiB"
+		<< std::setw(10) << "ms"
+		<< std::setw(12) << "Mverts/s" << std::endl;
+	const char* names[] = { "float32", "quantized half", "quantized snorm16" };
+	size_t strides[] = { sizeof(FloatVertex), sizeof(QuantizedVertex), sizeof(QuantizedVertex) };
+	double times[] = { floatMs, halfMs, snormMs };
+	for (int i = 0; i < 3; i++) {
+		std::cout << std::left << std::setw(18) << names[i]
+			<< std::right << std::setw(8) << strides[i]
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(12) << strides[i] * (double)vertexCount / (1024.0 * 1024.0)
+			<< std::setw(10) << times[i]
+			<< std::setw(12) << vertexCount / (times[i] * 1000.0) << std::endl;
+	}
+
+	glDeleteVertexArrays(3, VAOs);
+	glDeleteBuffers(3, VBOs);
+	glDeleteProgram(floatShader.ID);
+	glDeleteProgram(quantizedShader.ID);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,104 @@
+// converts OBJ and glTF models into mesh cache files, no GL required
+//
+// usage: mesh_convert input.(obj|gltf|glb) output.mesh [--lods count] [--encode]
+// the model is imported with positions, texture coords and normals, welded and
+// reordered for the vertex cache and vertex fetch, simplified into count levels
+// of detail (1 keeps only the full mesh) and written for MeshCache to map,
+// with --encode compressed with mesh_codec.h
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../../../dependencies/include/learnopengl/vertex_layout.h"
+#include "../../../dependencies/include/learnopengl/mesh_import.h"
+#include "../../../dependencies/include/learnopengl/mesh_optimizer.h"
+#include "../../../dependencies/include/learnopengl/mesh_simplify.h"
+#include "../../../dependencies/include/learnopengl/mesh_cache.h"
+
+struct ModelVertex {
+	float position[3];
+	float texCoord[2];
+	float normal[3];
+};
+
+typedef VertexLayout<Position3f, TexCoord2f, Normal3f> ModelLayout;
+static_assert(ModelLayout::stride == sizeof(ModelVertex), "ModelLayout must match ModelVertex");
+
+int main(int argc, char* argv[]) {
+	std::string input, output;
+	int lodCount = 6;
+	bool encode = false;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+			lodCount = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--encode") == 0) {
+			encode = true;
+		}
+		else if (input.empty()) {
+			input = argv[i];
+		}
+		else {
+			output = argv[i];
+		}
+	}
+	if (input.empty() || output.empty()) {
+		std::cout << "usage: mesh_convert input.(obj|gltf|glb) output.mesh [--lods count] [--encode]" << std::endl;
+		return -1;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	ImportedMesh mesh;
+	if (!importMesh<ModelLayout>(input, mesh)) {
+		return -1;
+	}
+	std::vector<ModelVertex> vertices(mesh.vertexCount);
+	std::memcpy(vertices.data(), mesh.vertices.data(), mesh.vertexCount * sizeof(ModelVertex));
+	std::vector<unsigned int> indices = mesh.indices;
+	size_t importedVertices = vertices.size();
+
+	optimizeMesh(vertices, indices);
+
+	std::vector<MeshLod> lods;
+	if (lodCount > 1) {
+		// normals keep collapses from flattening creases
+		SimplifyOptions options;
+		options.attributes = vertices[0].normal;
+		options.attributeCount = 3;
+		options.attributeStride = sizeof(ModelVertex);
+		options.attributeWeight = 0.01f;
+		LodChain chain = buildLodChain(indices, vertices[0].position, sizeof(ModelVertex), vertices.size(), options, lodCount);
+		indices.swap(chain.indices);
+		lods = chain.lods;
+	}
+
+	if (!writeMeshCache<ModelLayout>(output, vertices.data(), vertices.size(), indices, lods, encode)) {
+		return -1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	MeshCache cache(output);
+	if (!cache.matches<ModelLayout>()) {
+		std::cout << "ERROR::MESH_CONVERT::VERIFY_FAILED " << output << std::endl;
+		return -1;
+	}
+	const MeshCacheHeader& header = cache.header();
+	std::cout << input << " -> " << output << " in " << std::fixed << std::setprecision(2) << seconds << " s" << std::endl;
+	std::cout << "vertices " << importedVertices << " -> " << header.vertexCount
+		<< ", " << (header.indexType == GL_UNSIGNED_SHORT ? 16 : 32) << " bit indices"
+		<< (cache.isEncoded() ? ", encoded" : "") << std::endl;
+	std::cout << "source " << mesh.sourceBytes / 1e6 << " MB, cache "
+		<< (header.indexOffset + header.indexBytes) / 1e6 << " MB" << std::endl;
+	std::cout << std::left << std::setw(6) << "lod" << std::right << std::setw(12) << "triangles" << std::setw(14) << "error" << std::endl;
+	for (int l = 0; l < cache.lodCount(); l++) {
+		MeshLod lod = cache.lod(l);
+		std::cout << std::left << std::setw(6) << l << std::right << std::setw(12) << lod.indexCount / 3
+			<< std::setw(14) << std::setprecision(5) << lod.error << std::endl;
+	}
+	return 0;
+}